@@ -4,54 +4,127 @@
 
 #include "CPU.h"
 
-static std::unordered_map<std::string, std::pair<Opcode, Opcode>> OpcodeMap = {
-    {"ADD", {OP_ADD, OP_ADDI}},
-    {"SUB", {OP_SUB, OP_SUBI}},
-    {"MUL", {OP_MUL, OP_MUL}},
-    {"SDIV", {OP_SDIV, OP_SDIV}},
-    {"UDIV", {OP_UDIV, OP_UDIV}},
-    {"AND", {OP_AND, OP_ANDI}},
-    {"ORR", {OP_ORR, OP_ORRI}},
-    {"EOR", {OP_EOR, OP_EORI}},
-    {"NOP", {OP_NOP, OP_NOP}},
-    {"RET", {OP_RET, OP_RET}},
-    {"HLT", {OP_HLT, OP_HLT}}
-};
-
-static std::unordered_map<std::string, enum class BranchCondition> B_COND_Map = {
-    {"B.EQ", BranchCondition::EQ},
-    {"B.NE", BranchCondition::NE},
-    {"B.CS", BranchCondition::CS},
-    {"B.CC", BranchCondition::CC},
-    {"B.MI", BranchCondition::MI},
-    {"B.PL", BranchCondition::PL},
-    {"B.VS", BranchCondition::VS},
-    {"B.VC", BranchCondition::VC},
-    {"B.HI", BranchCondition::HI},
-    {"B.LS", BranchCondition::LS},
-    {"B.GE", BranchCondition::GE},
-    {"B.LT", BranchCondition::LT},
-    {"B.GT", BranchCondition::GT},
-    {"B.LE", BranchCondition::LE},
-    {"B.AL", BranchCondition::AL},
-    {"B.NV", BranchCondition::NV},
-    {"BEQ", BranchCondition::EQ},
-    {"BNE", BranchCondition::NE},
-    {"BCS", BranchCondition::CS},
-    {"BCC", BranchCondition::CC},
-    {"BMI", BranchCondition::MI},
-    {"BPL", BranchCondition::PL},
-    {"BVS", BranchCondition::VS},
-    {"BVC", BranchCondition::VC},
-    {"BHI", BranchCondition::HI},
-    {"BLS", BranchCondition::LS},
-    {"BGE", BranchCondition::GE},
-    {"BLT", BranchCondition::LT},
-    {"BGT", BranchCondition::GT},
-    {"BLE", BranchCondition::LE},
-    {"BAL", BranchCondition::AL},
-    {"BNV", BranchCondition::NV}
-};
+// ====================== 指令表查询 ======================
+// 助记符、操作数格式与编码位置全部来自 ISA.h，这里只负责文本与字段之间的转换
+
+// 操作数是否与格式匹配
+static bool matchFormat(InstrFormat format, const std::vector<TokenInfo>& ops) {
+    auto reg = [&](size_t i) { return i < ops.size() && ops[i].isReg; };
+    auto imm = [&](size_t i) { return i < ops.size() && ops[i].isImm; };
+    switch (format) {
+    case InstrFormat::RRR:    return ops.size() == 3 && reg(0) && reg(1) && reg(2);
+    case InstrFormat::RRI:    return ops.size() == 3 && reg(0) && reg(1) && imm(2);
+    case InstrFormat::RR:
+    case InstrFormat::CMP_RR: return ops.size() == 2 && reg(0) && reg(1);
+    case InstrFormat::RI:
+    case InstrFormat::CMP_RI: return ops.size() == 2 && reg(0) && imm(1);
+    case InstrFormat::MEM:    return (ops.size() == 2 || (ops.size() == 3 && imm(2))) && reg(0) && reg(1);
+    case InstrFormat::REG:    return ops.size() == 1 && reg(0);
+    case InstrFormat::NONE:   return ops.empty();
+    default:                  return false;
+    }
+}
+
+static bool matchWidth(InstrWidth width, const std::vector<TokenInfo>& ops) {
+    if (width == InstrWidth::ANY) return true;
+    return !ops.empty() && ops[0].isX == (width == InstrWidth::X);
+}
+
+// 按指令表查找助记符与操作数都匹配的一行，找不到时返回 nullptr
+static const InstrInfo* findInstr(const std::string& mnemonic, InstrFormat format) {
+    for (const InstrInfo& info : ISA_INFO) {
+        if (mnemonic == info.mnemonic && info.format == format) return &info;
+    }
+    return nullptr;
+}
+
+static const InstrInfo* findInstr(const std::string& mnemonic, const std::vector<TokenInfo>& ops) {
+    for (const InstrInfo& info : ISA_INFO) {
+        if (mnemonic == info.mnemonic && matchFormat(info.format, ops) && matchWidth(info.width, ops)) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+static bool isMnemonic(const std::string& mnemonic) {
+    for (const InstrInfo& info : ISA_INFO) {
+        if (mnemonic == info.mnemonic) return true;
+    }
+    return false;
+}
+
+static const SystemInstrInfo* findSystemInstr(const std::string& mnemonic) {
+    for (const SystemInstrInfo& info : SYSTEM_ISA_INFO) {
+        if (mnemonic == info.mnemonic) return &info;
+    }
+    return nullptr;
+}
+
+static const SystemInstrInfo* findSystemInstr(uint8_t subop) {
+    for (const SystemInstrInfo& info : SYSTEM_ISA_INFO) {
+        if (subop == info.subop) return &info;
+    }
+    return nullptr;
+}
+
+static int parseSystemRegister(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::toupper(c); });
+    for (size_t i = 0; i < std::size(SYSTEM_REGISTER_NAMES); ++i) {
+        if (name == SYSTEM_REGISTER_NAMES[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// 系统指令的操作数依次放入 [25:21]、[20:16]、[4:0]；写回标记 '!' 只是语法，没有操作数的指令忽略其余部分（如 DMB ISH）
+uint32_t Assembler::encodeSystemInstr(const SystemInstrInfo& sys, std::vector<std::string> operands, const std::string& line) {
+    uint32_t instr = (OP_SYS << 26) | (sys.subop << 8);
+    if (sys.format == InstrFormat::NONE) return instr;
+
+    auto invalid = [&] { return std::runtime_error("Instruction Invalid: " + line); };
+    for (auto& op : operands) op.erase(std::remove(op.begin(), op.end(), '!'), op.end());
+    if (sys.format == InstrFormat::MRS) {
+        int sysreg = operands.size() == 2 ? parseSystemRegister(operands[1]) : -1;
+        auto parsed = parseTokens(std::vector<std::string>(operands.begin(), operands.begin() + std::min<size_t>(operands.size(), 1)));
+        if (sysreg < 0 || parsed.size() != 1 || !parsed[0].isReg || !parsed[0].isX) throw invalid();
+        return instr | (1u << 31) | (parseReg(parsed[0].token) << 21) | static_cast<uint32_t>(sysreg);
+    }
+
+    auto ops = parseTokens(operands);
+    const bool two = sys.format == InstrFormat::LDX;
+    if (!matchFormat(two ? InstrFormat::RR : InstrFormat::RRR, ops)) throw invalid();
+    // 地址寄存器（最后一个）总是X寄存器；CPY*/SET* 的三个寄存器与 STXR 的状态寄存器不得与其他操作数相同
+    const uint8_t r0 = parseReg(ops[0].token), r1 = parseReg(ops[1].token), r2 = two ? r1 : parseReg(ops[2].token);
+    const bool distinct = two || (r0 != r1 && r0 != r2);
+    if (!ops.back().isX) throw invalid();
+    bool is64 = true;
+    switch (sys.format) {
+    case InstrFormat::CPY:
+    case InstrFormat::SET: if (!ops[0].isX || !ops[1].isX || !distinct || r1 == r2) throw invalid(); break;
+    case InstrFormat::LDX: is64 = ops[0].isX; break;
+    case InstrFormat::STX: if (ops[0].isX || !distinct) throw invalid(); is64 = ops[1].isX; break;
+    case InstrFormat::RMW: if (ops[0].isX != ops[1].isX) throw invalid(); is64 = ops[0].isX; break;
+    default: throw invalid();
+    }
+    instr |= (is64 ? 1u << 31 : 0) | (r0 << 21) | (r1 << 16);
+    return two ? instr : instr | r2;
+}
+
+// B.EQ / BEQ 形式的条件分支，返回条件码，不是条件分支时返回 -1
+static int parseCondition(const std::string& mnemonic) {
+    std::string cond;
+    if (mnemonic.rfind("B.", 0) == 0) cond = mnemonic.substr(2);
+    else if (mnemonic.size() == 3 && mnemonic[0] == 'B') cond = mnemonic.substr(1);
+    else return -1;
+    for (int i = 0; i < 16; ++i) {
+        if (cond == CONDITION_NAMES[i]) return i;
+    }
+    return -1;
+}
+
+static uint32_t parseImm(const TokenInfo& token) {
+    return std::stoi(token.token.substr(1), nullptr, token.isHex ? 16 : 10) & 0xFFFF; // 截断低16位
+}
 
 std::vector<uint32_t> Assembler::assemble(const std::vector<std::string>& asmLines) {
     std::vector<uint32_t> machineCode;
@@ -79,7 +152,7 @@ std::vector<uint32_t> Assembler::assemble(const std::vector<std::string>& asmLin
     for (const auto& line : asmLines) {
         std::string trimmed = trim(line);
         if (trimmed.empty() || trimmed.back() == ':' || trimmed.rfind("//", 0) == 0) continue;
-        std::cout << "trimmed instruction: " << trimmed << std::endl;
+        if (verbose) std::cout << "trimmed instruction: " << trimmed << std::endl;
 
         std::istringstream iss(trimmed);
         std::string token;
@@ -110,129 +183,58 @@ std::vector<uint32_t> Assembler::assemble(const std::vector<std::string>& asmLin
 
             machineCode.push_back(value);
         }
-        else if (opcode == "MOV") {
-            if (tokens.size() < 3) throw std::runtime_error("Too few operands: " + trimmed);
-            auto parsed = parseTokens(std::vector<std::string>(tokens.begin() + 1, tokens.end()));
-            for (const auto& pt : parsed) { if (!pt.isValid) throw std::runtime_error("Instruction Invalid: " + trimmed); }
-            uint8_t sf = parsed[0].isX ? 1 : 0;
-            uint8_t rd_num = parseReg(parsed[0].token);
-            uint8_t rn_num = 0;
-            uint32_t imm_val = 0;
-            uint32_t instr = (sf << 31) | ((parsed[1].isReg ? OP_MOV : OP_MOVI) << 26) | (rd_num << 21);
-            if (parsed[1].isReg) {
-                rn_num = parseReg(parsed[1].token);
-                instr |= (rn_num << 16);
-            } else if (parsed[1].isImm) {
-                imm_val = std::stoi(parsed[1].token.substr(1), nullptr, parsed[1].isHex ? 16 : 10);
-                instr |= (imm_val & 0xFFFF); // 截断低16位
-            }
-            machineCode.push_back(instr);
+        else if (const SystemInstrInfo* sys = findSystemInstr(opcode)) {
+            machineCode.push_back(encodeSystemInstr(*sys, std::vector<std::string>(tokens.begin() + 1, tokens.end()), trimmed));
         }
-        else if (opcode == "ADD" || opcode == "SUB" || opcode == "AND" || opcode == "ORR" || opcode == "EOR") {
-            if (tokens.size() < 4) throw std::runtime_error("Too few operands: " + trimmed);
-            auto parsed = parseTokens(std::vector<std::string>(tokens.begin() + 1, tokens.end()));
-            for (const auto& pt : parsed) { if (!pt.isValid) throw std::runtime_error("Instruction Invalid: " + trimmed); }
-            uint8_t sf = parsed[0].isX ? 1 : 0;
-            uint8_t rd_num = parseReg(parsed[0].token);
-            uint8_t rn_num = parseReg(parsed[1].token);
-            uint8_t rm_num = 0;
-            uint32_t imm_val = 0;
-            uint32_t instr = (sf << 31) | ((parsed[2].isReg ? OpcodeMap[opcode].first : OpcodeMap[opcode].second) << 26) | (rd_num << 21) | (rn_num << 16);
-            if (parsed[2].isReg) {
-                rm_num = parseReg(parsed[2].token);
-                instr |= rm_num;
-            } else if (parsed[2].isImm) {
-                imm_val = std::stoi(parsed[2].token.substr(1), nullptr, parsed[2].isHex ? 16 : 10);
-                instr |= (imm_val & 0xFFFF);
-            }
-            machineCode.push_back(instr);
-        }
-        else if (opcode == "MUL" || opcode == "SDIV" || opcode == "UDIV") {
-            if (tokens.size() < 4) throw std::runtime_error("Too few operands: " + trimmed);
-            auto parsed = parseTokens(std::vector<std::string>(tokens.begin() + 1, tokens.end()));
-            for (const auto& pt : parsed) { if (!pt.isValid) throw std::runtime_error("Instruction Invalid: " + trimmed); }
-            uint8_t sf = parsed[0].isX ? 1 : 0;
-            uint8_t rd_num = parseReg(parsed[0].token);
-            uint8_t rn_num = parseReg(parsed[1].token);
-            uint8_t rm_num = parseReg(parsed[2].token);
-            uint32_t instr = (sf << 31) | (OpcodeMap[opcode].first << 26) | (rd_num << 21) | (rn_num << 16) | rm_num;
-            machineCode.push_back(instr);
-        }
-        else if (opcode == "CMP") {
-            if (tokens.size() < 3) throw std::runtime_error("Too few operands: " + trimmed);
-            auto parsed = parseTokens(std::vector<std::string>(tokens.begin() + 1, tokens.end()));
-            for (const auto& pt : parsed) { if (!pt.isValid) throw std::runtime_error("Instruction Invalid: " + trimmed); }
-            uint8_t sf = parsed[0].isX ? 1 : 0;
-            uint8_t rd_num = parseReg(parsed[0].token);
-            uint8_t rn_num = 0;
-            uint32_t imm_val = 0;
-            uint32_t instr = (sf << 31) | ((parsed[1].isReg ? OP_CMP : OP_CMPI) << 26) | (rd_num << 21);
-            if (parsed[1].isReg) {
-                rn_num = parseReg(parsed[1].token);
-                instr |= (rn_num << 16);
-            } else if (parsed[1].isImm) {
-                imm_val = std::stoi(parsed[1].token.substr(1), nullptr, parsed[1].isHex ? 16 : 10);
-                instr |= (imm_val & 0xFFFF);
-            }
-            machineCode.push_back(instr);
-        }
-        else if (opcode == "LDR" || opcode == "STR" || opcode == "LDRH" || opcode == "STRH" || opcode == "LDRB" || opcode == "STRB") {
-            if (tokens.size() < 3) throw std::runtime_error("Too few operands: " + trimmed);
-
-            auto parsed = parseTokens(std::vector<std::string>(tokens.begin() + 1, tokens.end()));
-            for (const auto& pt : parsed) {
-                if (!pt.isValid) throw std::runtime_error("Instruction Invalid: " + trimmed);
-            }
-
-            uint8_t sf = parsed[0].isX ? 1 : 0;
-            uint8_t rt_num = parseReg(parsed[0].token);
-            uint8_t rn_num = parseReg(parsed[1].token);
-            uint32_t imm_val = 0;
-
-            if (parsed.size() > 2 && parsed[2].isImm) {
-                imm_val = std::stoi(parsed[2].token.substr(1), nullptr, parsed[2].isHex ? 16 : 10);
-            }
-
-            uint8_t opcodeVal = 0;
-            if (opcode == "LDR")  opcodeVal = parsed[0].isX ? OP_LDRD : OP_LDRW;
-            else if (opcode == "STR")  opcodeVal = parsed[0].isX ? OP_STRD : OP_STRW;
-            else if (opcode == "LDRH") opcodeVal = OP_LDRH;
-            else if (opcode == "STRH") opcodeVal = OP_STRH;
-            else if (opcode == "LDRB") opcodeVal = OP_LDRB;
-            else if (opcode == "STRB") opcodeVal = OP_STRB;
-
-            uint32_t instr = (sf << 31) | (opcodeVal << 26) | (rt_num << 21) | (rn_num << 16) | (imm_val & 0xFFFF);
-            machineCode.push_back(instr);
-        }
-        else if (opcode == "B") {
+        else if (parseCondition(opcode) >= 0 && !isMnemonic(opcode)) {
             if (tokens.size() < 2) throw std::runtime_error("Too few operands: " + trimmed);
-            std::string label = tokens[1];
-            pendingLabels.push_back({pc, label});
-            uint32_t instr = (OP_B << 26);
+            pendingLabels.push_back({pc, tokens[1]});
+            uint32_t instr = (OP_B_COND << 26) | ((parseCondition(opcode) & 0x0F) << 22);
             machineCode.push_back(instr); // 占位，后续填充
         }
-        else if (opcode == "BL") {
+        else if (findInstr(opcode, InstrFormat::LABEL) != nullptr) {
             if (tokens.size() < 2) throw std::runtime_error("Too few operands: " + trimmed);
-            std::string label = tokens[1];
-            pendingLabels.push_back({pc, label});
-            uint32_t instr = (OP_BL << 26);
+            pendingLabels.push_back({pc, tokens[1]});
+            uint32_t instr = (findInstr(opcode, InstrFormat::LABEL)->opcode << 26);
             machineCode.push_back(instr); // 占位，后续填充
         }
-        else if (B_COND_Map.find(opcode) != B_COND_Map.end()) {
-            if (tokens.size() < 2) throw std::runtime_error("Too few operands: " + trimmed);
-            std::string label = tokens[1];
-            pendingLabels.push_back({pc, label});
-            uint8_t condition = static_cast<uint8_t>(B_COND_Map[opcode]);
-            uint32_t instr = (OP_B_COND << 26) | ((condition & 0x0F) << 22);
-            machineCode.push_back(instr); // 占位，后续填充
-        }
-        else if (opcode == "HLT" || opcode == "RET" || opcode == "NOP") {
-            uint32_t instr = (OpcodeMap[opcode].first << 26);
+        else if (isMnemonic(opcode)) {
+            auto parsed = parseTokens(std::vector<std::string>(tokens.begin() + 1, tokens.end()));
+            for (const auto& pt : parsed) { if (!pt.isValid) throw std::runtime_error("Instruction Invalid: " + trimmed); }
+            const InstrInfo* info = findInstr(opcode, parsed);
+            if (info == nullptr) throw std::runtime_error("Instruction Invalid: " + trimmed);
+
+            uint8_t sf = (!parsed.empty() && parsed[0].isX) ? 1 : 0;
+            uint32_t instr = (sf << 31) | (info->opcode << 26);
+            switch (info->format) {
+            case InstrFormat::RRR:
+                instr |= (parseReg(parsed[0].token) << 21) | (parseReg(parsed[1].token) << 16) | parseReg(parsed[2].token);
+                break;
+            case InstrFormat::RRI:
+                instr |= (parseReg(parsed[0].token) << 21) | (parseReg(parsed[1].token) << 16) | parseImm(parsed[2]);
+                break;
+            case InstrFormat::RR:
+            case InstrFormat::CMP_RR:
+                instr |= (parseReg(parsed[0].token) << 21) | (parseReg(parsed[1].token) << 16);
+                break;
+            case InstrFormat::RI:
+            case InstrFormat::CMP_RI:
+                instr |= (parseReg(parsed[0].token) << 21) | parseImm(parsed[1]);
+                break;
+            case InstrFormat::MEM:
+                instr |= (parseReg(parsed[0].token) << 21) | (parseReg(parsed[1].token) << 16);
+                if (parsed.size() > 2) instr |= parseImm(parsed[2]);
+                break;
+            case InstrFormat::REG:
+                instr |= (parseReg(parsed[0].token) << 21);
+                break;
+            default:
+                break;
+            }
             machineCode.push_back(instr);
         }
         else {
-            std::cerr << "未知指令: " << tokens[0] << std::endl;
-            exit(1);
+            throw std::runtime_error("未知指令: " + tokens[0]);
         }
 
         pc += 4;
@@ -242,19 +244,23 @@ std::vector<uint32_t> Assembler::assemble(const std::vector<std::string>& asmLin
     for (auto& [addr, label] : pendingLabels) {
         if (labelAddresses.count(label)) {
             int labelAddr = labelAddresses[label];
-            int8_t offset = (labelAddr - (addr + 4)) >> 2;
-            machineCode[addr / 4] |= (offset & 0b1111111111111111111111);
+            int offset = (labelAddr - (addr + 4)) / 4;     // 相对下一条指令的指令数
+            if (offset < INT16_MIN || offset > INT16_MAX) {
+                throw std::runtime_error("跳转目标超出范围: " + label);
+            }
+            machineCode[addr / 4] |= (offset & 0xFFFF);
         } else {
-            std::cerr << "未知标签: " << label << std::endl;
-            exit(1);
+            throw std::runtime_error("未知标签: " + label);
         }
     }
 
-    for (const auto& code : machineCode) {
-        for (int i = 31; i >= 0; --i) {
-            std::cout << ((code >> i) & 1);
+    if (verbose) {
+        for (const auto& code : machineCode) {
+            for (int i = 31; i >= 0; --i) {
+                std::cout << ((code >> i) & 1);
+            }
+            std::cout << std::endl;
         }
-        std::cout << std::endl;
     }
 
     return machineCode;
@@ -306,7 +312,10 @@ std::vector<TokenInfo> Assembler::parseTokens(const std::vector<std::string>& to
         } else if (token.rfind("#", 0) == 0) {
             info.isImm = true;
             info.isHex = false;
-        } else if (token != "SP" && token != "sp") {
+        } else if (token == "SP" || token == "sp") {
+            info.isReg = true;
+            info.isX = true;
+        } else {
             throw std::runtime_error("Invalid Token: " + token);
         }
 
@@ -321,3 +330,55 @@ std::vector<TokenInfo> Assembler::parseTokens(const std::vector<std::string>& to
 
     return parsed;
 }
+
+// ====================== 反汇编 ======================
+
+std::string Assembler::disassemble(uint32_t ir, uint64_t pc) {
+    const InstrInfo& info = ISA_INFO[(ir >> 26) & 0x1F];
+    RegWidth width = (ir >> 31) ? RegWidth::X : RegWidth::W;
+    uint8_t rd = (ir >> 21) & 0x1F;
+    uint8_t rn = (ir >> 16) & 0x1F;
+    uint8_t rm = ir & 0x1F;
+    int16_t imm = static_cast<int16_t>(ir & 0xFFFF);
+
+    auto reg = [&](uint8_t r) { return Register(r, width).toString(); };
+    auto base = [](uint8_t r) { return r == 31 ? std::string("SP") : Register(r).toString(); };
+    auto target = [&]() {
+        std::ostringstream oss;
+        oss << "0x" << std::hex << pc + 4 + static_cast<int64_t>(imm) * 4;
+        return oss.str();
+    };
+
+    std::string text = info.mnemonic;
+    switch (info.format) {
+    case InstrFormat::RRR:        return text + " " + reg(rd) + ", " + reg(rn) + ", " + reg(rm);
+    case InstrFormat::RRI:        return text + " " + reg(rd) + ", " + reg(rn) + ", #" + std::to_string(imm);
+    case InstrFormat::RR:
+    case InstrFormat::CMP_RR:     return text + " " + reg(rd) + ", " + reg(rn);
+    case InstrFormat::RI:
+    case InstrFormat::CMP_RI:     return text + " " + reg(rd) + ", #" + std::to_string(imm);
+    case InstrFormat::MEM:
+        return text + " " + reg(rd) + ", [" + base(rn) + (imm ? ", #" + std::to_string(imm) : "") + "]";
+    case InstrFormat::LABEL:      return text + " " + target();
+    case InstrFormat::COND_LABEL: return text + CONDITION_NAMES[(ir >> 22) & 0x0F] + " " + target();
+    case InstrFormat::REG:        return text + " " + Register(rd).toString();
+    case InstrFormat::SYS: {
+        const SystemInstrInfo* sys = findSystemInstr(static_cast<uint8_t>((ir >> 8) & 0xFF));
+        if (sys == nullptr) return SYSTEM_MNEMONICS[SYS_HLT];   // 未定义的子操作码按HLT执行
+        std::string name = sys->mnemonic;
+        auto x = [](uint8_t r) { return Register(r).toString(); };
+        auto t = [&](uint8_t r) { return Register(r, width).toString(); };  // 按 sf 选择位宽的数据寄存器
+        switch (sys->format) {
+        case InstrFormat::CPY: return name + " [" + x(rd) + "]!, [" + x(rn) + "]!, " + x(rm) + "!";
+        case InstrFormat::SET: return name + " [" + x(rd) + "]!, " + x(rn) + "!, " + x(rm);
+        case InstrFormat::LDX: return name + " " + t(rd) + ", [" + x(rn) + "]";
+        case InstrFormat::STX: return name + " " + Register(rd, RegWidth::W).toString() + ", " + t(rn) + ", [" + x(rm) + "]";
+        case InstrFormat::RMW: return name + " " + t(rd) + ", " + t(rn) + ", [" + x(rm) + "]";
+        case InstrFormat::MRS:
+            return name + " " + x(rd) + ", " + (rm < std::size(SYSTEM_REGISTER_NAMES) ? SYSTEM_REGISTER_NAMES[rm] : "S" + std::to_string(rm));
+        default:               return name;
+        }
+    }
+    default:                      return text;
+    }
+}
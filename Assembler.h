@@ -8,6 +8,8 @@
 #include <regex>
 #include <iomanip>
 
+struct SystemInstrInfo;
+
 struct TokenInfo {
     std::string token;
     bool isValid = false;  // 是否合法token
@@ -22,9 +24,18 @@ public:
     std::vector<uint32_t> assemble(const std::vector<std::string>& asmLines);
     std::vector<uint32_t> assemble(const std::string& asmLines);
 
+    // 将一条指令字还原为汇编文本，pc 用于计算分支目标地址
+    static std::string disassemble(uint32_t ir, uint64_t pc);
+
     static std::string trim(const std::string& s);
     static uint8_t parseReg(const std::string& r);
 
+    // 为false时不向标准输出打印每条指令与机器码（执行服务使用）
+    void setVerbose(bool enabled) { verbose = enabled; }
+
 private:
+    bool verbose = true;
+
     std::vector<TokenInfo> parseTokens(const std::vector<std::string>& tokens);
+    uint32_t encodeSystemInstr(const SystemInstrInfo& sys, std::vector<std::string> operands, const std::string& line);
 };
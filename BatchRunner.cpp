@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "BatchRunner.h"
+
+// ====================== 工作窃取 ======================
+// 每个线程尚未开始的作业下标区间 [begin, end) 打包在一个64位原子量中（高32位为 begin），
+// 所有者从前端逐个取出，窃取者从末尾取走一半，双方都以一次CAS完成。
+// 作业不会再增加，所有区间都为空时线程退出；窃取者只在自己的区间为空时才改写它
+
+namespace {
+
+struct alignas(64) WorkRange {
+    std::atomic<uint64_t> packed{0};
+};
+
+inline uint64_t packRange(uint32_t begin, uint32_t end) {
+    return (static_cast<uint64_t>(begin) << 32) | end;
+}
+
+bool takeFront(WorkRange& range, uint32_t& index) {
+    uint64_t value = range.packed.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t begin = static_cast<uint32_t>(value >> 32), end = static_cast<uint32_t>(value);
+        if (begin >= end) return false;
+        if (range.packed.compare_exchange_weak(value, packRange(begin + 1, end), std::memory_order_acq_rel)) {
+            index = begin;
+            return true;
+        }
+    }
+}
+
+// 取走 victim 剩余部分的后一半（只剩一个时取走它），得到 [first, last)
+bool stealBack(WorkRange& victim, uint32_t& first, uint32_t& last) {
+    uint64_t value = victim.packed.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t begin = static_cast<uint32_t>(value >> 32), end = static_cast<uint32_t>(value);
+        if (begin >= end) return false;
+        uint32_t middle = begin + (end - begin) / 2;
+        if (victim.packed.compare_exchange_weak(value, packRange(begin, middle), std::memory_order_acq_rel)) {
+            first = middle;
+            last = end;
+            return true;
+        }
+    }
+}
+
+uint32_t remaining(const WorkRange& range) {
+    uint64_t value = range.packed.load(std::memory_order_relaxed);
+    uint32_t begin = static_cast<uint32_t>(value >> 32), end = static_cast<uint32_t>(value);
+    return begin < end ? end - begin : 0;
+}
+
+} // namespace
+
+// ====================== 批量执行 ======================
+template<typename Core>
+BatchRunner<Core>::BatchRunner(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i) cpus.push_back(std::make_unique<Core>());
+}
+
+template<typename Core>
+BatchRunner<Core>::BatchRunner(unsigned threads, const MemoryLayout& layout) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i) cpus.push_back(std::make_unique<Core>(layout));
+}
+
+template<typename Core>
+BatchResult BatchRunner<Core>::execute(Core& cpu, const BatchJob& job, ExecutionEngine engine) {
+    BatchResult result;
+    cpu.reset();
+    try {
+        cpu.loadProgram(job.program);
+        for (const BatchMemoryInit& init : job.memory) cpu.writeMemoryRange(init.address, init.bytes);
+        for (const auto& [reg, value] : job.registers) cpu.setReg(reg, value);
+        cpu.setStatusReg(job.status);
+        cpu.setPC(job.pc);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        return result;
+    }
+
+    switch (engine) {
+    case ExecutionEngine::INTERPRETER: result.reason = cpu.run(job.maxSteps); break;
+    case ExecutionEngine::BLOCKS:      result.reason = cpu.runBlocks(job.maxSteps); break;
+    case ExecutionEngine::JIT:         result.reason = cpu.runJit(job.maxSteps); break;
+    }
+    result.steps = cpu.getRunSteps();
+    result.pc = cpu.getPC();
+    for (uint8_t i = 0; i < Core::NUM_REGS; ++i) result.regs[i] = cpu.getReg(i);
+    result.status = cpu.getStatusReg();
+    result.faultAddress = cpu.getFaultAddress();
+    result.faultAccess = cpu.getFaultAccess();
+    return result;
+}
+
+template<typename Core>
+std::vector<BatchResult> BatchRunner<Core>::run(const std::vector<BatchJob>& jobs, ExecutionEngine engine) {
+    if (jobs.size() > UINT32_MAX) {
+        throw std::runtime_error("Too many jobs in one batch: " + std::to_string(jobs.size()));
+    }
+    std::vector<BatchResult> results(jobs.size());
+    const uint32_t count = static_cast<uint32_t>(jobs.size());
+    const unsigned workers = static_cast<unsigned>(std::min<size_t>(cpus.size(), std::max<uint32_t>(count, 1)));
+
+    std::vector<WorkRange> ranges(workers);
+    for (unsigned w = 0; w < workers; ++w) {
+        ranges[w].packed.store(packRange(static_cast<uint32_t>(uint64_t(count) * w / workers),
+                                         static_cast<uint32_t>(uint64_t(count) * (w + 1) / workers)));
+    }
+
+    // 每个结果只由执行该作业的线程写入
+    auto work = [&](unsigned self) {
+        Core& cpu = *cpus[self];
+        for (;;) {
+            uint32_t index;
+            if (takeFront(ranges[self], index)) {
+                results[index] = execute(cpu, jobs[index], engine);
+                continue;
+            }
+            unsigned victim = self;
+            uint32_t most = 0;
+            for (unsigned w = 0; w < workers; ++w) {
+                uint32_t left = remaining(ranges[w]);
+                if (w != self && left > most) {
+                    victim = w;
+                    most = left;
+                }
+            }
+            uint32_t first, last;
+            if (victim == self) return;
+            if (!stealBack(ranges[victim], first, last)) continue;     // 被所有者或其他窃取者抢先，重新选择
+            ranges[self].packed.store(packRange(first, last), std::memory_order_release);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 1; w < workers; ++w) threads.emplace_back(work, w);
+    work(0);    // 调用线程也作为一个工作线程
+    for (std::thread& t : threads) t.join();
+    return results;
+}
+
+#define INSTANTIATE_BATCH(CONFIG, HOOKS) template class BatchRunner<BasicCPU<CONFIG, HOOKS>>;
+TINY_CPU_CONFIGS(INSTANTIATE_BATCH)
+#undef INSTANTIATE_BATCH
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CPU.h"
+
+// ========================== 批量执行 ==========================
+// 在多个线程上运行大量互不相关的程序（回归测试等），吞吐量随核数增长，不必为每个程序启动进程。
+// 每个工作线程持有一台可重复使用的CPU：作业之间只 reset()（只清零上个作业写过的页），
+// 不重新分配内存、预译码缓存与JIT代码区。
+// 作业按下标均分给各线程；线程做完自己的部分后从剩余最多的线程的区间末尾取走一半（工作窃取），
+// 执行时间差别很大的作业也能使各线程几乎同时结束
+
+// 写入初始内存的一段数据（物理地址）
+struct BatchMemoryInit {
+    uint64_t address;
+    std::vector<uint8_t> bytes;
+};
+
+struct BatchJob {
+    std::vector<uint32_t> program;                          // 从地址0开始加载的机器码
+    std::vector<BatchMemoryInit> memory;                    // 加载程序后写入的数据
+    std::vector<std::pair<uint8_t, uint64_t>> registers;    // 初始寄存器，未列出的保持复位值（SP为栈顶）
+    StatusRegister status{};                                // 初始NZCV
+    uint64_t pc = 0;                                        // 初始PC
+    uint64_t maxSteps = 1000000;                            // 步数预算
+};
+
+struct BatchResult {
+    StopReason reason = StopReason::NONE;       // 作业无效时为 NONE，原因见 error
+    uint64_t steps = 0;                         // 实际执行的指令数
+    uint64_t pc = 0;
+    std::array<uint64_t, 32> regs{};            // 停止时的寄存器（31为SP）
+    StatusRegister status{};
+    uint64_t faultAddress = 0;                  // reason 为 MEMORY_FAULT 时有效
+    MemoryAccess faultAccess = MemoryAccess::READ;
+    std::string error;                          // 程序过大、初始数据越界等
+};
+
+// Core 为 BasicCPU 的实例类型，在 BatchRunner.cpp 中按 TINY_CPU_CONFIGS 显式实例化
+template<typename Core = CPU>
+class BatchRunner {
+public:
+    // threads 为0时使用宿主机的核数；CPU按 layout（省略时为配置的默认布局）建立，布局无效时抛出异常
+    explicit BatchRunner(unsigned threads = 0);
+    BatchRunner(unsigned threads, const MemoryLayout& layout);
+
+    // 执行全部作业，按作业顺序返回结果；调用期间本对象不能被其他线程使用。
+    // 单个作业的错误记录在其结果中，不影响其他作业
+    std::vector<BatchResult> run(const std::vector<BatchJob>& jobs, ExecutionEngine engine = ExecutionEngine::JIT);
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(cpus.size()); }
+
+private:
+    std::vector<std::unique_ptr<Core>> cpus;    // 每个工作线程一台
+
+    static BatchResult execute(Core& cpu, const BatchJob& job, ExecutionEngine engine);
+};
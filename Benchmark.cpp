@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+
+// ========================== 执行引擎基准 ==========================
+// 比较 run() / runBlocks() / runJit() 在两个循环上的速度（百万条指令每秒）：
+//   访存循环：Test.cpp 的求和程序（-O0 风格，局部变量都在栈上），外层重复多次
+//   ALU循环：只有寄存器运算、比较与条件分支
+// 每种方式先执行一遍预热代码缓存与JIT，再重复 REPEATS 次取最快的一次。
+// 程序均以HLT结束，各方式执行的指令数必须相同。
+
+namespace {
+
+const int REPEATS = 5;
+const uint64_t MAX_STEPS = 1ull << 40;
+
+const char* const LOAD_STORE_LOOP = R"(
+        mov     x5, #4000
+    .Outer:
+        sub     sp, sp, #16
+        mov     w0, #0
+        str     w0, [sp, #12]
+        str     w0, [sp, #8]
+        b       .L2
+    .L3:
+        ldr     w1, [sp, #12]
+        ldr     w0, [sp, #8]
+        add     w0, w1, w0
+        str     w0, [sp, #12]
+        ldr     w0, [sp, #8]
+        add     w0, w0, #1
+        str     w0, [sp, #8]
+    .L2:
+        ldr     w0, [sp, #8]
+        cmp     w0, #1000
+        ble     .L3
+        add     sp, sp, #16
+        sub     x5, x5, #1
+        cmp     x5, #0
+        b.gt    .Outer
+        HLT
+    )";
+
+const char* const ALU_LOOP = R"(
+        mov     x5, #4000
+        mov     x0, #1
+        mov     x1, #3
+    .Outer:
+        mov     x2, #1000
+    .Inner:
+        add     x0, x0, x1
+        eor     x3, x0, x2
+        and     x4, x3, #255
+        orr     x1, x1, x4
+        sub     x1, x1, x0
+        mul     x3, x3, x1
+        add     x0, x0, x3
+        sub     x2, x2, #1
+        cmp     x2, #0
+        b.gt    .Inner
+        sub     x5, x5, #1
+        cmp     x5, #0
+        b.gt    .Outer
+        HLT
+    )";
+
+struct Engine {
+    const char* name;
+    StopReason (CPU::*execute)(uint64_t);
+};
+
+const Engine ENGINES[] = {
+    {"run",       &CPU::run},
+    {"runBlocks", &CPU::runBlocks},
+    {"runJit",    &CPU::runJit},
+};
+
+// 返回最快一次的耗时（秒）；指令数写入 steps
+double measure(CPU& cpu, const std::vector<uint32_t>& program, const Engine& engine, uint64_t& steps) {
+    double best = 0;
+    for (int i = 0; i <= REPEATS; ++i) {
+        cpu.reset();
+        cpu.loadProgram(program);
+        auto begin = std::chrono::steady_clock::now();
+        StopReason reason = (cpu.*engine.execute)(MAX_STEPS);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (reason != StopReason::HALT) {
+            std::printf("%s: %s\n", engine.name, cpu.describeStop(reason).c_str());
+            return 0;
+        }
+        steps = cpu.getRunSteps();
+        if (i > 0 && (best == 0 || seconds < best)) best = seconds;  // 第0次为预热
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    auto instance = std::make_unique<CPU>();
+    CPU& cpu = *instance;
+    Assembler assembler;
+    assembler.setVerbose(false);
+
+    const std::pair<const char*, const char*> programs[] = {
+        {"load/store loop", LOAD_STORE_LOOP},
+        {"ALU loop", ALU_LOOP},
+    };
+    for (const auto& [title, source] : programs) {
+        std::vector<uint32_t> program = assembler.assemble(std::string(source));
+        std::printf("%s\n", title);
+        for (const Engine& engine : ENGINES) {
+            uint64_t steps = 0;
+            double seconds = measure(cpu, program, engine, steps);
+            if (seconds <= 0) return 1;
+            std::printf("  %-10s %10llu instr  %8.3f ms  %8.1f MIPS\n", engine.name,
+                        static_cast<unsigned long long>(steps), seconds * 1e3, steps / seconds / 1e6);
+        }
+    }
+    return 0;
+}
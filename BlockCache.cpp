@@ -0,0 +1,161 @@
+#include "CPU.h"
+
+// ========================== 基本块缓存 ==========================
+
+template<typename Config, typename Hooks>
+typename BasicCPU<Config, Hooks>::BasicBlock* BasicCPU<Config, Hooks>::lookupBlock(uint64_t pc) {
+    auto it = blockCache.find(pc);
+    if (it != blockCache.end()) {
+        BasicBlock* block = it->second.get();
+        if (block->isValid()) return block;
+        return buildBlock(*block, pc) ? block : nullptr;   // 重建失败时保留原有字段，块仍是过期的
+    }
+    // 不为无法执行的地址留下未构建（page为空）的块
+    auto block = std::make_unique<BasicBlock>();
+    if (!buildBlock(*block, pc)) return nullptr;
+    return blockCache.emplace(pc, std::move(block)).first->second.get();
+}
+
+// 从pc开始收集微操作，直到分支/HLT、页尾或块长度上限
+template<typename Config, typename Hooks>
+bool BasicCPU<Config, Hooks>::buildBlock(BasicBlock& block, uint64_t pc) {
+    const CodePage* page;
+    const MicroOp* first = lookupMicroOp(pc, page);
+    if (first == nullptr) return false; // PC未对齐或越界
+
+    uint64_t index = (pc & (CODE_PAGE_SIZE - 1)) >> 2;
+
+    block.start = pc;
+    block.ops.clear();
+    block.page = page;
+    block.generation = page->generation;
+    block.halts = false;
+    block.hasStores = false;
+    block.chainable = true;
+    block.isCall = false;
+    block.isReturn = false;
+    block.returnSite = nullptr;
+    block.successors[0] = block.successors[1] = nullptr;
+    block.jitCode = nullptr;
+    block.jitEntry = nullptr;
+    block.hotness = 0;
+    block.jitFailed = false;
+
+    while (index < CODE_PAGE_OPS && block.ops.size() < MAX_BLOCK_OPS) {
+        MicroOp uop = page->ops[index++];
+        uint8_t opcode = baseOpIndex(uop.index) & 0x1F;
+        block.ops.push_back(uop);
+        block.hasStores |= isStoreOpcode(opcode);
+
+        // 分支与系统指令结束基本块；系统指令（HLT除外）之后顺序执行，后继仍可链接
+        if (isBranchOpcode(opcode)) {
+            block.halts = (opcode == OP_SYS && uop.rm == SYS_HLT);
+            block.chainable = isDirectBranchOpcode(opcode) || (opcode == OP_SYS && !block.halts);
+            block.isCall = (opcode == OP_BL || opcode == OP_BLR);
+            block.isReturn = (opcode == OP_RET);
+            break;
+        }
+    }
+    block.count = block.ops.size();
+    block.end = block.start + block.count * 4;
+
+    // 只保留完整落在块内的融合序列：块长度达到上限时末尾的序列可能被截断
+    for (size_t i = block.count >= 2 ? block.count - 2 : 0; i < block.count; ++i) {
+        uint8_t fused = block.ops[i].index;
+        if (fused >= FUSED_INDEX_BASE && i + FUSION_INFO[fused - FUSED_INDEX_BASE].length > block.count) {
+            block.ops[i].index = baseOpIndex(fused);
+        }
+    }
+    MicroOp sentinel{};
+    sentinel.index = BLOCK_END_INDEX;
+    block.ops.push_back(sentinel);
+    return true;
+}
+
+// 链接：后继命中已链接的块时不回到查表
+//   直接分支：跳转目标与顺序后继各占一项
+//   BR/BLR：两项作为内联缓存，保存该处最近的两个跳转目标
+//   RET：由返回地址栈预测
+// 预测的块都要经过起始地址与有效性检查，未命中时查表
+template<typename Config, typename Hooks>
+typename BasicCPU<Config, Hooks>::BasicBlock* BasicCPU<Config, Hooks>::nextBlock(BasicBlock* block) {
+    if (block->isCall) {
+        pushReturn(block);
+    }
+    if (block->isReturn) {
+        if (BasicBlock* predicted = popReturn(PC)) {
+            return predicted;
+        }
+        return lookupBlock(PC);
+    }
+
+    if (BasicBlock* succ = linkedSuccessor(block)) {
+        return succ;
+    }
+    BasicBlock* next = lookupBlock(PC);
+    if (next != nullptr) {
+        if (block->chainable) {
+            int slot = (block->successors[0] == nullptr || block->successors[0] == next) ? 0 : 1;
+            block->successors[slot] = next;
+        } else {
+            block->successors[1] = block->successors[0];
+            block->successors[0] = next;
+        }
+    }
+    return next;
+}
+
+// 压入调用块的返回地址（块尾）及返回后执行的块；返回处的块在首次调用时查找
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::pushReturn(BasicBlock* block) {
+    BasicBlock* site = block->returnSite;
+    if (site == nullptr || site->start != block->end) {
+        site = block->returnSite = lookupBlock(block->end);
+    }
+    returnStack[returnTop] = ReturnEntry{block->end, site};
+    returnTop = (returnTop + 1) % RETURN_STACK_SIZE;
+    if (returnDepth < RETURN_STACK_SIZE) ++returnDepth;
+}
+
+// 弹出栈顶并与实际返回地址比较；栈空或预测错误时返回nullptr
+template<typename Config, typename Hooks>
+typename BasicCPU<Config, Hooks>::BasicBlock* BasicCPU<Config, Hooks>::popReturn(uint64_t pc) {
+    if (returnDepth == 0) return nullptr;
+    returnTop = (returnTop + RETURN_STACK_SIZE - 1) % RETURN_STACK_SIZE;
+    --returnDepth;
+    const ReturnEntry& entry = returnStack[returnTop];
+    if (entry.address == pc && entry.block != nullptr && entry.block->start == pc && entry.block->isValid()) {
+        return entry.block;
+    }
+    return nullptr;
+}
+
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::executeBlocks(uint64_t& remaining) {
+    if constexpr (Memory::FAULTS_BY_SIGNAL) {   // 块内PC不逐条更新，保护页错误无法精确恢复
+        return catchGuardFault([&] { return interpret<false>(remaining, 0); });
+    }
+    if constexpr (Config::MMU) {                // 块按虚拟地址缓存，换页表后不再可信
+        return interpret<false>(remaining, 0);
+    }
+    return interpretBlocks(remaining);
+}
+
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::runBlocks(uint64_t maxSteps) {
+    uint64_t remaining = maxSteps;
+    StopReason reason = executeBlocks(remaining);
+    runSteps = maxSteps - remaining;
+    return reason;
+}
+
+#define INSTANTIATE_BLOCKS(CONFIG, HOOKS) \
+    template BasicCPU<CONFIG, HOOKS>::BasicBlock* BasicCPU<CONFIG, HOOKS>::lookupBlock(uint64_t pc); \
+    template bool BasicCPU<CONFIG, HOOKS>::buildBlock(BasicBlock& block, uint64_t pc); \
+    template BasicCPU<CONFIG, HOOKS>::BasicBlock* BasicCPU<CONFIG, HOOKS>::nextBlock(BasicBlock* block); \
+    template void BasicCPU<CONFIG, HOOKS>::pushReturn(BasicBlock* block); \
+    template BasicCPU<CONFIG, HOOKS>::BasicBlock* BasicCPU<CONFIG, HOOKS>::popReturn(uint64_t pc); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::executeBlocks(uint64_t& remaining); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::runBlocks(uint64_t maxSteps);
+TINY_CPU_CONFIGS(INSTANTIATE_BLOCKS)
+#undef INSTANTIATE_BLOCKS
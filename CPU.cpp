@@ -1,649 +1,291 @@
 #include "CPU.h"
 
-// ====================== 取指阶段 ======================
-void CPU::fetch() {
-    // 从内存读取指令（小端序）
-    IR = 0;
-    for (int i = 0; i < 4; i++) {
-        IR |= (static_cast<uint32_t>(memory[PC + i]) << (i * 8));
-    }
-    
-    // PC+4（指向下一条指令）
-    PC += 4;
+// ====================== 停止原因 ======================
+template<typename Config, typename Hooks>
+std::string BasicCPU<Config, Hooks>::describeStop(StopReason reason) const {
+    switch (reason) {
+        case StopReason::NONE:
+            return "Running";
+        case StopReason::HALT:
+            return "HLT instruction executed";
+        case StopReason::MEMORY_FAULT:
+            if constexpr (Config::MMU) {
+                switch (faultAccess) {
+                    case MemoryAccess::FETCH:
+                        return "Instruction fetch from unmapped or non-executable address: " + std::to_string(faultAddress);
+                    case MemoryAccess::READ:
+                        return "Memory read from unmapped or non-readable address: " + std::to_string(faultAddress);
+                    case MemoryAccess::WRITE:
+                        return "Memory write to unmapped or non-writable address: " + std::to_string(faultAddress);
+                }
+            }
+            switch (faultAccess) {
+                case MemoryAccess::FETCH:
+                    return "Instruction fetch out of bounds: " + std::to_string(faultAddress);
+                case MemoryAccess::READ:
+                    return "Memory read out of bounds: " + std::to_string(faultAddress);
+                case MemoryAccess::WRITE:
+                    return "Memory write out of bounds: " + std::to_string(faultAddress);
+            }
+            break;
+        case StopReason::DIVIDE_BY_ZERO:
+            return "Division by zero";
+        case StopReason::STEP_LIMIT:
+            return "Step limit reached";
+        case StopReason::BREAKPOINT:
+            return "Breakpoint reached: " + std::to_string(PC);
+    }
+    return "Unknown stop reason";
 }
 
-// ====================== 译码阶段 ======================
-InstructionFormat CPU::decode() const {
-    InstructionFormat instr;
-    uint8_t opcode = (IR >> 26) & 0b011111; // 高6位是操作码
-    bool is64Bits = (IR >> 31) & 0b1;
-    RegWidth regWidth = is64Bits ? RegWidth::X : RegWidth::W;
-    
-    switch (static_cast<Opcode>(opcode)) {
-    case OP_ADD:
-    case OP_SUB:
-    case OP_MUL:
-    case OP_SDIV:
-    case OP_UDIV:
-    case OP_AND:
-    case OP_ORR:
-    case OP_EOR: {
-        Register rt{(IR >> 21) & 0x1F, regWidth};
-        Register rn{(IR >> 16) & 0x1F, regWidth};
-        Register rm{IR & 0x1F, regWidth};
-        instr = InstructionBuilder::buildDataProcReg(convertToDataProcOp(opcode), rt, rn, rm);
-        break;
-    }
-        
-    case OP_ADDI:
-    case OP_SUBI:
-    case OP_ANDI:
-    case OP_ORRI:
-    case OP_EORI: {
-        Register rt{(IR >> 21) & 0x1F, regWidth};
-        Register rn{(IR >> 16) & 0x1F, regWidth};
-        Immediate imm{IR & 0xFFFF};
-        instr = InstructionBuilder::buildDataProcImm(convertToDataProcOp(opcode), rt, rn, imm);
-        break;
-    }
-
-    case OP_MOV: {
-        Register rt{(IR >> 21) & 0x1F, regWidth};
-        Register rn{(IR >> 16) & 0x1F, regWidth};
-        instr = InstructionBuilder::buildMoveReg(rt, rn);
-        break;
+// ====================== 内存布局 ======================
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::setMemoryLayout(const MemoryLayout& newLayout) {
+    const uint64_t memSize = newLayout.memSize;
+    if (memSize == 0 || memSize % CODE_PAGE_SIZE != 0) {
+        throw std::runtime_error("Memory size must be a nonzero multiple of 4KB");
     }
-    case OP_MOVI: {
-        Register rt{(IR >> 21) & 0x1F, regWidth};
-        Immediate imm{IR & 0xFFFF};
-        instr = InstructionBuilder::buildMoveImm(rt, imm);
-        break;
-    }
-
-    case OP_CMP: {
-        Register rt{(IR >> 21) & 0x1F, regWidth};
-        Register rn{(IR >> 16) & 0x1F, regWidth};
-        instr = InstructionBuilder::buildCompare(rt, rn);
-        break;
+    if (newLayout.codeSize == 0 || newLayout.codeSize % CODE_PAGE_SIZE != 0 || newLayout.codeSize > memSize) {
+        throw std::runtime_error("Code region must be whole pages within memory");
     }
-    case OP_CMPI: {
-        Register rt{(IR >> 21) & 0x1F, regWidth};
-        Immediate imm{IR & 0xFFFF};
-        instr = InstructionBuilder::buildCompareImm(rt, imm);
-        break;
-    } 
-
-    case OP_LDRB:
-    case OP_LDRH:
-    case OP_LDRW:
-    case OP_LDRD:
-    case OP_STRB:
-    case OP_STRH:
-    case OP_STRW:
-    case OP_STRD: {
-        Register rt{(IR >> 21) & 0x1F, regWidth};
-        Register rn{(IR >> 16) & 0x1F, regWidth};
-        Immediate offset{IR & 0xFFFF}; // 有符号偏移量
-        if (offset.value & 0x8000) { // 符号扩展
-            offset.value |= 0xFFFF0000;
-        }
-        instr = InstructionBuilder::buildLoadStore(convertToMemoryOp(opcode), rt, MemoryOperand{rn, offset});
-        break;
+    if (newLayout.stackBase > memSize || newLayout.stackLimit > newLayout.stackBase) {
+        throw std::runtime_error("Stack must lie within memory");
     }
-
-    case OP_B: {
-        Immediate offset = IR & 0x03FFFFFF;
-        if (offset.value & 0x02000000) { // 符号扩展
-            offset.value |= 0xFC000000;
+    if constexpr (Config::BOUNDS == BoundsCheck::WRAP) {
+        if ((memSize & (memSize - 1)) != 0) {
+            throw std::runtime_error("BoundsCheck::WRAP needs a power-of-two memory size");
         }
-        instr = InstructionBuilder::buildBranch(offset);
-        break;
     }
-
-    case OP_B_COND: {
-        BranchCondition condition = static_cast<BranchCondition>((IR >> 22) & 0x0F);
-        Immediate offset = IR & 0x03FFFFFF;
-        if (offset.value & 0x02000000) { // 符号扩展
-            offset.value |= 0xFC000000;
+    if constexpr (Config::MEMORY == MemoryModel::PAGED) {
+        if (memSize > (1ULL << PagedMemory::ADDRESS_BITS)) {
+            throw std::runtime_error("Memory size exceeds the paged address space");
         }
-        instr = InstructionBuilder::buildBranch(offset, condition);
-        break;
     }
-
-    case OP_BL: {
-        Immediate offset = IR & 0x03FFFFFF;
-        if (offset.value & 0x02000000) { // 符号扩展
-            offset.value |= 0xFC000000;
+    if constexpr (Config::MEMORY == MemoryModel::GUARDED) {
+        if (newLayout.codeSize > newLayout.stackLimit - newLayout.stackGuard) {
+            throw std::runtime_error("Code region must not overlap the stack guard");
         }
-        instr = InstructionBuilder::buildBranch(offset, BranchCondition::AL, true);
-        break;
-    }
-
-    case OP_BLR: {
-        Register rt{(IR >> 21) & 0x1F, RegWidth::X};
-        instr = InstructionBuilder::buildBranchReg(rt, true);
-        break;
-    }
-
-    case OP_BR: {
-        Register rt{(IR >> 21) & 0x1F, RegWidth::X};
-        instr = InstructionBuilder::buildBranchReg(rt, false);
-        break;
     }
 
-    case OP_NOP:
-    case OP_RET:
-    case OP_HLT:
-        instr = InstructionBuilder::buildSystem(convertToSystemOp(opcode));
-        break;
-        
-    default:
-        throw std::runtime_error("Unknown opcode: " + std::to_string(opcode));
-    }
-    
-    return instr;
-}
+    memory.configure(newLayout, MEM_PADDING);
+    layout = newLayout;
 
-// ====================== 执行阶段 ======================
-void CPU::execute(const InstructionFormat& instr) {
-    switch (instr.type) {
-        case InstructionType::DATA_PROCESSING_REG:
-        case InstructionType::DATA_PROCESSING_IMM:
-            executeDataProcessing(instr);
-            break;
-            
-        case InstructionType::LOAD_STORE:
-            executeLoadStore(instr);
-            break;
-            
-        case InstructionType::BRANCH_UNCOND:
-        case InstructionType::BRANCH_COND:
-        case InstructionType::BRANCH_LINK:
-        case InstructionType::BRANCH_REG:
-            executeBranch(instr);
-            break;
-            
-        case InstructionType::COMPARE:
-            executeCompare(instr);
-            break;
-            
-        case InstructionType::MOVE_REG:
-        case InstructionType::MOVE_IMM:
-            executeMove(instr);
-            break;
-            
-        case InstructionType::MULTIPLY:
-        case InstructionType::DIVIDE:
-            executeMultiplyDivide(instr);
-            break;
-            
-        case InstructionType::SYSTEM:
-            executeSystem(instr);
-            break;
-            
-        default:
-            throw std::runtime_error("Unknown instruction type");
-    }
+    // 预译码缓存按代码区重新分配；reset() 随后丢弃引用旧代码页的基本块与JIT代码
+    codeCache.assign((layout.codeSize + MEM_PADDING + CODE_PAGE_SIZE - 1) >> CODE_PAGE_SHIFT, nullptr);
+    codePageStorage.clear();
+    layoutGeneration = ++generation;
+    reset();
 }
 
-// 数据处理指令执行
-void CPU::executeDataProcessing(const InstructionFormat& instr) {
-    auto& info = std::get<DataProcInfo>(instr.details);
-    
-    // 获取操作数
-    uint64_t operand1 = getRegisterValue(info.rn);
-    uint64_t operand2;
-    
-    if (instr.type == InstructionType::DATA_PROCESSING_IMM) {
-        operand2 = info.imm.getSignExtended();
-    } else {
-        operand2 = getRegisterValue(info.rm);
-    }
-    
-    // 应用移位（如果有）
-    if (info.shift > 0 && instr.type == InstructionType::DATA_PROCESSING_REG) {
-        operand2 = operand2 << info.shift;
-    }
-    
-    // 执行ALU操作
-    ALUOp aluOp = convertToALUOp(info.operation);
-    bool is32bit = info.rd.is32Bit();
-    
-    aluOperation(aluOp, info.rd.number, operand1, operand2, is32bit);
-}
-
-// 内存访问指令执行
-void CPU::executeLoadStore(const InstructionFormat& instr) {
-    auto& info = std::get<MemoryInfo>(instr.details);
-    
-    // 计算内存地址
-    uint64_t baseAddr = getRegisterValue(info.address.baseReg);
-    uint64_t address = baseAddr + info.address.offset.getSignExtended();
-    
-    if (info.address.hasIndex) {
-        address += getRegisterValue(info.address.indexReg);
-    }
-    
-    // 执行内存操作
-    switch (info.operation) {
-        case MemoryOp::LOAD_BYTE:
-            setRegisterValue(info.rt, readMemory<uint8_t>(address));
-            break;
-        case MemoryOp::LOAD_HALF:
-            setRegisterValue(info.rt, readMemory<uint16_t>(address));
-            break;
-        case MemoryOp::LOAD_WORD:
-            setRegisterValue(info.rt, readMemory<uint32_t>(address));
-            break;
-        case MemoryOp::LOAD_DWORD:
-            setRegisterValue(info.rt, readMemory<uint64_t>(address));
-            break;
-        case MemoryOp::STORE_BYTE:
-            writeMemory<uint8_t>(address, static_cast<uint8_t>(getRegisterValue(info.rt)));
-            break;
-        case MemoryOp::STORE_HALF:
-            writeMemory<uint16_t>(address, static_cast<uint16_t>(getRegisterValue(info.rt)));
-            break;
-        case MemoryOp::STORE_WORD:
-            writeMemory<uint32_t>(address, static_cast<uint32_t>(getRegisterValue(info.rt)));
-            break;
-        case MemoryOp::STORE_DWORD:
-            writeMemory<uint64_t>(address, static_cast<uint64_t>(getRegisterValue(info.rt)));
-            break;
-    }
-    
-    // 处理前/后索引模式
-    if (info.address.preIndex || info.address.postIndex) {
-        uint64_t newBaseAddr = info.address.postIndex ? 
-            address : baseAddr + info.address.offset.getSignExtended();
-        setRegisterValue(info.address.baseReg, newBaseAddr);
-    }
-}
-
-// 分支指令执行
-void CPU::executeBranch(const InstructionFormat& instr) {
-    auto& info = std::get<BranchInfo>(instr.details);
-    
-    bool shouldBranch = true;
-    
-    if (instr.type == InstructionType::BRANCH_COND) {
-        shouldBranch = checkCondition(info.condition);
-    }
-    
-    if (shouldBranch) {
-        if (info.isLink) {
-            regs[30] = PC;  // 保存返回地址到LR (X30)
-        }
-        
-        if (instr.type == InstructionType::BRANCH_REG) {
-            PC = getRegisterValue(info.target);
-        } else {
-            PC = PC + (info.offset.getSignExtended() << 2);
+// ====================== 变化代数 ======================
+template<typename Config, typename Hooks>
+uint64_t BasicCPU<Config, Hooks>::publishChanges() {
+    ++generation;
+    memory.publish(generation);
+    for (int i = 0; i < NUM_REGS; ++i) {
+        if (regs[i] != publishedRegs[i]) {
+            publishedRegs[i] = regs[i];
+            regGenerations[i] = generation;
         }
     }
+    return generation;
 }
 
-// 比较指令执行
-void CPU::executeCompare(const InstructionFormat& instr) {
-    auto& info = std::get<CompareInfo>(instr.details);
-    
-    uint64_t operand1 = getRegisterValue(info.rn);
-    uint64_t operand2 = info.useImmediate ? 
-        info.imm.getSignExtended() : getRegisterValue(info.rm);
-    
-    // 比较操作不写回结果，只更新标志位
-    bool is32bit = info.rn.is32Bit();
-    aluOperation(ALUOp::CMP, 0, operand1, operand2, is32bit);
+// 只报告内存范围之内的页（WRAP 方式的填充字节不计）
+template<typename Config, typename Hooks>
+std::vector<uint64_t> BasicCPU<Config, Hooks>::getPagesChangedSince(uint64_t gen) const {
+    std::vector<uint64_t> pages = memory.pagesChangedSince(gen);
+    const uint64_t memPages = layout.memSize >> GUEST_PAGE_SHIFT;
+    while (!pages.empty() && pages.back() >= memPages) pages.pop_back();
+    return pages;
 }
 
-// 移动指令执行
-void CPU::executeMove(const InstructionFormat& instr) {
-    auto& info = std::get<MoveInfo>(instr.details);
-    
-    uint64_t value;
-    if (info.useImmediate) {
-        value = info.imm.getSignExtended();
-    } else {
-        value = getRegisterValue(info.rn);
-    }
-    
-    setRegisterValue(info.rd, value);
-}
-
-// 乘除指令执行
-void CPU::executeMultiplyDivide(const InstructionFormat& instr) {
-    auto& info = std::get<MulDivInfo>(instr.details);
-    
-    uint64_t operand1 = getRegisterValue(info.rn);
-    uint64_t operand2 = getRegisterValue(info.rm);
-    
-    ALUOp op = info.isSigned ? ALUOp::SDIV : ALUOp::UDIV;
-    if (instr.type == InstructionType::MULTIPLY) {
-        op = ALUOp::MUL;
+// ====================== 虚拟内存 ======================
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::setTranslationTable(uint64_t root) {
+    if (root % GUEST_PAGE_SIZE != 0 || root > layout.memSize - GUEST_PAGE_SIZE) {
+        throw std::runtime_error("Translation table must be a page within memory: " + std::to_string(root));
     }
-    
-    bool is32bit = info.rd.is32Bit();
-    aluOperation(op, info.rd.number, operand1, operand2, is32bit);
+    translationTable = root;
+    tlb.flush();
 }
 
-// 系统指令执行
-void CPU::executeSystem(const InstructionFormat& instr) {
-    auto& info = std::get<SystemInfo>(instr.details);
-    
-    switch (info.operation) {
-        case SystemOp::NOP: // NOP
-            break;
-        case SystemOp::RET: // RET
-            PC = regs[30];
-            break;
-        case SystemOp::HLT: // HLT
-            throw std::runtime_error("HLT instruction executed");
-        default:
-            throw std::runtime_error("Unknown system operation");
+template<typename Config, typename Hooks>
+bool BasicCPU<Config, Hooks>::translateAddress(uint64_t address, MemoryAccess access, uint64_t& physical) {
+    physical = address;
+    if constexpr (Config::MMU) {
+        return translateSlow(access, physical, 1);
+    } else {
+        return address < (access == MemoryAccess::FETCH ? layout.codeSize : layout.memSize);
     }
 }
 
-// ====================== 数据转换 ======================
-ALUOp CPU::convertToALUOp(DataProcOp op) const {
-    switch (op) {
-        case DataProcOp::ADD:
-        case DataProcOp::ADDS:
-            return ALUOp::ADD;
-        case DataProcOp::SUB:
-        case DataProcOp::SUBS:
-            return ALUOp::SUB;
-        case DataProcOp::AND:
-        case DataProcOp::ANDS:
-            return ALUOp::AND;
-        case DataProcOp::ORR:
-            return ALUOp::ORR;
-        case DataProcOp::EOR:
-            return ALUOp::EOR;
-        case DataProcOp::MUL:
-            return ALUOp::MUL;
-        case DataProcOp::SDIV:
-            return ALUOp::SDIV;
-        case DataProcOp::UDIV:
-            return ALUOp::UDIV;
-        default:
-            throw std::runtime_error("Unsupported data processing operation");
-    }
+// 未命中、未对齐或跨页的访问：逐页转换，跨页时两页须在物理内存中相邻（否则按错误处理）
+template<typename Config, typename Hooks>
+bool BasicCPU<Config, Hooks>::translateSlow(MemoryAccess access, uint64_t& address, size_t size) {
+    uint64_t first = address;
+    if (!translatePage(access, first)) return false;
+    uint64_t lastPage = (address + size - 1) & ~(GUEST_PAGE_SIZE - 1);
+    if (lastPage != (address & ~(GUEST_PAGE_SIZE - 1))) {
+        if (!translatePage(access, lastPage)) return false;
+        if (lastPage != (first & ~(GUEST_PAGE_SIZE - 1)) + GUEST_PAGE_SIZE) return false;
+    }
+    address = first;
+    return true;
 }
 
-DataProcOp CPU::convertToDataProcOp(uint8_t opcode) const {
-    switch (static_cast<Opcode>(opcode)) {
-        case OP_ADD:
-        case OP_ADDI:
-            return DataProcOp::ADD;
-        case OP_SUB:
-        case OP_SUBI:
-            return DataProcOp::SUB;
-        case OP_AND:
-        case OP_ANDI:
-            return DataProcOp::AND;
-        case OP_ORR:
-        case OP_ORRI:
-            return DataProcOp::ORR;
-        case OP_EOR:
-        case OP_MUL:
-            return DataProcOp::MUL;
-        case OP_SDIV:
-            return DataProcOp::SDIV;
-        case OP_UDIV:
-            return DataProcOp::UDIV;
-
-        // case OP_LSL:
-        //     return DataProcOp::LSL;
-        // case OP_LSR:
-        //     return DataProcOp::LSR;
-        // case OP_ASR:
-        //     return DataProcOp::ASR;
-        // case OP_ROR:
-        //     return DataProcOp::ROR;
-
-        default:
-            throw std::runtime_error("Unsupported opcode for DataProcOp");
-    }
-}
-
-MemoryOp CPU::convertToMemoryOp(uint8_t opcode) const {
-    switch (static_cast<Opcode>(opcode)) {
-        case OP_LDRB: return MemoryOp::LOAD_BYTE;
-        case OP_LDRH: return MemoryOp::LOAD_HALF;
-        case OP_LDRW: return MemoryOp::LOAD_WORD;
-        case OP_LDRD: return MemoryOp::LOAD_DWORD;
-        case OP_STRB: return MemoryOp::STORE_BYTE;
-        case OP_STRH: return MemoryOp::STORE_HALF;
-        case OP_STRW: return MemoryOp::STORE_WORD;
-        case OP_STRD: return MemoryOp::STORE_DWORD;
-
-        default:
-            throw std::runtime_error("Unsupported opcode for DataProcOp");
+// 转换 address 所在的页，未命中时遍历页表并替换TLB项
+template<typename Config, typename Hooks>
+bool BasicCPU<Config, Hooks>::translatePage(MemoryAccess access, uint64_t& address) {
+    SoftTLB::Entry& entry = tlb.entryFor(address);
+    const uint64_t page = address & ~(GUEST_PAGE_SIZE - 1);
+    if (entry.tags[static_cast<int>(access)] == page) {
+        ++tlb.hits;
+    } else {
+        ++tlb.misses;
+        if (!refillTlb(entry, page) || entry.tags[static_cast<int>(access)] != page) return false;
     }
+    address += entry.offset;
+    return true;
 }
 
-SystemOp CPU::convertToSystemOp(uint8_t opcode) const {
-    switch (static_cast<Opcode>(opcode)) {
-        case OP_NOP: return SystemOp::NOP;
-        case OP_RET: return SystemOp::RET;
-        case OP_HLT: return SystemOp::HLT;
-
-        default:
-            throw std::runtime_error("Unsupported opcode for DataProcOp");
-    }
+// 物理页须在内存之内，可执行的页还须在代码区之内（预译码缓存按物理地址索引）
+template<typename Config, typename Hooks>
+bool BasicCPU<Config, Hooks>::refillTlb(SoftTLB::Entry& entry, uint64_t page) {
+    uint64_t physical = page;
+    uint64_t permissions = PTE_READ | PTE_WRITE | PTE_EXEC;
+    if (translationTable != NO_TRANSLATION) {
+        uint64_t descriptor;
+        if (!walkPageTable(memory, layout.memSize, translationTable, page, descriptor)) return false;
+        physical = descriptor & PTE_ADDRESS_MASK;
+        permissions = descriptor;
+    }
+    if (physical >= layout.memSize) return false;
+
+    entry.tags[static_cast<int>(MemoryAccess::READ)] = (permissions & PTE_READ) ? page : SoftTLB::INVALID_TAG;
+    entry.tags[static_cast<int>(MemoryAccess::WRITE)] = (permissions & PTE_WRITE) ? page : SoftTLB::INVALID_TAG;
+    entry.tags[static_cast<int>(MemoryAccess::FETCH)] =
+        (permissions & PTE_EXEC) && physical < layout.codeSize ? page : SoftTLB::INVALID_TAG;
+    entry.offset = physical - page;
+    return true;
 }
 
-// ====================== ALU操作 ======================
-void CPU::aluOperation(ALUOp op, uint8_t rd, uint64_t a, uint64_t b, bool is32bit) {
-    uint64_t result = 0;
-    bool carry = false;
-    bool overflow = false;
-    
-    if (is32bit) {
-        // 32位操作：截断输入为32位
-        int32_t a32 = static_cast<int32_t>(a & 0xFFFFFFFF);
-        int32_t b32 = static_cast<int32_t>(b & 0xFFFFFFFF);
-        int32_t result32 = 0;
-        
-        switch (op) {
-        case ALUOp::ADD:
-            result32 = a32 + b32;
-            carry = (static_cast<uint32_t>(result32) < static_cast<uint32_t>(a32));
-            overflow = ((a32 ^ result32) & (b32 ^ result32)) >> 31;
-            break;
-            
-        case ALUOp::SUB:
-            result32 = a32 - b32;
-            carry = (static_cast<uint32_t>(a32) >= static_cast<uint32_t>(b32));
-            overflow = ((a32 ^ b32) & (a32 ^ result32)) >> 31;
-            break;
-            
-        case ALUOp::MUL:
-            result32 = a32 * b32;
-            break;
-            
-        case ALUOp::SDIV:
-            if (b32 == 0) throw std::runtime_error("Division by zero");
-            result32 = a32 / b32;
-            break;
-            
-        case ALUOp::UDIV:
-            if (b32 == 0) throw std::runtime_error("Division by zero");
-            result32 = static_cast<uint32_t>(a32) / static_cast<uint32_t>(b32);
-            break;
-            
-        case ALUOp::AND:
-            result32 = a32 & b32;
-            break;
-            
-        case ALUOp::ORR:
-            result32 = a32 | b32;
-            break;
-            
-        case ALUOp::EOR:
-            result32 = a32 ^ b32;
-            break;
-            
-        case ALUOp::CMP:
-            result32 = a32 - b32;
-            statusReg.N = (result32 >> 31) & 1;
-            statusReg.Z = (result32 == 0);
-            statusReg.C = (static_cast<uint32_t>(a32) >= static_cast<uint32_t>(b32));
-            statusReg.V = ((a32 ^ b32) & (a32 ^ result32)) >> 31;
-            return;
-            
-        default:
-            throw std::runtime_error("Unsupported ALU operation");
+// ====================== 批量内存指令 ======================
+// 与 AArch64 FEAT_MOPS 相同地分三步：P 检查参数并选择方向，M 完成主体，E 完成剩余部分。
+// 这里 M 与 E 的做法相同：每次至多处理 MOPS_CHUNK 字节（MMU 方式下不跨页），更新寄存器后
+// 若未完成则把PC退回本指令，下次执行从寄存器记录的位置继续，因此可以在任意一段之后中断、恢复或保存快照。
+// 出错时寄存器停在已完成的位置，错误地址为出错段的起始地址（虚拟地址）
+
+// Xd 为目的地址，Xs 为源地址，Xn 为字节数。CPYP 在目的区间从上方与源区间重叠时改为从高地址向低地址复制：
+// 把 Xd/Xs 移到区间末尾并把 Xn 取负，之后每段先减地址再复制
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::bulkCopy(MopsStage stage, uint8_t rd, uint8_t rs, uint8_t rn) {
+    uint64_t dst = regs[rd], src = regs[rs];
+    int64_t count = static_cast<int64_t>(regs[rn]);
+
+    if (stage == MopsStage::PROLOGUE) {
+        if (count < 0) count = INT64_MAX;        // 大于 INT64_MAX 的字节数按 INT64_MAX 处理
+        if (dst > src && dst - src < static_cast<uint64_t>(count)) {
+            dst += count;
+            src += count;
+            count = -count;
         }
-        
-        result = static_cast<uint64_t>(static_cast<uint32_t>(result32));
-        
-        // 更新状态寄存器（基于32位结果）
-        statusReg.N = (result32 >> 31) & 1;
-        statusReg.Z = (result32 == 0);
-        statusReg.C = carry;
-        statusReg.V = overflow;
-        
-    } else {
-        // 64位操作
-        int64_t a64 = static_cast<int64_t>(a);
-        int64_t b64 = static_cast<int64_t>(b);
-        int64_t result64 = 0;
-        
-        switch (op) {
-        case ALUOp::ADD:
-            result64 = a64 + b64;
-            carry = (static_cast<uint64_t>(result64) < static_cast<uint64_t>(a64));
-            overflow = ((a64 ^ result64) & (b64 ^ result64)) >> 63;
-            break;
-            
-        case ALUOp::SUB:
-            result64 = a64 - b64;
-            carry = (static_cast<uint64_t>(a64) >= static_cast<uint64_t>(b64));
-            overflow = ((a64 ^ b64) & (a64 ^ result64)) >> 63;
-            break;
-            
-        case ALUOp::MUL:
-            result64 = a64 * b64;
-            break;
-            
-        case ALUOp::SDIV:
-            if (b64 == 0) throw std::runtime_error("Division by zero");
-            result64 = a64 / b64;
-            break;
-            
-        case ALUOp::UDIV:
-            if (b64 == 0) throw std::runtime_error("Division by zero");
-            result64 = static_cast<uint64_t>(a64) / static_cast<uint64_t>(b64);
-            break;
-            
-        case ALUOp::AND:
-            result64 = a64 & b64;
-            break;
-            
-        case ALUOp::ORR:
-            result64 = a64 | b64;
-            break;
-            
-        case ALUOp::EOR:
-            result64 = a64 ^ b64;
-            break;
-            
-        case ALUOp::CMP:
-            result64 = a64 - b64;
-            statusReg.N = (result64 >> 63) & 1;
-            statusReg.Z = (result64 == 0);
-            statusReg.C = (static_cast<uint64_t>(a64) >= static_cast<uint64_t>(b64));
-            statusReg.V = ((a64 ^ b64) & (a64 ^ result64)) >> 63;
-            return;
-            
-        default:
-            throw std::runtime_error("Unsupported ALU operation");
+    } else if (count != 0) {
+        const bool forward = count > 0;
+        const uint64_t remaining = forward ? count : 0 - static_cast<uint64_t>(count);
+        uint64_t to = dst, from = src;
+        uint64_t n;
+        if (forward) {
+            n = bulkChunk(remaining, to, from);
+        } else {
+            // 向下复制时按本段的最后一个字节对齐页边界
+            n = bulkChunk(remaining, ~(dst - 1), ~(src - 1));
+            to -= n;
+            from -= n;
         }
-        
-        result = static_cast<uint64_t>(result64);
-        
-        // 更新状态寄存器（基于64位结果）
-        statusReg.N = (result64 >> 63) & 1;
-        statusReg.Z = (result64 == 0);
-        statusReg.C = carry;
-        statusReg.V = overflow;
-    }
-    
-    // 写回结果到寄存器
-    if (rd < NUM_REGS) {
-        regs[rd] = result;
-    }
-}
-
-// ====================== 条件检查 ======================
-bool CPU::checkCondition(BranchCondition condition) const {
-    switch (condition) {
-        case BranchCondition::EQ: return statusReg.Z;
-        case BranchCondition::NE: return !statusReg.Z;
-        case BranchCondition::CS: return statusReg.C;
-        case BranchCondition::CC: return !statusReg.C;
-        case BranchCondition::MI: return statusReg.N;
-        case BranchCondition::PL: return !statusReg.N;
-        case BranchCondition::VS: return statusReg.V;
-        case BranchCondition::VC: return !statusReg.V;
-        case BranchCondition::HI: return statusReg.C && !statusReg.Z;
-        case BranchCondition::LS: return !statusReg.C || statusReg.Z;
-        case BranchCondition::GE: return statusReg.N == statusReg.V;
-        case BranchCondition::LT: return statusReg.N != statusReg.V;
-        case BranchCondition::GT: return !statusReg.Z && (statusReg.N == statusReg.V);
-        case BranchCondition::LE: return statusReg.Z || (statusReg.N != statusReg.V);
-        case BranchCondition::AL: return true;
-        case BranchCondition::NV: return false;
-        default: return false;
+        uint64_t physicalTo = to, physicalFrom = from;
+        if (!bulkAddress<MemoryAccess::READ>(physicalFrom, n)) return memoryFault(MemoryAccess::READ, from);
+        if (!bulkAddress<MemoryAccess::WRITE>(physicalTo, n)) return memoryFault(MemoryAccess::WRITE, to);
+        memory.move(physicalTo, physicalFrom, n);
+        invalidateCodeRange(physicalTo, n);
+
+        if (forward) {
+            dst += n;
+            src += n;
+            count -= n;
+        } else {
+            dst -= n;
+            src -= n;
+            count += n;
+        }
+        if (count != 0) PC -= 4;
     }
+    regs[rd] = dst;
+    regs[rs] = src;
+    regs[rn] = static_cast<uint64_t>(count);
+    return StopReason::NONE;
 }
 
-// ====================== 寄存器操作 ======================
-uint64_t CPU::getXReg(uint8_t reg) const {
-    if (reg >= NUM_REGS) throw std::runtime_error("Invalid register number");
-    return regs[reg];
-}
-
-void CPU::setXReg(uint8_t reg, uint64_t value) {
-    if (reg >= NUM_REGS) throw std::runtime_error("Invalid register number");
-    regs[reg] = value;
+// Xd 为目的地址，Xn 为字节数，Xs 的低8位为填充值；总是从低地址向高地址填充
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::bulkSet(MopsStage stage, uint8_t rd, uint8_t rn, uint8_t rs) {
+    uint64_t dst = regs[rd];
+    int64_t count = static_cast<int64_t>(regs[rn]);
+
+    if (stage == MopsStage::PROLOGUE) {
+        if (count < 0) count = INT64_MAX;
+    } else if (count > 0) {
+        uint64_t n = bulkChunk(count, dst, dst);
+        uint64_t physical = dst;
+        if (!bulkAddress<MemoryAccess::WRITE>(physical, n)) return memoryFault(MemoryAccess::WRITE, dst);
+        memory.fill(physical, static_cast<uint8_t>(regs[rs]), n);
+        invalidateCodeRange(physical, n);
+
+        dst += n;
+        count -= n;
+        if (count != 0) PC -= 4;
+    }
+    regs[rd] = dst;
+    regs[rn] = static_cast<uint64_t>(count);
+    return StopReason::NONE;
 }
 
-uint32_t CPU::getWReg(uint8_t reg) const {
-    if (reg >= NUM_REGS) throw std::runtime_error("Invalid register number");
-    return static_cast<uint32_t>(regs[reg] & 0xFFFFFFFF);
-}
-
-void CPU::setWReg(uint8_t reg, uint32_t value) {
-    if (reg >= NUM_REGS) throw std::runtime_error("Invalid register number");
-    // 写入W寄存器时，高32位清零
-    regs[reg] = static_cast<uint32_t>(value & 0xFFFFFFFF);
-}
-
-uint64_t CPU::getRegisterValue(const Register& reg) {
-    if (reg.is32Bit()) {
-        return getWReg(reg.number);
-    } else {
-        return getXReg(reg.number);
-    }
-}
-
-void CPU::setRegisterValue(const Register& reg, uint64_t value) {
-    if (reg.is32Bit()) {
-        setWReg(reg.number, static_cast<uint32_t>(value));
-    } else {
-        setXReg(reg.number, value);
-    }
+// ====================== 派生 ======================
+template<typename Config, typename Hooks>
+std::unique_ptr<BasicCPU<Config, Hooks>> BasicCPU<Config, Hooks>::fork() {
+    std::unique_ptr<BasicCPU> child(new BasicCPU(Unconfigured{}));
+    child->memory.forkFrom(memory);
+    child->layout = layout;
+    child->codeCache.assign(codeCache.size(), nullptr);
+
+    child->regs = regs;
+    child->PC = PC;
+    child->IR = IR;
+    child->statusReg = statusReg;
+    child->flagOp = flagOp;
+    child->flagA = flagA;
+    child->flagB = flagB;
+    child->flagResult = flagResult;
+    child->steps = steps;
+    child->hooks = hooks;
+    child->fusionEnabled = fusionEnabled;
+    child->generation = generation;
+    child->layoutGeneration = layoutGeneration;
+    child->publishedRegs = publishedRegs;
+    child->regGenerations = regGenerations;
+    child->translationTable = translationTable;
+    child->tlb = tlb;
+    return child;
 }
 
 // 打印当前状态
-void CPU::printState() const {
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::printState() const {
     std::cout << "===== CPU State =====" << std::endl;
     std::cout << "PC: 0x" << std::hex << std::setw(16) << std::setfill('0') << PC << std::dec << std::endl;
     std::cout << "SP: 0x" << std::hex << std::setw(16) << std::setfill('0') << regs[31] << std::dec << std::endl;
     std::cout << "IR: 0x" << std::hex << std::setw(8) << std::setfill('0') << IR << std::dec << std::endl;
-    std::cout << "Status: " << statusReg.toString() << std::endl;
+    std::cout << "Status: " << getStatusReg().toString() << std::endl;
     
     std::cout << "Registers:" << std::endl;
     for (int i = 0; i < 31; i++) {
@@ -660,18 +302,19 @@ void CPU::printState() const {
             if (i > 0) std::cout << std::endl;
             std::cout << "0x" << std::hex << std::setw(4) << std::setfill('0') << i << ": ";
         }
-        std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(memory[i]) << " ";
+        std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(memory.template read<uint8_t>(i)) << " ";
     }
     std::cout << std::dec << std::endl << std::endl;
 }
 
-void CPU::printRegisterState() const {
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::printRegisterState() const {
     std::ostringstream oss;
     oss << "===== CPU State =====\n";
     oss << "PC: 0x" << std::hex << std::setw(16) << std::setfill('0') << PC << std::dec << "\n";
     oss << "SP: 0x" << std::hex << std::setw(16) << std::setfill('0') << regs[31] << std::dec << "\n";
     oss << "IR: 0x" << std::hex << std::setw(8) << std::setfill('0') << IR << std::dec << "\n";
-    oss << "Status: " << statusReg.toString() << "\n";
+    oss << "Status: " << getStatusReg().toString() << "\n";
     
     oss << "Registers:\n";
     for (int i = 0; i < 31; i++) {
@@ -683,7 +326,8 @@ void CPU::printRegisterState() const {
     LOGI(LOG_INSTANCE("CPU"), "%s", oss.str().c_str());
 }
 
-void CPU::printMemoryState(size_t n) const {
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::printMemoryState(size_t n) const {
     std::ostringstream oss;
     oss << "Memory:\n";
     for (size_t i = 0; i < n; i++) {
@@ -691,8 +335,27 @@ void CPU::printMemoryState(size_t n) const {
             if (i > 0) oss << "\n";
             oss << "0x" << std::hex << std::setw(4) << std::setfill('0') << i << ": ";
         }
-        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(memory[i]) << " ";
+        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(memory.template read<uint8_t>(i)) << " ";
     }
     oss << std::dec << "\n\n";
     LOGI(LOG_INSTANCE("CPU"), "%s", oss.str().c_str());
 }
+
+#define INSTANTIATE_CPU(CONFIG, HOOKS) \
+    template void BasicCPU<CONFIG, HOOKS>::setMemoryLayout(const MemoryLayout& newLayout); \
+    template std::unique_ptr<BasicCPU<CONFIG, HOOKS>> BasicCPU<CONFIG, HOOKS>::fork(); \
+    template uint64_t BasicCPU<CONFIG, HOOKS>::publishChanges(); \
+    template void BasicCPU<CONFIG, HOOKS>::setTranslationTable(uint64_t root); \
+    template bool BasicCPU<CONFIG, HOOKS>::translateAddress(uint64_t address, MemoryAccess access, uint64_t& physical); \
+    template bool BasicCPU<CONFIG, HOOKS>::translateSlow(MemoryAccess access, uint64_t& address, size_t size); \
+    template bool BasicCPU<CONFIG, HOOKS>::translatePage(MemoryAccess access, uint64_t& address); \
+    template bool BasicCPU<CONFIG, HOOKS>::refillTlb(SoftTLB::Entry& entry, uint64_t page); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::bulkCopy(MopsStage stage, uint8_t rd, uint8_t rs, uint8_t rn); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::bulkSet(MopsStage stage, uint8_t rd, uint8_t rn, uint8_t rs); \
+    template std::vector<uint64_t> BasicCPU<CONFIG, HOOKS>::getPagesChangedSince(uint64_t gen) const; \
+    template std::string BasicCPU<CONFIG, HOOKS>::describeStop(StopReason reason) const; \
+    template void BasicCPU<CONFIG, HOOKS>::printState() const; \
+    template void BasicCPU<CONFIG, HOOKS>::printRegisterState() const; \
+    template void BasicCPU<CONFIG, HOOKS>::printMemoryState(size_t n) const;
+TINY_CPU_CONFIGS(INSTANTIATE_CPU)
+#undef INSTANTIATE_CPU
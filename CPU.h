@@ -6,78 +6,253 @@
 #include <cstdint>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <stdexcept>
 #include <array>
 #include <utility>
+#include <type_traits>
+#include <memory>
+#include <cstring>
 
 #include "Assembler.h"
-#include "Instruction.h"
+#include "Register.h"
+#include "MicroOp.h"
+#include "Fusion.h"
+#include "CPUPolicies.h"
+#include "GuestMemory.h"
+#include "SoftMMU.h"
+#include "JitX64.h"
 #include "Enums.h"
 #include "Log.h"
 
+// ========================== 条件码查找表 ==========================
+
+// nzcv = N<<3 | Z<<2 | C<<1 | V
+constexpr bool conditionHolds(BranchCondition condition, uint32_t nzcv) {
+    bool n = nzcv & 8, z = nzcv & 4, c = nzcv & 2, v = nzcv & 1;
+    switch (condition) {
+        case BranchCondition::EQ: return z;
+        case BranchCondition::NE: return !z;
+        case BranchCondition::CS: return c;
+        case BranchCondition::CC: return !c;
+        case BranchCondition::MI: return n;
+        case BranchCondition::PL: return !n;
+        case BranchCondition::VS: return v;
+        case BranchCondition::VC: return !v;
+        case BranchCondition::HI: return c && !z;
+        case BranchCondition::LS: return !c || z;
+        case BranchCondition::GE: return n == v;
+        case BranchCondition::LT: return n != v;
+        case BranchCondition::GT: return !z && (n == v);
+        case BranchCondition::LE: return z || (n != v);
+        case BranchCondition::AL: return true;
+        case BranchCondition::NV: return false;
+        default: return false;
+    }
+}
+
+constexpr std::array<uint16_t, 16> makeConditionTable() {
+    std::array<uint16_t, 16> table{};
+    for (uint32_t cond = 0; cond < 16; ++cond) {
+        for (uint32_t nzcv = 0; nzcv < 16; ++nzcv) {
+            if (conditionHolds(static_cast<BranchCondition>(cond), nzcv)) {
+                table[cond] |= 1u << nzcv;
+            }
+        }
+    }
+    return table;
+}
+
+// 第 cond 项的第 nzcv 位为1表示该标志位组合下条件成立
+inline constexpr std::array<uint16_t, 16> CONDITION_TABLE = makeConditionTable();
+
 // ========================== 数据通路组件 ==========================
 
 // 模拟的CPU类
-class CPU {
+// Config 给出默认内存布局、存储方式与边界检查方式，Hooks 为逐条指令/访存/分支的观察钩子（见 CPUPolicies.h）
+// 成员函数在各 .cpp 中定义，并按 TINY_CPU_CONFIGS 列出的组合显式实例化
+template<typename Config, typename Hooks>
+class BasicCPU {
 public:
-    static const int32_t NUM_REGS     = 32;       // 31个通用寄存器
-    static const uint64_t MEM_SIZE    = 0x100000; // 1MB内存
-    static const uint64_t STACK_BASE  = 0x100000; // 栈顶
-    static const uint64_t STACK_LIMIT = 0x000800; // 栈底
+    static constexpr int32_t NUM_REGS     = 32;               // 31个通用寄存器
+    static constexpr BoundsCheck BOUNDS   = Config::BOUNDS;
+    static constexpr uint64_t CODE_PAGE_SHIFT = 12;                       // 预译码页 4KB
+    static constexpr uint64_t CODE_PAGE_SIZE  = 1ULL << CODE_PAGE_SHIFT;
+    static constexpr uint64_t CODE_PAGE_OPS   = CODE_PAGE_SIZE / 4;      // 每页微操作数
+    // WRAP 方式下跨越内存末尾的访问落在这些填充字节上
+    static constexpr uint64_t MEM_PADDING = Config::BOUNDS == BoundsCheck::WRAP ? 8 : 0;
     uint32_t steps;
 
-private:
-    CPU() : memory(MEM_SIZE, 0), PC(0), IR(0), statusReg{}, steps(0) {
-        reset();
+    using Memory = typename GuestMemoryFor<Config::MEMORY>::type;
+
+    static_assert(CODE_PAGE_SHIFT == GUEST_PAGE_SHIFT, "code pages are predecoded from whole memory pages");
+    static_assert(Config::MEMORY != MemoryModel::GUARDED || Config::BOUNDS == BoundsCheck::FAULT,
+                  "guarded memory reports out-of-bounds accesses as faults");
+    static_assert(!Config::MMU || (Config::MEMORY == MemoryModel::FLAT && Config::BOUNDS == BoundsCheck::FAULT),
+                  "virtual memory translates into flat, bounds-checked physical memory");
+
+    // 每个实例是一台独立的机器，可以在不同线程上同时执行（同一实例不能被多个线程同时使用）。
+    // 内存与代码缓存不可复制，需要副本时使用 fork()
+    BasicCPU() : BasicCPU(Config::LAYOUT) {}
+    // 布局无效时抛出异常
+    explicit BasicCPU(const MemoryLayout& initialLayout) : steps(0), PC(0), IR(0), statusReg{} {
+        setMemoryLayout(initialLayout);
     }
-    ~CPU() = default;
+    ~BasicCPU() = default;
 
-    CPU(const CPU&) = delete;
-    CPU& operator=(const CPU&) = delete;
+    BasicCPU(const BasicCPU&) = delete;
+    BasicCPU& operator=(const BasicCPU&) = delete;
 
-public:
-    static CPU& GetInstance() {
-        static CPU instance;
+    // 进程内共享的默认实例，供调试界面使用
+    static BasicCPU& GetInstance() {
+        static BasicCPU instance;
         return instance;
     }
 
+private:
+    // fork() 使用：内存与缓存由调用者建立
+    struct Unconfigured {};
+    explicit BasicCPU(Unconfigured) : steps(0), PC(0), IR(0), statusReg{} {}
+
+public:
+
     void reset() {
         PC = 0;
         IR = 0;
         statusReg.reset();
+        flagOp = FlagOp::NONE;
         std::fill(regs.begin(), regs.end(), 0);
-        std::fill(memory.begin(), memory.end(), 0);
-        regs[31] = STACK_BASE; // X31作为SP寄存器
+        memory.clear();     // 只清零上次复位以来写过的页
+        regs[31] = layout.stackBase; // X31作为SP寄存器
         steps = 0;
+        invalidateCodeCache();
+        blockCache.clear();
+        returnDepth = 0;
+        if (jit) jit->reset();
+        translationTable = NO_TRANSLATION;
+        tlb.flush();
+        tlb.hits = tlb.misses = 0;
+        exclusiveAddress = NO_EXCLUSIVE;
+    }
+
+    // 更换内存布局：校验后重新分配内存与预译码缓存并复位CPU；布局无效时抛出异常，原布局不变
+    void setMemoryLayout(const MemoryLayout& newLayout);
+    const MemoryLayout& getMemoryLayout() const { return layout; }
+    uint64_t getMemorySize() const { return layout.memSize; }
+
+    // 自上次 clearDirtyPages() 以来内容变化过的页号（升序，页大小为 GUEST_PAGE_SIZE），包括被 reset() 清零的页
+    std::vector<uint64_t> getDirtyPages() const { return memory.changedPages(); }
+    void clearDirtyPages() { memory.clearChanged(); }
+
+    // ====================== 变化代数 ======================
+    // publishChanges() 开始新的一代，并把上次发布以来改写过的内存页与寄存器的代数记为它。
+    // 观察者保存上次看到的代数，之后只读取代数更大的页与寄存器；执行时除脏页标记外没有额外开销。
+    // 更换布局（含恢复快照）后内存整体失效：观察者的代数小于 getLayoutGeneration() 时需要重新读取全部内容
+    uint64_t publishChanges();
+    uint64_t getGeneration() const { return generation; }
+    uint64_t getLayoutGeneration() const { return layoutGeneration; }
+    uint64_t getPageGeneration(uint64_t pageIndex) const { return memory.pageGeneration(pageIndex); }
+    std::vector<uint64_t> getPagesChangedSince(uint64_t gen) const;
+    uint64_t getRegisterGeneration(uint8_t idx) const { return regGenerations[idx]; }
+    // 第 i 位表示 X[i]（31为SP）的代数大于 gen
+    uint32_t getRegistersChangedSince(uint64_t gen) const {
+        uint32_t mask = 0;
+        for (int i = 0; i < NUM_REGS; ++i) mask |= static_cast<uint32_t>(regGenerations[i] > gen) << i;
+        return mask;
     }
 
+    // ====================== 虚拟内存 ======================
+    // 只在 Config::MMU 为 true 时有效（见 SoftMMU.h）。复位后不使用页表，虚拟地址即物理地址
+
+    // 以物理地址 root 处的表为第0级页表开始地址转换，并清空TLB；root 须按页对齐且位于内存之内，否则抛出异常
+    void setTranslationTable(uint64_t root);
+    void disableTranslation() {
+        translationTable = NO_TRANSLATION;
+        tlb.flush();
+    }
+    uint64_t getTranslationTable() const { return translationTable; }
+    // 修改已生效的页表后调用；执行中的程序在下次批量执行或 step() 时看到新的映射
+    void flushTlb() { tlb.flush(); }
+    // 转换 address 一次（计入TLB统计），成功时返回true并给出物理地址
+    bool translateAddress(uint64_t address, MemoryAccess access, uint64_t& physical);
+    // 复位以来的TLB命中与缺失次数，取指只在换页或跳转时转换
+    uint64_t getTlbHits() const { return tlb.hits; }
+    uint64_t getTlbMisses() const { return tlb.misses; }
+
+    // 派生一台独立的CPU：寄存器、PC、标志位、钩子状态与内存和本CPU相同。
+    // 内存页写时复制地共享，派生的开销与写过的页数而不是内存大小有关；之后双方互不影响。
+    // 预译码缓存、基本块与JIT代码不复制，由子CPU在执行时重建
+    std::unique_ptr<BasicCPU> fork();
+
+    // 保存完整的机器状态（内存布局与内容、寄存器、PC、IR、NZCV、steps）到 path，格式见 Snapshot.h；失败时抛出异常
+    void saveSnapshot(const std::string& path) const;
+    // 从 saveSnapshot() 写出的文件恢复，布局随之更换；连续内存直接私有映射文件中的页，不读取也不复制。
+    // 文件无效时抛出异常（布局校验通过之后才发现的错误会使CPU停在复位状态）
+    void loadSnapshot(const std::string& path);
+
     // 加载程序到内存
     void loadProgram(const std::vector<uint32_t>& program) {
-        if (program.size() * 4 > MEM_SIZE) {
+        if (program.size() * 4 > layout.codeSize) {
             throw std::runtime_error("Program too large for memory");
         }
         
         for (size_t i = 0; i < program.size(); i++) {
-            uint32_t word = program[i];
-            memory[i*4] = word & 0xFF;
-            memory[i*4+1] = (word >> 8) & 0xFF;
-            memory[i*4+2] = (word >> 16) & 0xFF;
-            memory[i*4+3] = (word >> 24) & 0xFF;
+            memory.template write<uint32_t>(i * 4, program[i]);
         }
+        invalidateCodeCache();
     }
 
-    // 执行一个指令周期
+    // 执行一个指令周期；HLT与错误以异常报告
     void step() {
-        // 1. 取指
-        fetch();
-        
-        // 2. 译码
-        InstructionFormat instr = decode();
-        
-        // 3. 执行
-        execute(instr);
+        // 取指/译码：命中预译码缓存时直接取出微操作，PC未对齐时临时译码
+        uint64_t address = PC;
+        if (!fetchAddress(address)) {
+            throw std::runtime_error(describeStop(memoryFault(MemoryAccess::FETCH, PC)));
+        }
+        MicroOp slowOp;
+        const MicroOp* uop;
+        if (address & 3) {
+            slowOp = predecode(readMemoryUnchecked<uint32_t>(address));
+            uop = &slowOp;
+        } else {
+            const CodePage* page;
+            uop = decodedAt(address, page);
+        }
+        IR = readMemoryUnchecked<uint32_t>(address);
+        hooks.onInstruction(PC, uop->index);
+        PC += 4;
+
+        // 执行
+        StopReason reason = catchGuardFault([&] { return uop->handler(*this, *uop); });
+        if (reason != StopReason::NONE) {
+            throw std::runtime_error(describeStop(reason));
+        }
     }
 
+    // ====================== 批量执行 ======================
+    // 以下接口连续执行至多 maxSteps 条指令，不抛出异常，返回停止原因；
+    // 实际执行的指令数（含导致停止的HLT/出错指令）由 getRunSteps() 给出。
+    // 停止时 PC/IR 与逐条 step() 到同一位置时一致
+
+    // 直接线程化解释器
+    StopReason run(uint64_t maxSteps);
+
+    // 同 run()，但在PC到达 pc 时（该指令执行前）停止；起始指令总会执行
+    StopReason runUntil(uint64_t pc, uint64_t maxSteps = UINT64_MAX);
+
+    // 基本块执行：按基本块批量执行，直接分支的后继块互相链接。
+    // 块内指令同样经标签地址分派、内联执行函数并保留融合序列，步数只在块首检查一次，
+    // 比 run() 少了逐条的步数与代码页检查（见 Benchmark.cpp）；也用作JIT的冷块执行与退路
+    StopReason runBlocks(uint64_t maxSteps);
+
+    // JIT执行：热点基本块编译为x86-64本地代码，其余情况退回基本块解释执行。
+    // 编译后的块经直接分支互相链接、在宿主寄存器中保留常用寄存器，见 Benchmark.cpp
+    // 宿主机不是x86-64或无法分配可执行内存时等同于 runBlocks
+    StopReason runJit(uint64_t maxSteps);
+
+    // 停止原因的文字描述（与 step() 抛出的异常信息相同）
+    std::string describeStop(StopReason reason) const;
+
     // 打印状态
     void printState() const;
     void printRegisterState() const;
@@ -88,77 +263,576 @@ public:
     uint64_t getPC() const { return PC; }
     uint64_t getSP() const { return regs[31]; }
     uint64_t getIR() const { return IR; }
-    StatusRegister getStatusReg() const { return statusReg; }
-    std::vector<uint8_t> getMemory() const { return memory; };
+    StatusRegister getStatusReg() const {
+        uint32_t f = nzcv();
+        return StatusRegister{(f & 8) != 0, (f & 4) != 0, (f & 2) != 0, (f & 1) != 0};
+    }
+    uint64_t getRunSteps() const { return runSteps; }
+    uint64_t getFaultAddress() const { return faultAddress; }
+    uint32_t getCoreId() const { return coreId; }
+    MemoryAccess getFaultAccess() const { return faultAccess; }
+    std::vector<uint8_t> getMemory() const {
+        static_assert(Memory::CONTIGUOUS, "use readMemoryRange() with sparse memory");
+        return readMemoryRange(0, layout.memSize);
+    }
+    // 不复制地只读访问 [address, address + size)；在下一次执行、复位或更换布局之前有效。
+    // 只适用于连续内存；范围越界（或与保护区重叠）时抛出异常
+    MemorySpan viewMemory(uint64_t address, size_t size) const {
+        static_assert(Memory::CONTIGUOUS, "use readMemoryRange() with sparse memory");
+        if (address > layout.memSize || size > layout.memSize - address) {
+            throw std::runtime_error("Memory view out of bounds: " + std::to_string(address));
+        }
+        if constexpr (Memory::FAULTS_BY_SIGNAL) {
+            if (!memory.accessible(address, size)) {
+                throw std::runtime_error("Memory view overlaps a guard region: " + std::to_string(address));
+            }
+        }
+        return MemorySpan(memory.data() + address, size);
+    }
+    // 从 address 开始的 size 个字节；不检查边界（保护区读出为0）
+    std::vector<uint8_t> readMemoryRange(uint64_t address, size_t size) const {
+        std::vector<uint8_t> bytes(size);
+        memory.copyOut(address, bytes.data(), size);
+        return bytes;
+    }
+    Hooks& getHooks() { return hooks; }
+    const Hooks& getHooks() const { return hooks; }
+
+    // 设置初始状态（通常在 reset() 与 loadProgram() 之后）
+    void setReg(uint8_t idx, uint64_t value) {
+        if (idx >= NUM_REGS) throw std::runtime_error("Invalid register: " + std::to_string(idx));
+        regs[idx] = value;
+    }
+    void setPC(uint64_t pc) { PC = pc; }
+    void setStatusReg(const StatusRegister& status) {
+        statusReg = status;
+        flagOp = FlagOp::NONE;
+    }
+    // 把 bytes 写到 address 开始的内存（物理地址），写到代码区时相应的预译码失效；范围越界时抛出异常
+    void writeMemoryRange(uint64_t address, const std::vector<uint8_t>& bytes) {
+        if (address > layout.memSize || bytes.size() > layout.memSize - address) {
+            throw std::runtime_error("Memory write out of bounds: " + std::to_string(address));
+        }
+        if constexpr (Memory::FAULTS_BY_SIGNAL) {
+            if (!memory.accessible(address, bytes.size())) {
+                throw std::runtime_error("Memory write overlaps a guard region: " + std::to_string(address));
+            }
+        }
+        if (bytes.empty()) return;
+        memory.copyIn(address, bytes.data(), bytes.size());
+        invalidateCodeRange(address, bytes.size());
+    }
+
+    // 预译码时是否融合常见指令序列（见 Fusion.h）；带钩子的版本需要逐条观察，始终不融合
+    void setFusion(bool enabled) {
+        fusionEnabled = enabled;
+        invalidateCodeCache();
+    }
 
 private:
-    std::vector<uint8_t> memory;         // 虚拟内存
+    Memory memory;                       // 虚拟内存
+    MemoryLayout layout{};               // 当前内存布局
     std::array<uint64_t, NUM_REGS> regs; // 寄存器文件
     uint64_t PC;                         // 程序计数器
     uint32_t IR;                         // 指令寄存器
-    StatusRegister statusReg;            // 状态寄存器
+    StatusRegister statusReg;            // 状态寄存器（flagOp 为 NONE 时有效）
+    Hooks hooks;
+
+    // 虚拟内存（仅 Config::MMU）
+    uint64_t translationTable = NO_TRANSLATION;     // 第0级页表的物理地址
+    SoftTLB tlb;
+
+    // 变化代数：寄存器的变化在发布时与上次发布的值比较得出
+    uint64_t generation = 0;
+    uint64_t layoutGeneration = 0;
+    std::array<uint64_t, NUM_REGS> publishedRegs{};
+    std::array<uint64_t, NUM_REGS> regGenerations{};
+
+    // ====================== 标志位惰性求值 ======================
+    // ALU只记录最近一次设置标志位的运算与操作数，条件判断或读取状态寄存器时才计算NZCV
+    enum class FlagOp : uint8_t {
+        NONE,               // 标志位已在 statusReg 中
+        ADD32, ADD64,
+        SUB32, SUB64,       // SUB/CMP
+        LOGIC32, LOGIC64    // 逻辑运算与乘除：N/Z取自结果，C=V=0
+    };
+    FlagOp flagOp = FlagOp::NONE;
+    uint64_t flagA = 0;         // 操作数与结果按运算位宽截断
+    uint64_t flagB = 0;
+    uint64_t flagResult = 0;
+
+    template<typename U, bool Sub>
+    uint32_t arithNZCV() const {
+        constexpr U SIGN = U(1) << (sizeof(U) * 8 - 1);
+        U a = static_cast<U>(flagA), b = static_cast<U>(flagB), r = static_cast<U>(flagResult);
+        uint32_t n = (r & SIGN) != 0;
+        uint32_t z = (r == 0);
+        uint32_t c = Sub ? (a >= b) : (r < a);
+        uint32_t v = Sub ? (((a ^ b) & (a ^ r) & SIGN) != 0) : (((a ^ r) & (b ^ r) & SIGN) != 0);
+        return (n << 3) | (z << 2) | (c << 1) | v;
+    }
+
+    // 当前标志位：N<<3 | Z<<2 | C<<1 | V
+    uint32_t nzcv() const {
+        switch (flagOp) {
+            case FlagOp::ADD32:   return arithNZCV<uint32_t, false>();
+            case FlagOp::ADD64:   return arithNZCV<uint64_t, false>();
+            case FlagOp::SUB32:   return arithNZCV<uint32_t, true>();
+            case FlagOp::SUB64:   return arithNZCV<uint64_t, true>();
+            case FlagOp::LOGIC32: return ((flagResult >> 28) & 8) | (static_cast<uint32_t>(flagResult) == 0) << 2;
+            case FlagOp::LOGIC64: return ((flagResult >> 60) & 8) | (flagResult == 0) << 2;
+            default:
+                return (statusReg.N << 3) | (statusReg.Z << 2) | (statusReg.C << 1) | statusReg.V;
+        }
+    }
+
+    // 把待求值的标志位写回 statusReg（JIT代码直接读写 statusReg）
+    void materializeFlags() {
+        if (flagOp != FlagOp::NONE) {
+            statusReg = getStatusReg();
+            flagOp = FlagOp::NONE;
+        }
+    }
+
+    uint64_t runSteps = 0;                           // 最近一次批量执行的指令数
+    uint64_t faultAddress = 0;                       // 最近一次访存错误的地址
+    MemoryAccess faultAccess = MemoryAccess::READ;   // 最近一次访存错误的访问类型
+
+    // 记录访存错误并返回 StopReason::MEMORY_FAULT
+    StopReason memoryFault(MemoryAccess access, uint64_t address) {
+        faultAccess = access;
+        faultAddress = address;
+        return StopReason::MEMORY_FAULT;
+    }
+
+    // ====================== 保护页错误 ======================
+    // 保护页方式下，执行 body 时访问保护区则返回出错指令的 MEMORY_FAULT；其他方式直接执行
+    template<typename Body>
+    StopReason catchGuardFault(Body&& body) {
+        if constexpr (Memory::FAULTS_BY_SIGNAL) {
+            return memory.guard(body, [this] { return guardFault(); });
+        } else {
+            return body();
+        }
+    }
+
+    // 出错时 PC 已越过出错的访存指令，其余状态停在该指令执行前（访存前有信号栅栏）；
+    // 按它的基址寄存器与偏移重新计算地址，得到与边界检查方式相同的错误信息
+    StopReason guardFault() {
+        uint64_t pc = PC - 4;
+        IR = readMemoryUnchecked<uint32_t>(pc);
+        MicroOp u = predecode(IR);
+        uint8_t opcode = u.index & 0x1F;
+        uint64_t base = (u.index & 0x20) ? regs[u.rn] : static_cast<uint32_t>(regs[u.rn]);
+        return memoryFault(isStoreOpcode(opcode) ? MemoryAccess::WRITE : MemoryAccess::READ,
+                           base + static_cast<int64_t>(u.imm));
+    }
+
+    // ====================== 执行引擎 ======================
+    // 就地扣减 remaining；用完时返回 StopReason::STEP_LIMIT
+    template<bool Breakpoint>
+    StopReason interpret(uint64_t& remaining, uint64_t breakpoint);
+    StopReason executeBlocks(uint64_t& remaining);
+    StopReason interpretBlocks(uint64_t& remaining);
+    StopReason executeJit(uint64_t& remaining);
+
+    // ====================== 预译码缓存 ======================
+    using MicroOp = BasicMicroOp<BasicCPU>;
+    static_assert(sizeof(MicroOp) == 16, "MicroOp should stay 16 bytes");
+
+    struct CodePage {
+        bool valid = false;                         // 页内存被写过后置为false，下次取指时重新译码
+        uint32_t generation = 0;                    // 每次重新译码加一，用于判断基本块是否过期
+        std::array<MicroOp, CODE_PAGE_OPS> ops;
+    };
+    std::vector<CodePage*> codeCache;                     // 按4KB页索引，首次执行时分配（JIT代码直接读取此表）
+    std::vector<std::unique_ptr<CodePage>> codePageStorage;
 
+    static const typename MicroOp::Handler HANDLERS[64];      // 按 (sf << 5) | opcode 索引
+    static const std::array<typename MicroOp::Handler, 256> SYSTEM_HANDLERS; // 系统指令，按子操作码索引
+    static const CodePage NO_CODE_PAGE;              // 始终无效的占位页，解释器起步时使用
 
-    // ====================== 取指阶段 ======================
-    void fetch();
+    static MicroOp predecode(uint32_t ir);
+    CodePage& predecodePage(uint64_t pageIndex);
+    void fusePage(CodePage& page);
+    void invalidateCodeCache();
 
-    // ====================== 译码阶段 ======================
-    InstructionFormat decode() const;
+    bool fusionEnabled = !Hooks::ENABLED;
 
-    // ====================== 执行阶段 ======================
-    void execute(const InstructionFormat& instr);
+    // 返回PC处的微操作并给出所在代码页；PC未对齐、不在代码区或不可执行时返回nullptr，由慢速路径处理
+    const MicroOp* lookupMicroOp(uint64_t pc, const CodePage*& page) {
+        if (pc & 3) return nullptr;
+        if (!fetchAddress(pc)) return nullptr;
+        return decodedAt(pc, page);
+    }
+    const MicroOp* lookupMicroOp(uint64_t pc) {
+        const CodePage* page;
+        return lookupMicroOp(pc, page);
+    }
+
+    // 代码区内对齐的物理地址处的微操作，必要时重新译码所在页
+    const MicroOp* decodedAt(uint64_t address, const CodePage*& page) {
+        CodePage* codePage = codeCache[address >> CODE_PAGE_SHIFT];
+        if (codePage == nullptr || !codePage->valid) {
+            codePage = &predecodePage(address >> CODE_PAGE_SHIFT);
+        }
+        page = codePage;
+        return &codePage->ops[(address & (CODE_PAGE_SIZE - 1)) >> 2];
+    }
+
+    // 写内存命中已译码的代码页时使其失效（只置标志位，正在执行的微操作仍然有效）
+    void invalidateCodeRange(uint64_t address, size_t size) {
+        uint64_t first = address >> CODE_PAGE_SHIFT;
+        uint64_t last = (address + size - 1) >> CODE_PAGE_SHIFT;
+        if (last >= codeCache.size()) {     // 代码区之外的写入不影响预译码缓存
+            if (first >= codeCache.size()) return;
+            last = codeCache.size() - 1;
+        }
+        for (uint64_t p = first; p <= last; ++p) {
+            if (CodePage* page = codeCache[p]) page->valid = false;
+        }
+    }
+
+    // ====================== 基本块缓存 ======================
+    static const size_t MAX_BLOCK_OPS = 256;
+    static_assert(FUSED_INDEX_BASE + NUM_FUSIONS < 256, "block end sentinel must fit in MicroOp::index");
+    static constexpr uint8_t BLOCK_END_INDEX = FUSED_INDEX_BASE + NUM_FUSIONS;  // 块尾哨兵的分派索引
+
+    // 一段以分支/HLT结尾（或到达页尾）的顺序指令，不跨越代码页
+    struct BasicBlock {
+        uint64_t start = 0;                 // 首条指令地址
+        uint64_t end = 0;                   // 末条指令之后的地址
+        std::vector<MicroOp> ops;           // 末尾另有一个结束块内执行的哨兵
+        size_t count = 0;                   // 指令条数（不含哨兵）
+        const CodePage* page = nullptr;     // 所在代码页
+        uint32_t generation = 0;            // 构建时代码页的译码版本
+        bool halts = false;                 // 以HLT结尾
+        bool hasStores = false;             // 含存储指令，执行时需检查自修改代码
+        bool chainable = false;             // 以直接分支或顺序执行结尾，后继可以链接
+        bool isCall = false;                // 以BL/BLR结尾，执行后压入返回地址栈
+        bool isReturn = false;              // 以RET结尾，后继由返回地址栈预测
+        BasicBlock* successors[2] = {};     // 已链接的后继块（跳转目标 / 顺序后继；BR/BLR为最近的两个目标）
+        BasicBlock* returnSite = nullptr;   // 调用返回后执行的块（块尾地址处）
+        JitX64::BlockFn jitCode = nullptr;  // 编译后的本地代码
+        uint8_t* jitEntry = nullptr;        // 本地代码中供其他块直接跳入的链接入口
+        uint32_t hotness = 0;               // 解释执行次数，达到阈值后编译
+        bool jitFailed = false;             // 无法编译，始终解释执行
+
+        bool isValid() const { return page->valid && page->generation == generation; }
+    };
+
+    // 按起始地址索引；块对象在 reset() 之前不释放，过期时原地重建，链接指针始终有效
+    std::unordered_map<uint64_t, std::unique_ptr<BasicBlock>> blockCache;
+
+    BasicBlock* lookupBlock(uint64_t pc);
+    bool buildBlock(BasicBlock& block, uint64_t pc);
+    BasicBlock* nextBlock(BasicBlock* block);
+
+    // 已链接且仍有效的后继块；调用、返回与未命中时返回nullptr，由 nextBlock() 处理
+    BasicBlock* linkedSuccessor(const BasicBlock* block) const {
+        if (block->isCall || block->isReturn) return nullptr;
+        for (BasicBlock* succ : block->successors) {
+            if (succ != nullptr && succ->start == PC && succ->isValid()) return succ;
+        }
+        return nullptr;
+    }
+
+    // 返回地址栈：环形，溢出时覆盖最旧的项；预测错误只导致一次查表
+    static const uint32_t RETURN_STACK_SIZE = 16;
+    struct ReturnEntry {
+        uint64_t address;       // 返回地址
+        BasicBlock* block;      // 该地址处的块
+    };
+    std::array<ReturnEntry, RETURN_STACK_SIZE> returnStack{};
+    uint32_t returnTop = 0;     // 下一次压入的位置
+    uint32_t returnDepth = 0;   // 有效项数
+
+    void pushReturn(BasicBlock* block);
+    BasicBlock* popReturn(uint64_t pc);
 
-    // ====================== 指令执行 ======================
-    void executeDataProcessing(const InstructionFormat& instr);
-    void executeLoadStore(const InstructionFormat& instr);
-    void executeBranch(const InstructionFormat& instr);
-    void executeCompare(const InstructionFormat& instr);
-    void executeMove(const InstructionFormat& instr);
-    void executeMultiplyDivide(const InstructionFormat& instr);
-    void executeSystem(const InstructionFormat& instr);
+    // ====================== JIT ======================
+    static const uint32_t JIT_THRESHOLD = 8;    // 基本块执行多少次后编译
+    std::unique_ptr<JitX64> jit;
+    friend class JitX64;
+    template<typename, typename> friend class BasicSMP;
+    friend class SimtEngine;
 
-    // ====================== 数据转换 ======================
-    ALUOp convertToALUOp(DataProcOp op) const;
-    DataProcOp convertToDataProcOp(uint8_t opcode) const;
-    MemoryOp convertToMemoryOp(uint8_t opcode) const;
-    SystemOp convertToSystemOp(uint8_t opcode) const;
+    void flushJit();
+
+    // 本地代码访存的基址；只有连续内存会被编译执行
+    uint8_t* jitMemoryBase() {
+        if constexpr (Memory::CONTIGUOUS) return memory.data();
+        else return nullptr;
+    }
+    const DirtyMap* jitDirtyMap() const {
+        if constexpr (std::is_same_v<Memory, FlatMemory>) return &memory.dirtyMap();
+        else return nullptr;
+    }
+
+    // ====================== 微操作执行函数 ======================
+    template<ALUOp Op, bool Is64, bool Imm> static StopReason uopALU(BasicCPU& cpu, const MicroOp& u);
+    template<bool Is64> static StopReason uopMov(BasicCPU& cpu, const MicroOp& u);
+    template<bool Is64> static StopReason uopMovImm(BasicCPU& cpu, const MicroOp& u);
+    template<typename T, bool Is64> static StopReason uopLoad(BasicCPU& cpu, const MicroOp& u);
+    template<typename T, bool Is64> static StopReason uopStore(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopB(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopBCond(BasicCPU& cpu, const MicroOp& u);
+    template<bool Is64> static StopReason uopBCondAfterCmp(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopBL(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopBLR(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopBR(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopRet(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopSystem(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopHlt(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopNop(BasicCPU& cpu, const MicroOp& u);
+    template<MopsStage Stage> static StopReason uopCpy(BasicCPU& cpu, const MicroOp& u);
+    template<MopsStage Stage> static StopReason uopSet(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopLdxr(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopStxr(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopLdadd(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopCas(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopDmb(BasicCPU& cpu, const MicroOp& u);
+    static StopReason uopMrs(BasicCPU& cpu, const MicroOp& u);
+
+    // ====================== 批量内存指令 ======================
+    // CPYM/SETM 每次执行至多处理的字节数；未完成时PC退回该指令，步数预算、断点与钩子都能在段间生效
+    static constexpr uint64_t MOPS_CHUNK = 64 * 1024;
+    StopReason bulkCopy(MopsStage stage, uint8_t rd, uint8_t rs, uint8_t rn);
+    StopReason bulkSet(MopsStage stage, uint8_t rd, uint8_t rn, uint8_t rs);
+
+    // 本次可以处理的字节数：不超过剩余数与 MOPS_CHUNK，MMU 方式下 to 与 from 开始的区间都不跨页
+    static uint64_t bulkChunk(uint64_t remaining, uint64_t to, uint64_t from) {
+        uint64_t n = std::min(remaining, MOPS_CHUNK);
+        if constexpr (Config::MMU) {
+            n = std::min(n, GUEST_PAGE_SIZE - (to & (GUEST_PAGE_SIZE - 1)));
+            n = std::min(n, GUEST_PAGE_SIZE - (from & (GUEST_PAGE_SIZE - 1)));
+        }
+        return n;
+    }
+
+    // 批量访问的区间 [address, address + size) 是否可以访问；MMU 方式下转换为物理地址（调用者保证不跨页）。
+    // WRAP 方式不取模，越界同样报告错误
+    template<MemoryAccess A>
+    bool bulkAddress(uint64_t& address, uint64_t size) {
+        if constexpr (Config::MMU) {
+            return translateSlow(A, address, size);
+        } else if constexpr (Memory::FAULTS_BY_SIGNAL) {
+            return memory.accessible(address, size);
+        } else {
+            return size <= layout.memSize && address <= layout.memSize - size;
+        }
+    }
+
+    // ====================== 多核同步指令 ======================
+    // 独占监视器：LDXR 记录地址与读到的值，STXR 仅在地址相同且内存仍为该值时写入（以比较交换实现，
+    // 其间被改写后又改回原值的情况视为未改写）；STXR 之后、复位与派生时清除
+    static constexpr uint64_t NO_EXCLUSIVE = ~0ULL;
+    uint64_t exclusiveAddress = NO_EXCLUSIVE;   // 物理地址
+    uint64_t exclusiveValue = 0;
+    uint8_t exclusiveSize = 0;
+    uint32_t coreId = 0;                        // MPIDR_EL1，见 SMP.h
+
+    template<typename T> StopReason exclusiveLoad(uint8_t rt, uint8_t rn);
+    template<typename T> StopReason exclusiveStore(uint8_t rs, uint8_t rt, uint8_t rn);
+    template<typename T> StopReason atomicAdd(uint8_t rs, uint8_t rt, uint8_t rn);
+    template<typename T> StopReason compareAndSwap(uint8_t rs, uint8_t rt, uint8_t rn);
+
+    // 原子访问须按大小对齐（否则按访存错误处理），总是检查边界；MMU 方式下转换为物理地址
+    template<typename T, MemoryAccess A>
+    bool atomicAddress(uint64_t& address) {
+        return (address & (sizeof(T) - 1)) == 0 && bulkAddress<A>(address, sizeof(T));
+    }
+    // 可被多个核共享的内存使用宿主机原子指令，其他内存只有一个核访问
+    template<typename T>
+    T atomicRead(uint64_t address) {
+        if constexpr (Memory::SHAREABLE) return memory.template atomicLoad<T>(address);
+        else return memory.template read<T>(address);
+    }
+    template<typename T>
+    bool atomicCompareExchange(uint64_t address, T& expected, T desired) {
+        bool stored;
+        if constexpr (Memory::SHAREABLE) {
+            stored = memory.template compareExchange<T>(address, expected, desired);
+        } else {
+            T current = memory.template read<T>(address);
+            stored = current == expected;
+            if (stored) memory.template write<T>(address, desired);
+            else expected = current;
+        }
+        if (stored) invalidateCodeRange(address, sizeof(T));
+        return stored;
+    }
+    template<typename T>
+    T atomicFetchAdd(uint64_t address, T value) {
+        T old;
+        if constexpr (Memory::SHAREABLE) {
+            old = memory.template fetchAdd<T>(address, value);
+        } else {
+            old = memory.template read<T>(address);
+            memory.template write<T>(address, static_cast<T>(old + value));
+        }
+        invalidateCodeRange(address, sizeof(T));
+        return old;
+    }
 
     // ====================== ALU操作 ======================
-    void aluOperation(ALUOp op, uint8_t rd, uint64_t a, uint64_t b, bool is32bit = false);
+    // 操作与位宽在编译期确定的ALU实现；除数为0由调用者预先检查
+    template<ALUOp Op, bool Is64>
+    void aluExec(uint8_t rd, uint64_t a, uint64_t b) {
+        using S = std::conditional_t<Is64, int64_t, int32_t>;
+        using U = std::make_unsigned_t<S>;
+        S sa = static_cast<S>(a);
+        S sb = static_cast<S>(b);
+        S result = 0;
+
+        if constexpr (Op == ALUOp::ADD) {
+            result = static_cast<S>(static_cast<U>(sa) + static_cast<U>(sb));
+        } else if constexpr (Op == ALUOp::SUB || Op == ALUOp::CMP) {
+            result = static_cast<S>(static_cast<U>(sa) - static_cast<U>(sb));
+        } else if constexpr (Op == ALUOp::MUL) {
+            result = static_cast<S>(static_cast<U>(sa) * static_cast<U>(sb));
+        } else if constexpr (Op == ALUOp::SDIV) {
+            // INT_MIN / -1 在宿主机上会触发异常，按AArch64语义结果为INT_MIN
+            result = (sb == -1) ? static_cast<S>(U(0) - static_cast<U>(sa)) : sa / sb;
+        } else if constexpr (Op == ALUOp::UDIV) {
+            result = static_cast<S>(static_cast<U>(sa) / static_cast<U>(sb));
+        } else if constexpr (Op == ALUOp::AND) {
+            result = sa & sb;
+        } else if constexpr (Op == ALUOp::ORR) {
+            result = sa | sb;
+        } else if constexpr (Op == ALUOp::EOR) {
+            result = sa ^ sb;
+        } else {
+            static_assert(Op == ALUOp::ADD, "Unsupported ALU operation");
+        }
+
+        // 标志位留待使用时计算
+        if constexpr (Op == ALUOp::ADD || Op == ALUOp::SUB || Op == ALUOp::CMP) {
+            flagOp = (Op == ALUOp::ADD) ? (Is64 ? FlagOp::ADD64 : FlagOp::ADD32)
+                                        : (Is64 ? FlagOp::SUB64 : FlagOp::SUB32);
+            flagA = static_cast<U>(sa);
+            flagB = static_cast<U>(sb);
+        } else {
+            flagOp = Is64 ? FlagOp::LOGIC64 : FlagOp::LOGIC32;
+        }
+        flagResult = static_cast<U>(result);
+
+        // CMP只更新标志位
+        if constexpr (Op != ALUOp::CMP) {
+            regs[rd] = static_cast<uint64_t>(static_cast<U>(result));
+        }
+    }
 
     // ====================== 条件检查 ======================
-    bool checkCondition(BranchCondition condition) const;
+    bool checkCondition(BranchCondition condition) const {
+        return (CONDITION_TABLE[static_cast<uint32_t>(condition) & 0xF] >> nzcv()) & 1;
+    }
+    // 条件成立的NZCV组合位掩码：第 (N<<3|Z<<2|C<<1|V) 位为1表示成立
+    static uint16_t conditionMask(BranchCondition condition) {
+        return CONDITION_TABLE[static_cast<uint32_t>(condition) & 0xF];
+    }
 
     // ====================== 寄存器操作 ======================
-    inline uint64_t getXReg(uint8_t reg) const;
-    inline void     setXReg(uint8_t reg, uint64_t value);
-    inline uint32_t getWReg(uint8_t reg) const;
-    inline void     setWReg(uint8_t reg, uint32_t value);
-    inline uint64_t getRegisterValue(const Register& reg);
-    inline void     setRegisterValue(const Register& reg, uint64_t value);
+    // 微操作使用的无检查寄存器访问，寄存器编号在预译码时已限定为5位
+    template<bool Is64>
+    uint64_t readReg(uint8_t reg) const {
+        return Is64 ? regs[reg] : static_cast<uint32_t>(regs[reg]);
+    }
+    template<bool Is64>
+    void writeReg(uint8_t reg, uint64_t value) {
+        regs[reg] = Is64 ? value : static_cast<uint32_t>(value);
+    }
+
+    // ====================== 地址转换 ======================
+    // TLB命中且访问按大小对齐时只比较一次；其余情况由 translateSlow() 遍历页表。失败时 address 不变
+    template<MemoryAccess A>
+    bool translate(uint64_t& address, size_t size) {
+        const SoftTLB::Entry& entry = tlb.entryFor(address);
+        if ((address & (~(GUEST_PAGE_SIZE - 1) | (size - 1))) == entry.tags[static_cast<int>(A)]) {
+            ++tlb.hits;
+            address += entry.offset;
+            return true;
+        }
+        return translateSlow(A, address, size);
+    }
+    bool translateSlow(MemoryAccess access, uint64_t& address, size_t size);
+    bool translatePage(MemoryAccess access, uint64_t& address);
+    bool refillTlb(SoftTLB::Entry& entry, uint64_t page);
+
+    // 取指地址：转换为物理地址（无MMU时不变）；不可执行或不在代码区时返回false
+    bool fetchAddress(uint64_t& address) {
+        if constexpr (Config::MMU) {
+            return translate<MemoryAccess::FETCH>(address, 4);
+        } else {
+            return address <= layout.codeSize - 4;
+        }
+    }
 
     // ====================== 内存访问 ======================
+    // 按边界检查策略（或经MMU转换）处理数据访问地址；越界或无权访问时返回false
+    template<typename T, MemoryAccess A>
+    bool dataAddress(uint64_t& address) {
+        if constexpr (Config::MMU) {
+            return translate<A>(address, sizeof(T));
+        } else if constexpr (Memory::FAULTS_BY_SIGNAL) {   // 由保护页捕获
+            return true;
+        } else if constexpr (Config::BOUNDS == BoundsCheck::WRAP) {
+            address &= layout.memSize - 1;
+            return true;
+        } else {
+            return address <= layout.memSize - sizeof(T);
+        }
+    }
+
     template<typename T>
     T readMemory(uint64_t address) const {
         constexpr size_t size = sizeof(T);
-        if (address + size > MEM_SIZE) {
+        if (address > layout.memSize - size) {
             throw std::runtime_error("Memory read out of bounds: " + std::to_string(address));
         }
-        T value = 0;
-        for (size_t i = 0; i < size; ++i) {
-            value |= static_cast<uint32_t>(memory[address + i]) << (i * 8);
-        }
-        return value;
+        return readMemoryUnchecked<T>(address);
     }
 
     template<typename T>
     void writeMemory(uint64_t address, T value) {
         constexpr size_t size = sizeof(T);
-        if (address + size > MEM_SIZE) {
+        if (address > layout.memSize - size) {
             throw std::runtime_error("Memory write out of bounds: " + std::to_string(address));
         }
-        for (size_t i = 0; i < size; ++i) {
-            memory[address + i] = (value >> (i * 8)) & 0xFF;
-        }
+        writeMemoryUnchecked<T>(address, value);
+    }
+
+    // 调用者已完成边界检查
+    template<typename T>
+    T readMemoryUnchecked(uint64_t address) const {
+        return memory.template read<T>(address);
+    }
+
+    template<typename T>
+    void writeMemoryUnchecked(uint64_t address, T value) {
+        memory.template write<T>(address, value);
+        invalidateCodeRange(address, sizeof(T));
     }
 };
+
+#ifdef TINY_HAS_GUARDED_MEMORY
+#define TINY_GUARDED_CONFIGS(X) X(GuardedConfig, NoHooks)
+#else
+#define TINY_GUARDED_CONFIGS(X)
+#endif
+
+// 已发布的配置组合，各 .cpp 中的成员定义按此列表显式实例化
+#define TINY_CPU_CONFIGS(X) \
+    X(DefaultConfig, NoHooks) \
+    X(DefaultConfig, ProfileHooks) \
+    X(UncheckedConfig, NoHooks) \
+    X(SparseConfig, NoHooks) \
+    X(VirtualConfig, NoHooks) \
+    TINY_GUARDED_CONFIGS(X)
+
+// 最高速版本；以 TINY_PROFILE 构建时换成统计指令/访存/分支的版本
+#ifdef TINY_PROFILE
+using CPU = BasicCPU<DefaultConfig, ProfileHooks>;
+#else
+using CPU = BasicCPU<DefaultConfig, NoHooks>;
+#endif
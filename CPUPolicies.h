@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#include "Enums.h"
+
+// ========================== CPU 编译期策略 ==========================
+// BasicCPU<Config, Hooks> 的两个模板参数：
+//   Config 决定默认内存布局、存储方式、数据访问的边界检查方式以及是否经软件MMU转换地址
+//   Hooks  在每条指令、每次数据访存、每次分支时被调用；空实现的钩子内联后被完全消除
+// 同一份源码由不同的参数组合得到最高速版本与带统计的版本，运行时没有额外分支
+
+// 数据访问越界时的处理方式
+enum class BoundsCheck : uint8_t {
+    FAULT,  // 检查边界，越界时以 MEMORY_FAULT 停止
+    WRAP    // 地址对内存大小取模，不做比较；跨越末尾的访问落在内存后的填充字节上
+};
+
+// 客户机内存的存储方式（见 GuestMemory.h）
+enum class MemoryModel : uint8_t {
+    FLAT,   // 整块连续分配 memSize 字节
+    PAGED,  // 稀疏页表，首次写入时按4KB页分配；JIT需要连续内存，不被使用
+    GUARDED // mmap保留并设置保护区，访存不比较边界，越界由信号报告；只有线程化解释器能精确恢复，基本块与JIT执行都退回到它
+};
+
+// 大区域内存是否使用宿主机的2MB大页（只影响连续内存）
+enum class HugePages : uint8_t {
+    OFF,
+    AUTO,       // 2MB及以上的区域按2MB对齐并请求透明大页（madvise(MADV_HUGEPAGE)）
+    EXPLICIT    // 先尝试 MAP_HUGETLB 预留的大页，失败时同 AUTO
+};
+
+// 内存布局，可在运行时通过 BasicCPU::setMemoryLayout() 更换
+struct MemoryLayout {
+    uint64_t memSize;       // 地址空间大小
+    uint64_t codeSize;      // 可取指的低端区域 [0, codeSize)，预译码缓存按它分配；其上为数据区
+    uint64_t stackBase;     // 栈顶（SP的初值）
+    uint64_t stackLimit;    // 栈可增长到的最低地址
+    uint64_t stackGuard;    // stackLimit 之下的保护区大小（仅保护页内存）
+    HugePages hugePages;
+};
+
+// ====================== 配置 ======================
+// LAYOUT 为默认内存布局；MMU 为 true 时取指与访存使用虚拟地址（见 SoftMMU.h）
+
+struct DefaultConfig {
+    static constexpr MemoryLayout LAYOUT = {0x100000, 0x100000, 0x100000, 0x000800, 0, HugePages::AUTO};   // 1MB内存
+    static constexpr MemoryModel MEMORY = MemoryModel::FLAT;
+    static constexpr BoundsCheck BOUNDS = BoundsCheck::FAULT;
+    static constexpr bool MMU = false;
+};
+
+// 只运行可信程序时使用：访存不比较边界
+struct UncheckedConfig {
+    static constexpr MemoryLayout LAYOUT = {0x100000, 0x100000, 0x100000, 0x000800, 0, HugePages::AUTO};
+    static constexpr MemoryModel MEMORY = MemoryModel::FLAT;
+    static constexpr BoundsCheck BOUNDS = BoundsCheck::WRAP;
+    static constexpr bool MMU = false;
+};
+
+// 48位稀疏地址空间：只为写过的页分配内存，栈位于地址空间顶端；代码只能位于低16MB
+struct SparseConfig {
+    static constexpr MemoryLayout LAYOUT = {1ULL << 48, 0x1000000, 1ULL << 48, 0x000800, 0, HugePages::OFF};
+    static constexpr MemoryModel MEMORY = MemoryModel::PAGED;
+    static constexpr BoundsCheck BOUNDS = BoundsCheck::FAULT;
+    static constexpr bool MMU = false;
+};
+
+// 1MB内存，栈占顶端128KB，其下64KB为保护区：栈溢出与越界访问由保护页捕获，访存不做比较
+// 代码只能位于保护区之下
+struct GuardedConfig {
+    static constexpr MemoryLayout LAYOUT = {0x100000, 0x0D0000, 0x100000, 0x0E0000, 0x010000, HugePages::AUTO};
+    static constexpr MemoryModel MEMORY = MemoryModel::GUARDED;
+    static constexpr BoundsCheck BOUNDS = BoundsCheck::FAULT;
+    static constexpr bool MMU = false;
+};
+
+// 1MB物理内存，由客户机页表映射到48位虚拟地址空间，按页检查读/写/执行权限；未设置页表时为恒等映射
+// 地址转换只在线程化解释器中进行，基本块与JIT执行都退回到它
+struct VirtualConfig {
+    static constexpr MemoryLayout LAYOUT = {0x100000, 0x100000, 0x100000, 0x000800, 0, HugePages::AUTO};
+    static constexpr MemoryModel MEMORY = MemoryModel::FLAT;
+    static constexpr BoundsCheck BOUNDS = BoundsCheck::FAULT;
+    static constexpr bool MMU = true;
+};
+
+// ====================== 钩子 ======================
+// ENABLED 为 false 时钩子不得有可观察的作用；为 true 时需要逐条观察，JIT不会被使用
+
+struct NoHooks {
+    static constexpr bool ENABLED = false;
+
+    void onInstruction(uint64_t /*pc*/, uint8_t /*index*/) {}
+    void onMemoryAccess(MemoryAccess /*access*/, uint64_t /*address*/, uint8_t /*size*/) {}
+    void onBranch(uint64_t /*from*/, uint64_t /*to*/, bool /*taken*/) {}
+};
+
+// 统计指令、访存与分支次数，以及顺序执行的指令序列（n-gram）出现的次数
+// 统计在 reset() 之间累积：依次运行一组程序即可得到整个工作负载的热点序列，据此挑选 Fusion.h 中的融合序列
+struct ProfileHooks {
+    static constexpr bool ENABLED = true;
+
+    uint64_t instructions = 0;
+    std::array<uint64_t, 64> opcodeCounts{};    // 按 (sf << 5) | opcode 索引
+    uint64_t loads = 0;
+    uint64_t stores = 0;
+    uint64_t branches = 0;
+    uint64_t takenBranches = 0;
+    std::vector<uint64_t> bigrams = std::vector<uint64_t>(64 * 64);    // 前一条索引 * 64 + 本条索引
+    std::unordered_map<uint32_t, uint64_t> trigrams;                    // 三条索引各占6位
+
+    void onInstruction(uint64_t pc, uint8_t index) {
+        index &= 0x3F;
+        ++instructions;
+        ++opcodeCounts[index];
+
+        // 只统计顺序相邻的指令：跳转前后的两条不能融合
+        if (pc == lastPC + 4) {
+            ++bigrams[prev1 * 64 + index];
+            if (sequential) ++trigrams[(prev2 << 12) | (prev1 << 6) | index];
+            sequential = true;
+        } else {
+            sequential = false;
+        }
+        prev2 = prev1;
+        prev1 = index;
+        lastPC = pc;
+    }
+    void onMemoryAccess(MemoryAccess access, uint64_t /*address*/, uint8_t /*size*/) {
+        if (access == MemoryAccess::WRITE) ++stores;
+        else ++loads;
+    }
+    void onBranch(uint64_t /*from*/, uint64_t /*to*/, bool taken) {
+        ++branches;
+        takenBranches += taken;
+    }
+
+    void reset() { *this = ProfileHooks{}; }
+
+    static std::string indexName(uint32_t index) {
+        return std::string(index & 0x20 ? "X " : "W ") + ISA_INFO[index & 0x1F].name;
+    }
+
+    // 出现次数最多的 top 个二元与三元序列
+    void printNGrams(std::ostream& os, size_t top = 10) const {
+        std::vector<std::pair<uint64_t, uint32_t>> sorted;
+        for (uint32_t i = 0; i < bigrams.size(); ++i) {
+            if (bigrams[i] != 0) sorted.push_back({bigrams[i], i});
+        }
+        std::sort(sorted.rbegin(), sorted.rend());
+        os << "bigrams:\n";
+        for (size_t i = 0; i < sorted.size() && i < top; ++i) {
+            uint32_t key = sorted[i].second;
+            os << "  " << indexName(key >> 6) << " + " << indexName(key & 0x3F) << ": " << sorted[i].first << "\n";
+        }
+
+        sorted.clear();
+        for (const auto& [key, count] : trigrams) sorted.push_back({count, key});
+        std::sort(sorted.rbegin(), sorted.rend());
+        os << "trigrams:\n";
+        for (size_t i = 0; i < sorted.size() && i < top; ++i) {
+            uint32_t key = sorted[i].second;
+            os << "  " << indexName(key >> 12) << " + " << indexName((key >> 6) & 0x3F) << " + "
+               << indexName(key & 0x3F) << ": " << sorted[i].first << "\n";
+        }
+    }
+
+    void print(std::ostream& os) const {
+        os << "instructions: " << instructions << "\n"
+           << "loads: " << loads << ", stores: " << stores << "\n"
+           << "branches: " << branches << ", taken: " << takenBranches << "\n";
+        for (size_t i = 0; i < opcodeCounts.size(); ++i) {
+            if (opcodeCounts[i] == 0) continue;
+            os << "  " << indexName(static_cast<uint32_t>(i)) << ": " << opcodeCounts[i] << "\n";
+        }
+    }
+
+private:
+    uint64_t lastPC = ~0ULL - 7;    // 上一条指令的地址；初值使 lastPC + 4 不是可执行的地址
+    uint32_t prev1 = 0;             // 上一条与上上条的分派索引
+    uint32_t prev2 = 0;
+    bool sequential = false;        // 上一条与上上条是否顺序相邻
+};
@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+
+// ========================== 批量复制测试 ==========================
+// CPYP/CPYM/CPYE 复制源与目的重叠的区间，两个方向各一次：
+//   目的在源之下：从低地址向高地址复制
+//   目的在源之上：CPYP 改为从高地址向低地址复制（Xn 取负）
+// 区间大于一段（64KB），VirtualConfig 下还按页分段。每种执行方式先以整个预算执行，再以1~3步的小预算
+// 反复执行直到HLT，使执行停在各段之间后继续；结果须与 memmove 相同，三个寄存器停在区间末尾与0。
+// 每个配置（TINY_CPU_CONFIGS）各测一遍，全部通过时返回0
+
+namespace {
+
+const uint64_t MAX_STEPS = 1000000;
+const uint64_t REGION = 0x20000;    // 复制所在的区间 [REGION, REGION + REGION_SIZE)
+const uint64_t REGION_SIZE = 0x30000;
+const uint64_t COPY_SIZE = 0x28000;     // 三段
+const uint64_t SHIFT = 0x1234;      // 源与目的的距离，不按页对齐
+
+const char* const PROGRAM = R"(
+        cpyp    [x1]!, [x4]!, x2!
+        cpym    [x1]!, [x4]!, x2!
+        cpye    [x1]!, [x4]!, x2!
+        HLT
+    )";
+
+struct Direction {
+    const char* name;
+    uint64_t dst;
+    uint64_t src;
+};
+
+const Direction DIRECTIONS[] = {
+    {"forward (destination below source)", REGION, REGION + SHIFT},
+    {"backward (destination above source)", REGION + SHIFT, REGION},
+};
+
+const uint64_t BUDGETS[] = {MAX_STEPS, 1, 2, 3};
+
+std::vector<uint32_t> assembleQuietly(const std::string& text) {
+    Assembler assembler;
+    assembler.setVerbose(false);
+    return assembler.assemble(text);
+}
+
+template<typename Config, typename Hooks>
+int testConfig(const char* name) {
+    using Core = BasicCPU<Config, Hooks>;
+    struct Engine {
+        const char* name;
+        StopReason (Core::*run)(uint64_t);
+    };
+    const Engine engines[] = {{"run", &Core::run}, {"runBlocks", &Core::runBlocks}, {"runJit", &Core::runJit}};
+    const std::vector<uint32_t> program = assembleQuietly(PROGRAM);
+
+    // 填充内容由偏移计算，错位的复制不会碰巧相同
+    std::vector<uint8_t> initial(REGION_SIZE);
+    for (size_t i = 0; i < initial.size(); ++i) initial[i] = static_cast<uint8_t>((i * 7) ^ (i >> 8));
+
+    auto instance = std::make_unique<Core>();
+    Core& cpu = *instance;
+    int failures = 0;
+    for (const Direction& d : DIRECTIONS) {
+        std::vector<uint8_t> expected = initial;
+        std::memmove(expected.data() + (d.dst - REGION), expected.data() + (d.src - REGION), COPY_SIZE);
+
+        for (const Engine& engine : engines) {
+            uint64_t fullSteps = 0;     // 整个预算执行时的步数
+            for (uint64_t budget : BUDGETS) {
+                cpu.reset();
+                cpu.loadProgram(program);
+                cpu.writeMemoryRange(REGION, initial);
+                cpu.setReg(1, d.dst);
+                cpu.setReg(4, d.src);
+                cpu.setReg(2, COPY_SIZE);
+
+                StopReason reason = StopReason::STEP_LIMIT;
+                uint64_t calls = 0, steps = 0;
+                while (reason == StopReason::STEP_LIMIT && steps < MAX_STEPS) {
+                    reason = (cpu.*engine.run)(budget);
+                    steps += cpu.getRunSteps();
+                    ++calls;
+                }
+                if (budget == MAX_STEPS) fullSteps = steps;
+
+                const bool backward = d.dst > d.src;
+                const bool ok = reason == StopReason::HALT &&
+                                cpu.readMemoryRange(REGION, REGION_SIZE) == expected &&
+                                cpu.getReg(1) == (backward ? d.dst : d.dst + COPY_SIZE) &&
+                                cpu.getReg(4) == (backward ? d.src : d.src + COPY_SIZE) &&
+                                cpu.getReg(2) == 0 &&
+                                steps == fullSteps &&
+                                calls == (fullSteps + budget - 1) / budget;    // 每次都用完预算，停在各段之间
+                if (!ok) {
+                    if (failures < 10) {
+                        printf("  %s %s %s budget %llu: %s after %llu calls\n", name, d.name, engine.name,
+                               static_cast<unsigned long long>(budget), cpu.describeStop(reason).c_str(),
+                               static_cast<unsigned long long>(calls));
+                    }
+                    ++failures;
+                }
+            }
+        }
+    }
+    printf("%-24s %d failures\n", name, failures);
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+#define TEST_CONFIG(CONFIG, HOOKS) failures += testConfig<CONFIG, HOOKS>(#CONFIG "/" #HOOKS);
+    TINY_CPU_CONFIGS(TEST_CONFIG)
+#undef TEST_CONFIG
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
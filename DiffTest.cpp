@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+
+// ========================== 差分测试 ==========================
+// 以逐条 step() 为基准，比较 run() / runBlocks() / runJit() 执行同一程序后的状态：
+// 每次停止的原因与位置、执行的指令数、PC、IR、NZCV、寄存器与低端内存。
+// 停止（HLT或出错）后继续执行，直到用完步数或停止 MAX_STOPS 次；每种执行方式分别以整个预算与小预算分多次执行。
+// 程序包括几个固定用例与随机生成的程序（含分支到越界/未对齐地址、BLR X30、改写自身代码的存储、
+// 批量复制/填充与多核同步指令）。
+// 所有配置（TINY_CPU_CONFIGS）全部一致时返回0
+
+namespace {
+
+const uint64_t MAX_STEPS = 4000;
+const size_t MAX_STOPS = 32;
+const size_t MEMORY_WINDOW = 0x8000;    // 程序与数据都在这里（imm16 为有符号数）
+const int RANDOM_PROGRAMS = 200;
+
+const uint32_t HLT = uint32_t(OP_SYS) << 26;
+
+uint32_t encode(bool sf, uint8_t opcode, uint8_t rd, uint8_t rn, uint32_t low) {
+    return (uint32_t(sf) << 31) | (uint32_t(opcode) << 26) | (uint32_t(rd) << 21) | (uint32_t(rn) << 16) | (low & 0xFFFF);
+}
+
+// 分支偏移以指令计，相对下一条指令
+uint32_t branch(uint8_t opcode, size_t from, size_t to) {
+    return encode(false, opcode, 0, 0, static_cast<uint32_t>(static_cast<int32_t>(to) - static_cast<int32_t>(from) - 1));
+}
+
+uint32_t branchCond(BranchCondition cond, size_t from, size_t to) {
+    return branch(OP_B_COND, from, to) | (uint32_t(cond) << 22);
+}
+
+// 系统指令：子操作码位于 [15:8]，第三个寄存器位于 [4:0]
+uint32_t systemInstr(bool sf, uint8_t subop, uint8_t r1, uint8_t r2, uint8_t r3) {
+    return encode(sf, OP_SYS, r1, r2, (uint32_t(subop) << 8) | r3);
+}
+
+// ====================== 执行与比较 ======================
+
+struct MachineState {
+    std::vector<std::string> stops;     // 每次停止：原因与当时的指令数
+    uint64_t steps = 0;
+    uint64_t pc = 0;
+    uint32_t ir = 0;
+    std::string nzcv;
+    std::array<uint64_t, 32> regs{};
+    std::vector<uint8_t> memory;
+
+    bool operator==(const MachineState& o) const {
+        return stops == o.stops && steps == o.steps && pc == o.pc && ir == o.ir && nzcv == o.nzcv && regs == o.regs && memory == o.memory;
+    }
+};
+
+template<typename Core>
+void capture(const Core& cpu, MachineState& s) {
+    s.pc = cpu.getPC();
+    s.ir = static_cast<uint32_t>(cpu.getIR());
+    s.nzcv = cpu.getStatusReg().toString();
+    for (uint8_t i = 0; i < 32; ++i) s.regs[i] = cpu.getReg(i);
+    s.memory = cpu.readMemoryRange(0, MEMORY_WINDOW);
+}
+
+template<typename Core>
+MachineState runReference(Core& cpu, const std::vector<uint32_t>& program) {
+    MachineState s;
+    cpu.reset();
+    cpu.loadProgram(program);
+    while (s.steps < MAX_STEPS && s.stops.size() < MAX_STOPS) {
+        ++s.steps;
+        try {
+            cpu.step();
+        } catch (const std::exception& e) {
+            s.stops.push_back(std::string(e.what()) + " @" + std::to_string(s.steps));
+        }
+    }
+    capture(cpu, s);
+    return s;
+}
+
+template<typename Core>
+MachineState runEngine(Core& cpu, const std::vector<uint32_t>& program, StopReason (Core::*engine)(uint64_t), uint64_t chunk) {
+    MachineState s;
+    cpu.reset();
+    cpu.loadProgram(program);
+    while (s.steps < MAX_STEPS && s.stops.size() < MAX_STOPS) {
+        StopReason reason = (cpu.*engine)(std::min(chunk, MAX_STEPS - s.steps));
+        s.steps += cpu.getRunSteps();
+        if (reason != StopReason::STEP_LIMIT) {
+            s.stops.push_back(cpu.describeStop(reason) + " @" + std::to_string(s.steps));
+        }
+    }
+    capture(cpu, s);
+    return s;
+}
+
+void report(const char* config, const std::string& program, const char* engine, uint64_t chunk,
+            const MachineState& expected, const MachineState& actual) {
+    printf("MISMATCH %s %s %s(chunk %llu)\n", config, program.c_str(), engine, static_cast<unsigned long long>(chunk));
+    printf("  steps %llu / %llu, pc %llx / %llx, ir %08x / %08x, nzcv %s / %s\n",
+           static_cast<unsigned long long>(expected.steps), static_cast<unsigned long long>(actual.steps),
+           static_cast<unsigned long long>(expected.pc), static_cast<unsigned long long>(actual.pc),
+           expected.ir, actual.ir, expected.nzcv.c_str(), actual.nzcv.c_str());
+    for (size_t i = 0; i < std::max(expected.stops.size(), actual.stops.size()); ++i) {
+        const std::string a = i < expected.stops.size() ? expected.stops[i] : "-";
+        const std::string b = i < actual.stops.size() ? actual.stops[i] : "-";
+        if (a != b) {
+            printf("  stop %zu: %s / %s\n", i, a.c_str(), b.c_str());
+            break;
+        }
+    }
+    for (int i = 0; i < 32; ++i) {
+        if (expected.regs[i] != actual.regs[i]) {
+            printf("  x%d %llx / %llx\n", i, static_cast<unsigned long long>(expected.regs[i]), static_cast<unsigned long long>(actual.regs[i]));
+        }
+    }
+    if (expected.memory != actual.memory) printf("  memory differs\n");
+}
+
+// ====================== 测试程序 ======================
+
+struct TestProgram {
+    std::string name;
+    std::vector<uint32_t> code;
+};
+
+// 分支到越界地址：第二次执行（停止后继续）时同样报告取指错误
+std::vector<uint32_t> branchOutOfBounds() {
+    return {
+        encode(true, OP_MOVI, 1, 0, 0xFFFC),    // mov x1, #-4
+        encode(true, OP_BR, 1, 0, 0),           // br x1
+    };
+}
+
+// 分支到未对齐地址与程序之后的空白内存
+std::vector<uint32_t> branchMisaligned() {
+    return {
+        encode(true, OP_MOVI, 1, 0, 0x0102),    // mov x1, #0x102
+        encode(true, OP_BLR, 1, 0, 0),          // blr x1
+        encode(true, OP_MOVI, 2, 0, 0x7FF0),    // mov x2, #0x7FF0
+        encode(true, OP_BR, 2, 0, 0),           // br x2
+    };
+}
+
+// HLT之前的存储把HLT改写为其他指令：改写之后的HLT不应停止
+std::vector<uint32_t> storeOverHalt() {
+    return {
+        encode(true, OP_MOVI, 1, 0, 12),        // mov x1, #12
+        encode(false, OP_LDRW, 2, 1, 12),       // ldr w2, [x1, #12]
+        encode(false, OP_STRW, 2, 1, 0),        // str w2, [x1]
+        HLT,
+        encode(true, OP_MOVI, 3, 0, 7),         // mov x3, #7
+        HLT,
+        encode(true, OP_MOVI, 4, 0, 9),         // 写入的值：mov x4, #9
+    };
+}
+
+// 同上，但以HLT结尾的块先执行到编译为本地代码：存储先写数据区，地址表中的第11项才指向HLT
+std::vector<uint32_t> storeOverHotHalt() {
+    std::vector<uint32_t> p = {
+        encode(true, OP_MOVI, 7, 0, 10 * 4),    // 0: mov x7, #&table
+        encode(true, OP_MOVI, 6, 0, 8 * 4),     // 1: mov x6, #&value
+        encode(false, OP_LDRW, 2, 6, 0),        // 2: ldr w2, [x6]
+        encode(true, OP_LDRD, 1, 7, 0),         // 3: ldr x1, [x7]
+        encode(true, OP_ADDI, 7, 7, 8),         // 4: add x7, x7, #8
+        encode(false, OP_STRW, 2, 1, 0),        // 5: str w2, [x1]
+        HLT,                                    // 6:
+        branch(OP_B, 7, 3),                     // 7: b 3
+        encode(true, OP_ADDI, 4, 4, 1),         // 8: 写入的值：add x4, x4, #1
+        0,                                      // 9: 对齐
+    };
+    for (int i = 0; i < 12; ++i) {              // 10: 地址表，每项两个字
+        p.push_back(i == 10 ? 6 * 4 : 0x4000);
+        p.push_back(0);
+    }
+    return p;
+}
+
+// BLR X30 跳到原来的X30；循环使该块编译为本地代码
+std::vector<uint32_t> blrLinkRegister() {
+    return {
+        encode(true, OP_MOVI, 9, 0, 12),        // 0: mov x9, #12
+        encode(true, OP_MOVI, 30, 0, 4 * 4),    // 1: mov x30, #&4
+        encode(true, OP_BLR, 30, 0, 0),         // 2: blr x30
+        HLT,                                    // 3: 返回地址，不应执行
+        encode(true, OP_SUBI, 9, 9, 1),         // 4: sub x9, x9, #1
+        encode(true, OP_CMPI, 9, 0, 0),         // 5: cmp x9, #0
+        branchCond(BranchCondition::GT, 6, 1),  // 6: b.gt 1
+        HLT,
+    };
+}
+
+std::vector<uint32_t> assembleQuietly(const std::string& text) {
+    Assembler assembler;
+    assembler.setVerbose(false);
+    return assembler.assemble(text);
+}
+
+// Test.cpp 中的求和循环
+std::vector<uint32_t> sumLoop() {
+    return assembleQuietly(R"(
+        sub     sp, sp, #16
+        mov     w0, #0
+        str     w0, [sp, #12]
+        str     w0, [sp, #8]
+        b       .L2
+    .L3:
+        ldr     w1, [sp, #12]
+        ldr     w0, [sp, #8]
+        add     w0, w1, w0
+        str     w0, [sp, #12]
+        ldr     w0, [sp, #8]
+        add     w0, w0, #1
+        str     w0, [sp, #8]
+    .L2:
+        ldr     w0, [sp, #8]
+        cmp     w0, #100
+        ble     .L3
+        add     sp, sp, #16
+        HLT
+    )");
+}
+
+// 只有一个基本块的循环：JIT在宿主寄存器中循环，第60轮除零时从循环中途退出
+std::vector<uint32_t> selfLoop() {
+    return assembleQuietly(R"(
+        mov     x0, #0
+        mov     x1, #100
+        mov     x8, #0x4000
+    .Loop:
+        add     x0, x0, x1
+        sub     x2, x1, #40
+        udiv    x5, x0, x2
+        str     x5, [x8]
+        ldr     w3, [x8]
+        add     x0, x0, x3
+        sub     x1, x1, #1
+        cmp     x1, #0
+        b.gt    .Loop
+        HLT
+    )");
+}
+
+// 源与目的区间重叠的批量复制：目的在源之上时从高地址向下复制；区间跨页，VirtualConfig 下分多次执行 CPYM
+std::vector<uint32_t> overlappingCopy() {
+    std::vector<uint32_t> p = {
+        encode(true, OP_MOVI, 1, 0, 0x3F00),    // mov x1, #0x3F00
+        encode(true, OP_MOVI, 2, 0, 0x200),     // mov x2, #0x200
+        encode(true, OP_MOVI, 3, 0, 0x5A),      // mov x3, #0x5A
+        systemInstr(false, SYS_SETP, 1, 2, 3),       // setp [x1]!, x2!, x3
+        systemInstr(false, SYS_SETM, 1, 2, 3),
+        systemInstr(false, SYS_SETE, 1, 2, 3),
+    };
+    const uint32_t copies[][2] = {{0x3F00, 0x3F40}, {0x3F40, 0x3F00}};    // {目的, 源}：向上、向下复制
+    for (const auto& copy : copies) {
+        p.push_back(encode(true, OP_MOVI, 1, 0, copy[0]));
+        p.push_back(encode(true, OP_MOVI, 4, 0, copy[1]));
+        p.push_back(encode(true, OP_MOVI, 2, 0, 0x180));
+        for (uint8_t subop : {SYS_CPYP, SYS_CPYM, SYS_CPYE}) p.push_back(systemInstr(false, subop, 1, 4, 2));
+    }
+    p.push_back(HLT);
+    return p;
+}
+
+// 随机程序：初始化寄存器后循环执行一段随机指令。x8 为数据区基址，x10 为代码基址（0），
+// x11 为越界地址，x12 为间接分支目标，x13~x16 为批量复制/填充的操作数；x9 为循环计数
+std::vector<uint32_t> randomProgram(std::mt19937& rng) {
+    std::vector<uint32_t> p;
+    for (uint8_t r = 0; r < 8; ++r) p.push_back(encode(true, OP_MOVI, r, 0, rng()));
+    p.push_back(encode(true, OP_MOVI, 8, 0, 0x4000 + (rng() % 64) * 8));
+    p.push_back(encode(true, OP_MOVI, 9, 0, 3 + rng() % 16));
+    p.push_back(encode(true, OP_MOVI, 10, 0, 0));
+    p.push_back(encode(true, OP_MOVI, 11, 0, 0xFFFC));
+    const size_t loop = p.size();
+    const size_t length = 8 + rng() % 32;     // 循环体的大致长度，用作随机分支目标的范围
+    const size_t programEnd = loop + length + 8;
+
+    while (p.size() < loop + length) {
+        const bool sf = rng() & 1;
+        const uint8_t rd = rng() % 8, rn = rng() % 8, rm = rng() % 8;
+        const uint32_t kind = rng() % 24;
+        if (kind < 6) {
+            static const uint8_t ALU[] = {OP_ADD, OP_ADDI, OP_SUB, OP_SUBI, OP_AND, OP_ANDI, OP_ORR, OP_ORRI,
+                                          OP_EOR, OP_EORI, OP_MOV, OP_MOVI, OP_CMP, OP_CMPI, OP_MUL};
+            const uint8_t op = ALU[rng() % (sizeof(ALU) / sizeof(ALU[0]))];
+            if (op == OP_CMP) {
+                p.push_back(encode(sf, op, rn, rm, 0));
+            } else {
+                const bool immediate = (op == OP_ADDI || op == OP_SUBI || op == OP_ANDI || op == OP_ORRI ||
+                                        op == OP_EORI || op == OP_MOVI || op == OP_CMPI);
+                p.push_back(encode(sf, op, rd, rn, immediate ? rng() : rm));
+            }
+        } else if (kind < 7) {
+            if (rng() % 4) p.push_back(encode(true, OP_ORRI, rm, rm, 1));    // 偶尔保留除数为0
+            p.push_back(encode(sf, (rng() & 1) ? OP_SDIV : OP_UDIV, rd, rn, rm));
+        } else if (kind < 11) {
+            const uint8_t op = OP_LDRB + rng() % 8;
+            const uint8_t base = (rng() % 40 == 0) ? 11 : 8;
+            p.push_back(encode(sf, op, rd, base, static_cast<uint32_t>(static_cast<int32_t>(rng() % 64) - 32)));
+        } else if (kind < 13) {
+            // 改写代码：把程序中的某条指令复制到另一处（可能是HLT、本块或尚未执行的指令）
+            const uint32_t from = rng() % programEnd, to = rng() % programEnd;
+            p.push_back(encode(false, OP_LDRW, 12, 10, from * 4));
+            p.push_back(encode(false, OP_STRW, 12, 10, to * 4));
+        } else if (kind < 16) {
+            const size_t at = p.size();
+            p.push_back(branchCond(static_cast<BranchCondition>(rng() % 16), at, at + 2));
+            p.push_back(encode(sf, OP_ADDI, rd, rd, 7));
+        } else if (kind < 18) {
+            // 间接分支（BR/BLR/RET）：程序内的指令、未对齐地址、越界地址或X30
+            static const uint8_t INDIRECT[] = {OP_BR, OP_BLR, OP_RET};
+            const uint8_t op = INDIRECT[rng() % 3];
+            uint8_t target = 30;
+            switch (rng() % 4) {
+            case 0:  target = 12; p.push_back(encode(true, OP_MOVI, 12, 0, (rng() % programEnd) * 4)); break;
+            case 1:  target = 12; p.push_back(encode(true, OP_MOVI, 12, 0, (rng() % programEnd) * 4 + 2)); break;
+            case 2:  target = 12; p.push_back(encode(true, OP_MOVI, 12, 0, 0xFFFC)); break;
+            default: break;
+            }
+            if (op == OP_RET && target != 30) p.push_back(encode(true, OP_MOV, 30, 12, 0));
+            p.push_back(op == OP_RET ? encode(false, OP_RET, 0, 0, 0) : encode(true, op, target, 0, 0));
+        } else if (kind < 19) {
+            const size_t at = p.size();
+            p.push_back(branch(OP_BL, at, at + 2));
+            p.push_back(encode(sf, OP_ADDI, rd, rd, 3));
+        } else if (kind < 20) {
+            p.push_back(HLT);
+        } else if (kind < 22) {
+            // 批量复制/填充：数据区内可能重叠的区间、程序中的指令（改写代码）或越界地址
+            uint32_t to = 0x4000 + rng() % 0x400, from = to + rng() % 0x100 - 0x80, size = rng() % 0x200;
+            switch (rng() % 4) {
+            case 0:  to = (rng() % programEnd) * 4; from = (rng() % programEnd) * 4; size = 4 * (1 + rng() % 4); break;
+            case 1:  to = 0xFFF0; break;
+            default: break;
+            }
+            p.push_back(encode(true, OP_MOVI, 13, 0, to));
+            p.push_back(encode(true, OP_MOVI, 15, 0, size));
+            if (rng() & 1) {
+                p.push_back(encode(true, OP_MOVI, 14, 0, from));
+                for (uint8_t subop : {SYS_CPYP, SYS_CPYM, SYS_CPYE}) p.push_back(systemInstr(false, subop, 13, 14, 15));
+            } else {
+                p.push_back(encode(true, OP_MOVI, 16, 0, rng()));
+                for (uint8_t subop : {SYS_SETP, SYS_SETM, SYS_SETE}) p.push_back(systemInstr(false, subop, 13, 15, 16));
+            }
+        } else {
+            // 多核同步指令（单核执行）：偶尔以越界地址访问
+            const uint8_t base = (rng() % 20 == 0) ? 11 : 8;
+            switch (rng() % 5) {
+            case 0:
+                p.push_back(systemInstr(sf, SYS_LDXR, rd, base, 0));
+                if (rng() & 1) p.push_back(encode(sf, (rng() & 1) ? OP_STRD : OP_STRW, rm, 8, 0));    // 改写（或写回原值）
+                p.push_back(systemInstr(sf, SYS_STXR, rn, rm, base));
+                break;
+            case 1:  p.push_back(systemInstr(sf, SYS_LDADD, rm, rd, base)); break;
+            case 2:  p.push_back(systemInstr(sf, SYS_CAS, rm, rd, base)); break;
+            case 3:  p.push_back(systemInstr(false, SYS_DMB, 0, 0, 0)); break;
+            default: p.push_back(systemInstr(true, SYS_MRS, rd, 0, (rng() & 1) ? SYSREG_MPIDR : 5)); break;
+            }
+        }
+    }
+
+    p.push_back(encode(true, OP_SUBI, 9, 9, 1));
+    p.push_back(encode(true, OP_CMPI, 9, 0, 0));
+    p.push_back(branchCond(BranchCondition::GT, p.size(), loop));
+    while (p.size() < programEnd) p.push_back(HLT);
+    return p;
+}
+
+// ====================== 各配置 ======================
+
+template<typename Config, typename Hooks>
+int testConfig(const char* name, const std::vector<TestProgram>& programs) {
+    using Core = BasicCPU<Config, Hooks>;
+    struct Engine {
+        const char* name;
+        StopReason (Core::*run)(uint64_t);
+    };
+    const Engine engines[] = {{"run", &Core::run}, {"runBlocks", &Core::runBlocks}, {"runJit", &Core::runJit}};
+    const uint64_t chunks[] = {MAX_STEPS, 7};
+
+    auto instance = std::make_unique<Core>();
+    Core& cpu = *instance;
+    int failures = 0;
+    for (const TestProgram& program : programs) {
+        const MachineState expected = runReference(cpu, program.code);
+        for (const Engine& engine : engines) {
+            for (uint64_t chunk : chunks) {
+                const MachineState actual = runEngine(cpu, program.code, engine.run, chunk);
+                if (!(actual == expected)) {
+                    if (failures < 10) report(name, program.name, engine.name, chunk, expected, actual);
+                    ++failures;
+                }
+            }
+        }
+    }
+    printf("%-24s %zu programs, %d mismatches\n", name, programs.size(), failures);
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    std::vector<TestProgram> programs = {
+        {"branch-out-of-bounds", branchOutOfBounds()},
+        {"branch-misaligned", branchMisaligned()},
+        {"store-over-halt", storeOverHalt()},
+        {"store-over-hot-halt", storeOverHotHalt()},
+        {"blr-x30", blrLinkRegister()},
+        {"sum-loop", sumLoop()},
+        {"self-loop", selfLoop()},
+        {"overlapping-copy", overlappingCopy()},
+    };
+    for (int seed = 1; seed <= RANDOM_PROGRAMS; ++seed) {
+        std::mt19937 rng(seed);
+        programs.push_back({"random-" + std::to_string(seed), randomProgram(rng)});
+    }
+
+    int failures = 0;
+#define TEST_CONFIG(CONFIG, HOOKS) failures += testConfig<CONFIG, HOOKS>(#CONFIG "/" #HOOKS, programs);
+    TINY_CPU_CONFIGS(TEST_CONFIG)
+#undef TEST_CONFIG
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -1,53 +1,31 @@
 #pragma once
 
+#include "ISA.h"
+
 // ALU操作定义
 enum class ALUOp {
     ADD, SUB, MUL, SDIV, UDIV, AND, ORR, EOR, NOT, LSL, LSR, ASR, CMP
 };
 
-// 指令操作码
+// 指令操作码，由 ISA.h 中的指令表生成
+#define TINY_OPCODE_ENUM(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) OP_##NAME = OPCODE,
 enum Opcode {
-    OP_ADD     = 0b000000,
-    OP_ADDI    = 0b000001,
-    OP_SUB     = 0b000010,
-    OP_SUBI    = 0b000011,
-
-    OP_AND     = 0b000100,
-    OP_ANDI    = 0b000101,
-    OP_ORR     = 0b000110,
-    OP_ORRI    = 0b000111,
-    OP_EOR     = 0b001000,
-    OP_EORI    = 0b001001,
-
-    OP_MOV     = 0b001010,
-    OP_MOVI    = 0b001011,
-
-    OP_CMP     = 0b001100,
-    OP_CMPI    = 0b001101,
-
-    OP_MUL     = 0b001110,
-    OP_SDIV    = 0b001111,
-    OP_UDIV    = 0b010000,
-
-    OP_LDRB    = 0b010001,
-    OP_LDRH    = 0b010010,
-    OP_LDRW    = 0b010011,
-    OP_LDRD    = 0b010100,
-
-    OP_STRB    = 0b010101,
-    OP_STRH    = 0b010110,
-    OP_STRW    = 0b010111,
-    OP_STRD    = 0b011000,
+    TINY_ISA(TINY_OPCODE_ENUM, true)
+};
+#undef TINY_OPCODE_ENUM
 
-    OP_B       = 0b011001,
-    OP_B_COND  = 0b011010,
-    OP_BL      = 0b011011,
-    OP_BLR     = 0b011100,
-    OP_BR      = 0b011101,
+// 系统指令子操作码（opcode = OP_SYS 时位于 [15:8]）
+#define TINY_SYSTEM_ENUM(NAME, SUBOP, MNEMONIC, FORMAT, HANDLER) SYS_##NAME = SUBOP,
+enum SystemOpcode {
+    TINY_SYSTEM_ISA(TINY_SYSTEM_ENUM)
+};
+#undef TINY_SYSTEM_ENUM
 
-    OP_RET     = 0b011110,
-    OP_HLT     = 0b011111,
-    OP_NOP     = 0b111111
+// 批量内存指令（CPY*/SET*）的三个阶段
+enum class MopsStage : uint8_t {
+    PROLOGUE,   // CPYP/SETP：选择方向，不移动数据
+    MAIN,       // CPYM/SETM：处理一段，未完成时重新执行
+    EPILOGUE    // CPYE/SETE：处理剩余部分
 };
 
 // 分支条件
@@ -70,67 +48,26 @@ enum class BranchCondition {
     NV = 0b1111   // Never (reserved)
 };
 
-// 指令类型枚举
-enum class InstructionType {
-    // 数据处理指令
-    DATA_PROCESSING_REG,     // ADD X1, X2, X3
-    DATA_PROCESSING_IMM,     // ADD X1, X2, #100
-    
-    // 内存访问指令
-    LOAD_STORE,              // LDR X1, [X2, #8]
-    
-    // 分支指令
-    BRANCH_UNCOND,           // B label
-    BRANCH_COND,             // B.EQ label
-    BRANCH_LINK,             // BL label
-    BRANCH_REG,              // BR X1, BLR X1
-    
-    // 比较指令
-    COMPARE,                 // CMP X1, X2
-    
-    // 移动指令
-    MOVE_REG,                // MOV X1, X2
-    MOVE_IMM,                // MOV X1, #100
-    MOVE_WIDE,               // MOVZ, MOVN, MOVK
-    
-    // 系统指令
-    SYSTEM,                  // NOP, HLT, RET
-    
-    // 乘除指令
-    MULTIPLY,                // MUL, MADD, MSUB
-    DIVIDE                   // UDIV, SDIV
-};
-
-// 数据处理操作类型
-enum class DataProcOp {
-    // 算术运算
-    ADD, ADDS, SUB, SUBS,
-    ADC, ADCS, SBC, SBCS,
-    MUL, SDIV, UDIV,
-    
-    // 逻辑运算
-    AND, ANDS, ORR, EOR,
-    BIC, ORN, EON,
-    
-    // 位移运算
-    LSL, LSR, ASR, ROR
+// 执行停止原因
+enum class StopReason {
+    NONE,            // 继续执行（仅微操作内部使用）
+    HALT,            // 执行了HLT
+    MEMORY_FAULT,    // 取指或访存越界，见 CPU::getFaultAddress()
+    DIVIDE_BY_ZERO,  // 除数为0
+    STEP_LIMIT,      // 用完了步数预算
+    BREAKPOINT       // 到达 runUntil 指定的地址
 };
 
-// 内存操作类型
-enum class MemoryOp {
-    LOAD_BYTE,      // LDRB
-    LOAD_HALF,      // LDRH  
-    LOAD_WORD,      // LDR (32-bit)
-    LOAD_DWORD,     // LDR (64-bit)
-    STORE_BYTE,     // STRB
-    STORE_HALF,     // STRH
-    STORE_WORD,     // STR (32-bit)
-    STORE_DWORD     // STR (64-bit)
+// 批量执行使用的引擎，对应 BasicCPU::run() / runBlocks() / runJit()
+enum class ExecutionEngine : uint8_t {
+    INTERPRETER,
+    BLOCKS,
+    JIT
 };
 
-// 系统操作类型
-enum class SystemOp {
-    NOP,
-    RET, 
-    HLT
+// 内存访问类型（用于报告访存错误）
+enum class MemoryAccess {
+    FETCH,
+    READ,
+    WRITE
 };
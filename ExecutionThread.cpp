@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "ExecutionThread.h"
+
+// ====================== 命令 ======================
+ExecutionThread::ExecutionThread(CPU& cpu, ExecutionEngine engine) : cpu(cpu), engine(engine) {
+    publish(false);
+    worker = std::thread(&ExecutionThread::work, this);
+}
+
+ExecutionThread::~ExecutionThread() {
+    stop();
+}
+
+// 调用者持有锁；取消尚未开始的命令，请求正在执行的命令暂停，等待工作线程停下
+void ExecutionThread::waitParked(std::unique_lock<std::mutex>& lock) {
+    if (command == Command::RUN) {      // 工作线程还没有取走命令
+        command = Command::NONE;
+        busy = false;
+    }
+    pauseRequested.store(true, std::memory_order_relaxed);
+    parked.wait(lock, [&] { return !busy; });
+    pauseRequested.store(false, std::memory_order_relaxed);
+}
+
+void ExecutionThread::issue(uint64_t steps) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (exited) {
+        throw std::runtime_error("Execution thread has been stopped");
+    }
+    waitParked(lock);
+    command = Command::RUN;
+    budget = steps;
+    busy = true;        // 工作线程取走命令之前 isIdle() 也为false
+    wakeup.notify_one();
+}
+
+void ExecutionThread::run(uint64_t maxSteps) {
+    issue(maxSteps);
+}
+
+void ExecutionThread::step(uint64_t count) {
+    issue(count);
+}
+
+void ExecutionThread::pause() {
+    std::unique_lock<std::mutex> lock(mutex);
+    waitParked(lock);
+}
+
+void ExecutionThread::stop() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (exited) return;
+        waitParked(lock);
+        command = Command::EXIT;
+        exited = true;
+        wakeup.notify_one();
+    }
+    worker.join();
+}
+
+bool ExecutionThread::isIdle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !busy;
+}
+
+void ExecutionThread::watchMemory(uint64_t address) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (watchAddress.exchange(address, std::memory_order_relaxed) == address) return;
+    if (!busy) publish(false);
+}
+
+void ExecutionThread::refresh() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!busy) publish(false);
+}
+
+// ====================== 工作线程 ======================
+StopReason ExecutionThread::execute(uint64_t steps) {
+    switch (engine) {
+    case ExecutionEngine::INTERPRETER: return cpu.run(steps);
+    case ExecutionEngine::BLOCKS:      return cpu.runBlocks(steps);
+    default:                           return cpu.runJit(steps);
+    }
+}
+
+// 命令按分片执行，分片之间检查暂停请求；各执行方式停下时 PC/IR 都与逐条执行一致
+void ExecutionThread::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wakeup.wait(lock, [&] { return command != Command::NONE; });
+        if (command == Command::EXIT) return;
+        command = Command::NONE;
+        uint64_t remaining = budget;
+        commandSteps = 0;
+        lock.unlock();
+
+        StopReason reason = StopReason::STEP_LIMIT;
+        auto lastPublish = std::chrono::steady_clock::now();
+        while (remaining > 0 && !pauseRequested.load(std::memory_order_relaxed)) {
+            const uint64_t slice = std::min(remaining, SLICE_STEPS);
+            reason = execute(slice);
+            remaining -= cpu.getRunSteps();
+            commandSteps += cpu.getRunSteps();
+            cpu.steps += static_cast<uint32_t>(cpu.getRunSteps());
+            if (reason != StopReason::STEP_LIMIT) break;
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now - lastPublish >= PUBLISH_INTERVAL) {
+                publish(true);
+                lastPublish = now;
+            }
+        }
+
+        lock.lock();
+        lastReason = reason;
+        ++stopCount;
+        busy = false;
+        publish(false);
+        parked.notify_all();
+    }
+}
+
+void ExecutionThread::publish(bool running) {
+    ExecutionSnapshot s{};
+    s.running = running;
+    s.reason = lastReason;
+    s.stopCount = stopCount;
+    s.commandSteps = commandSteps;
+    s.steps = cpu.steps;
+    s.pc = cpu.getPC();
+    s.ir = static_cast<uint32_t>(cpu.getIR());
+    s.status = cpu.getStatusReg();
+    s.generation = cpu.publishChanges();
+    for (uint8_t i = 0; i < 32; ++i) {
+        s.regs[i] = cpu.getReg(i);
+        s.regGenerations[i] = cpu.getRegisterGeneration(i);
+    }
+
+    const uint64_t memSize = cpu.getMemorySize();
+    s.memoryBase = std::min(watchAddress.load(std::memory_order_relaxed), memSize);
+    s.memorySize = std::min<uint64_t>(ExecutionSnapshot::MEMORY_WINDOW, memSize - s.memoryBase);
+    const MemorySpan window = cpu.viewMemory(s.memoryBase, s.memorySize);
+    std::copy(window.begin(), window.end(), s.memory.begin());
+    published.store(s);
+}
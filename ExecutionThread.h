@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "CPU.h"
+
+// ========================== 顺序锁 ==========================
+// 单写者、多读者，读者不加锁也不阻塞写者：写者改写前后各把序号加1，
+// 读者读到奇数序号或读取前后序号不同时重读。内容按8字节字逐个原子读写，不存在数据竞争
+template<typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock contents are copied word by word");
+
+public:
+    Seqlock() {
+        for (auto& word : words) word.store(0, std::memory_order_relaxed);
+    }
+
+    // 只能由一个线程调用（或由调用者串行化）
+    void store(const T& value) {
+        uint64_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        const uint64_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) words[i].store(buffer[i], std::memory_order_relaxed);
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        uint64_t buffer[WORDS];
+        for (;;) {
+            const uint64_t seq = sequence.load(std::memory_order_acquire);
+            if (seq & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < WORDS; ++i) buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == seq) break;
+        }
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + 7) / 8;
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> words[WORDS];
+};
+
+// ========================== 后台执行 ==========================
+// 调试界面的执行线程：CPU在工作线程上执行，界面线程只发出命令并读取快照，渲染不会被长时间的执行卡住。
+// 执行按 SLICE_STEPS 条指令分片，片间检查暂停请求，并以不超过帧率的频率发布快照（寄存器、NZCV、
+// 观察窗口内的内存与变化代数），界面每帧读取最新的一份。
+// 同一时刻只能有一个线程发出命令；isIdle() 为true（或快照的 running 为false）且发出命令的线程
+// 没有再发出命令时工作线程已停下，此时可以直接访问CPU（复位、加载程序、查找内存等），之后调用 refresh()
+
+struct ExecutionSnapshot {
+    static constexpr size_t MEMORY_WINDOW = 512;
+
+    bool running;                   // 正在执行 run() 或 step() 的命令
+    StopReason reason;              // 上一个命令停下的原因（暂停时为 STEP_LIMIT）
+    uint64_t stopCount;             // 每个命令结束时加1
+    uint64_t commandSteps;          // 当前（或上一个）命令已执行的指令数
+    uint32_t steps;                 // CPU::steps
+
+    uint64_t pc;
+    uint32_t ir;
+    StatusRegister status;
+    std::array<uint64_t, 32> regs;  // 31为SP
+
+    // 发布时的变化代数与各寄存器的代数（见 CPU::publishChanges）
+    uint64_t generation;
+    std::array<uint64_t, 32> regGenerations;
+
+    // 观察窗口：[memoryBase, memoryBase + memorySize) 的内容
+    uint64_t memoryBase;
+    uint64_t memorySize;
+    std::array<uint8_t, MEMORY_WINDOW> memory;
+};
+
+class ExecutionThread {
+public:
+    static constexpr uint64_t SLICE_STEPS = 1 << 18;
+    static constexpr std::chrono::milliseconds PUBLISH_INTERVAL{16};
+
+    explicit ExecutionThread(CPU& cpu, ExecutionEngine engine = ExecutionEngine::JIT);
+    ~ExecutionThread();
+
+    ExecutionThread(const ExecutionThread&) = delete;
+    ExecutionThread& operator=(const ExecutionThread&) = delete;
+
+    // 驱动 CPU::GetInstance() 的默认实例，供调试界面使用
+    static ExecutionThread& GetInstance() {
+        static ExecutionThread instance(CPU::GetInstance());
+        return instance;
+    }
+
+    CPU& getCPU() { return cpu; }
+
+    // 以下命令在正在执行时先暂停；stop() 之后调用 run()/step() 抛出异常
+    // 在后台执行至多 maxSteps 条指令，遇到HLT、出错或 pause() 时停下，立即返回
+    void run(uint64_t maxSteps = UINT64_MAX);
+    // 在后台执行 count 条指令，立即返回
+    void step(uint64_t count = 1);
+    // 请求暂停并等待工作线程停下（至多一个分片）
+    void pause();
+    // 暂停并结束工作线程
+    void stop();
+
+    bool isIdle() const;
+
+    // 观察窗口的起始地址；空闲时立即发布新的快照
+    void watchMemory(uint64_t address);
+    // 空闲时直接改动CPU之后调用：发布新的快照
+    void refresh();
+
+    ExecutionSnapshot snapshot() const { return published.load(); }
+
+private:
+    enum class Command : uint8_t {
+        NONE,
+        RUN,
+        EXIT
+    };
+
+    CPU& cpu;
+    const ExecutionEngine engine;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;             // 有新命令
+    std::condition_variable parked;             // 工作线程停下
+    Command command = Command::NONE;
+    uint64_t budget = 0;                        // 新命令的步数
+    bool busy = false;                          // 有命令尚未结束（工作线程执行时不持有锁）
+    bool exited = false;
+    std::atomic<bool> pauseRequested{false};
+
+    // 快照中不随CPU变化的部分：只在持有锁时（或由执行中的工作线程）改写
+    StopReason lastReason = StopReason::NONE;
+    uint64_t stopCount = 0;
+    uint64_t commandSteps = 0;
+    std::atomic<uint64_t> watchAddress{0};
+
+    Seqlock<ExecutionSnapshot> published;
+    std::thread worker;
+
+    void work();
+    void issue(uint64_t steps);
+    void waitParked(std::unique_lock<std::mutex>& lock);
+    StopReason execute(uint64_t steps);
+    // 由执行中的工作线程或持有锁的空闲时调用
+    void publish(bool running);
+};
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ExecutionThread.h"
+
+// ========================== 执行线程压力测试 ==========================
+// 每种执行方式：命令线程（唯一的写者）随机发出 run / step / pause / watchMemory / refresh，
+// 读者线程不停地读取快照。检查：
+//   快照不会读到一半：观察窗口中的计数器等于快照的 x1 或 x1 - 1（循环在 add 与 str 之间停下），
+//     stopCount 与变化代数不减
+//   忙/空闲的交接：step(n) 结束后 isIdle() 为true，此时直接读写CPU，refresh() 后的快照与CPU一致；
+//     pause() 返回时工作线程已停下；watchMemory() 在空闲时立即发布新窗口
+//   stop() 之后 run()/step() 抛出异常
+// 以 ThreadSanitizer 构建时（CMake 的 ExecutionThreadTestTsan）同时检查以上交接中没有数据竞争。全部通过时返回0
+
+namespace {
+
+const uint64_t COUNTER = 0x4000;
+const uint64_t OTHER_WINDOW = 0x3F00;   // 不含计数器的观察窗口
+const int COMMANDS = 300;
+const int READERS = 2;
+
+// x1 每轮加1并写入计数器，不会停止
+const char* const PROGRAM = R"(
+        mov     x8, #0x4000
+        mov     x1, #0
+    .Loop:
+        add     x1, x1, #1
+        str     x1, [x8]
+        b       .Loop
+    )";
+const uint64_t LOOP_PC = 2 * 4;
+
+std::vector<uint32_t> assembleQuietly(const std::string& text) {
+    Assembler assembler;
+    assembler.setVerbose(false);
+    return assembler.assemble(text);
+}
+
+struct Checker {
+    const char* engine;
+    std::atomic<int> failures{0};
+
+    void expect(bool ok, const char* what) {
+        if (ok) return;
+        if (failures.fetch_add(1) < 10) printf("  %s: %s\n", engine, what);
+    }
+};
+
+uint64_t windowCounter(const ExecutionSnapshot& s) {
+    uint64_t value;
+    std::memcpy(&value, s.memory.data() + (COUNTER - s.memoryBase), sizeof(value));
+    return value;
+}
+
+// 快照内部一致：计数器与 x1 来自同一次发布
+bool consistent(const ExecutionSnapshot& s) {
+    if (s.memoryBase != COUNTER) return true;
+    const uint64_t value = windowCounter(s);
+    return value == s.regs[1] || value + 1 == s.regs[1];
+}
+
+void waitIdle(const ExecutionThread& thread) {
+    while (!thread.isIdle()) std::this_thread::yield();
+}
+
+int testEngine(const char* name, ExecutionEngine engine) {
+    Checker check{name};
+    auto cpu = std::make_unique<CPU>();
+    cpu->loadProgram(assembleQuietly(PROGRAM));
+    ExecutionThread thread(*cpu, engine);
+    thread.watchMemory(COUNTER);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READERS; ++i) {
+        readers.emplace_back([&] {
+            uint64_t lastStops = 0, lastGeneration = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                const ExecutionSnapshot s = thread.snapshot();
+                check.expect(consistent(s), "snapshot is not torn");
+                check.expect(s.stopCount >= lastStops && s.generation >= lastGeneration, "snapshot does not go back");
+                lastStops = s.stopCount;
+                lastGeneration = s.generation;
+                thread.isIdle();
+            }
+        });
+    }
+
+    // 命令线程
+    std::mt19937 rng(7);
+    for (int i = 0; i < COMMANDS; ++i) {
+        switch (rng() % 5) {
+        case 0: {   // 后台执行一会儿再暂停
+            thread.run();
+            std::this_thread::sleep_for(std::chrono::microseconds(rng() % 2000));
+            thread.pause();
+            check.expect(thread.isIdle(), "pause() returns after the worker parks");
+            const ExecutionSnapshot s = thread.snapshot();
+            // 工作线程取走之前被取消的命令不计停止，第一个命令之前原因仍为 NONE
+            check.expect(!s.running && (s.reason == StopReason::STEP_LIMIT || s.stopCount == 0),
+                         "paused command reports STEP_LIMIT");
+            check.expect(s.regs[1] == cpu->getReg(1) && s.pc == cpu->getPC(), "paused snapshot matches the CPU");
+            break;
+        }
+        case 1: {   // 执行 n 条指令，空闲后直接读CPU
+            thread.pause();     // 上一个命令可能仍在执行
+            const uint64_t before = thread.snapshot().stopCount;
+            const uint64_t n = 1 + rng() % 5000;
+            thread.step(n);
+            waitIdle(thread);
+            const ExecutionSnapshot s = thread.snapshot();
+            check.expect(s.stopCount == before + 1 && s.commandSteps == n, "step(n) executes n instructions");
+            check.expect(s.regs[1] == cpu->getReg(1) && s.pc == cpu->getPC(), "idle snapshot matches the CPU");
+            break;
+        }
+        case 2: {   // 空闲时改动CPU并发布
+            thread.pause();
+            cpu->setReg(1, 0);
+            cpu->writeMemoryRange(COUNTER, std::vector<uint8_t>(sizeof(uint64_t), 0));
+            cpu->setPC(LOOP_PC);
+            thread.refresh();
+            const ExecutionSnapshot s = thread.snapshot();
+            check.expect(s.regs[1] == 0 && s.pc == LOOP_PC && (s.memoryBase != COUNTER || windowCounter(s) == 0),
+                         "refresh() publishes direct changes");
+            break;
+        }
+        case 3: {   // 切换观察窗口，可能正在执行
+            const uint64_t address = (rng() & 1) ? COUNTER : OTHER_WINDOW;
+            if (rng() & 1) thread.run();
+            thread.watchMemory(address);
+            if (thread.isIdle()) check.expect(thread.snapshot().memoryBase == address, "watchMemory() publishes when idle");
+            break;
+        }
+        default:    // 执行中再次发出命令：先暂停上一个命令
+            thread.run();
+            thread.step(1 + rng() % 100);
+            waitIdle(thread);
+            check.expect(thread.snapshot().reason == StopReason::STEP_LIMIT, "a new command replaces the running one");
+            break;
+        }
+    }
+
+    thread.pause();
+    done.store(true, std::memory_order_relaxed);
+    for (std::thread& t : readers) t.join();
+
+    thread.stop();
+    bool threw = false;
+    try { thread.run(); } catch (const std::runtime_error&) { threw = true; }
+    check.expect(threw, "run() after stop() throws");
+
+    printf("%-12s %d failures\n", name, check.failures.load());
+    return check.failures.load();
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    failures += testEngine("interpreter", ExecutionEngine::INTERPRETER);
+    failures += testEngine("blocks", ExecutionEngine::BLOCKS);
+    failures += testEngine("jit", ExecutionEngine::JIT);
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+
+// ========================== fork() 测试 ==========================
+// 父子CPU在 fork() 之后互不影响：任一方执行存储、改写代码或复位，另一方的内存、代码与寄存器都不变。
+// 每种执行方式（run / runBlocks / runJit）与每个配置（TINY_CPU_CONFIGS）各测一遍，
+// 循环足够长，使JIT编译带存储的块。全部通过时返回0
+
+namespace {
+
+const uint64_t COUNTER = 0x4000;    // 程序累加的计数器
+const uint64_t MAX_STEPS = 100000;
+
+// 计数器加 20 * 步长；步长由第3条指令（add x1, x1, #1）决定
+const char* const COUNT_LOOP = R"(
+        mov     x8, #0x4000
+        mov     x2, #20
+    .Loop:
+        ldr     x1, [x8]
+        add     x1, x1, #1
+        str     x1, [x8]
+        sub     x2, x2, #1
+        cmp     x2, #0
+        b.gt    .Loop
+        HLT
+    )";
+const uint64_t STEP_INSTRUCTION = 3 * 4;
+
+std::vector<uint32_t> assembleQuietly(const std::string& text) {
+    Assembler assembler;
+    assembler.setVerbose(false);
+    return assembler.assemble(text);
+}
+
+template<typename Core>
+uint64_t counter(const Core& cpu) {
+    std::vector<uint8_t> bytes = cpu.readMemoryRange(COUNTER, sizeof(uint64_t));
+    uint64_t value;
+    std::memcpy(&value, bytes.data(), sizeof(value));
+    return value;
+}
+
+template<typename Core>
+void setCounter(Core& cpu, uint64_t value) {
+    std::vector<uint8_t> bytes(sizeof(value));
+    std::memcpy(bytes.data(), &value, sizeof(value));
+    cpu.writeMemoryRange(COUNTER, bytes);
+}
+
+template<typename Core>
+void writeInstruction(Core& cpu, uint64_t address, uint32_t ir) {
+    std::vector<uint8_t> bytes(sizeof(ir));
+    std::memcpy(bytes.data(), &ir, sizeof(ir));
+    cpu.writeMemoryRange(address, bytes);
+}
+
+struct Checker {
+    const char* config;
+    const char* engine;
+    int failures = 0;
+
+    void expect(bool ok, const char* what) {
+        if (ok) return;
+        if (failures < 10) printf("  %s %s: %s\n", config, engine, what);
+        ++failures;
+    }
+};
+
+template<typename Config, typename Hooks>
+int testConfig(const char* name) {
+    using Core = BasicCPU<Config, Hooks>;
+    struct Engine {
+        const char* name;
+        StopReason (Core::*run)(uint64_t);
+    };
+    const Engine engines[] = {{"run", &Core::run}, {"runBlocks", &Core::runBlocks}, {"runJit", &Core::runJit}};
+    const std::vector<uint32_t> program = assembleQuietly(COUNT_LOOP);
+    const uint32_t addFive = assembleQuietly("add x1, x1, #5\n")[0];
+
+    int failures = 0;
+    for (const Engine& engine : engines) {
+        Checker check{name, engine.name};
+        auto execute = [&](Core& cpu) {
+            cpu.setPC(0);
+            return (cpu.*engine.run)(MAX_STEPS) == StopReason::HALT;
+        };
+
+        auto parent = std::make_unique<Core>();
+        parent->loadProgram(program);
+        setCounter(*parent, 1000);
+        check.expect(execute(*parent) && counter(*parent) == 1020, "parent runs before fork");
+
+        // 子CPU看到 fork() 时的状态
+        std::unique_ptr<Core> child = parent->fork();
+        check.expect(counter(*child) == 1020 && child->getReg(1) == 1020 && child->getPC() == parent->getPC(),
+                     "child starts from the parent's state");
+
+        // 子 -> 父
+        check.expect(execute(*child) && counter(*child) == 1040, "child runs");
+        check.expect(counter(*parent) == 1020, "child's stores are not visible to the parent");
+
+        // 父 -> 子
+        check.expect(execute(*parent) && execute(*parent) && counter(*parent) == 1060, "parent runs after fork");
+        check.expect(counter(*child) == 1040 && child->getReg(1) == 1040, "parent's stores are not visible to the child");
+
+        // 改写代码只影响改写的一方，双方的预译码与JIT代码各自失效
+        writeInstruction(*child, STEP_INSTRUCTION, addFive);
+        check.expect(execute(*child) && counter(*child) == 1140, "child runs its rewritten code");
+        check.expect(execute(*parent) && counter(*parent) == 1080, "parent keeps its own code");
+
+        // 复位父CPU不影响子CPU，反之亦然
+        parent->reset();
+        check.expect(counter(*parent) == 0, "reset clears the parent");
+        check.expect(counter(*child) == 1140 && execute(*child) && counter(*child) == 1240, "child survives the parent's reset");
+
+        parent->loadProgram(program);
+        setCounter(*parent, 7);
+        std::unique_ptr<Core> second = parent->fork();
+        std::unique_ptr<Core> grandchild = child->fork();
+        child->reset();
+        check.expect(counter(*child) == 0, "reset clears the child");
+        check.expect(counter(*grandchild) == 1240 && execute(*grandchild) && counter(*grandchild) == 1340,
+                     "grandchild survives its parent's reset");
+        check.expect(counter(*second) == 7 && execute(*second) && counter(*second) == 27, "second fork sees the reloaded parent");
+        check.expect(execute(*parent) && counter(*parent) == 27 && counter(*second) == 27, "forks of a reset parent stay isolated");
+
+        failures += check.failures;
+    }
+    printf("%-24s %d failures\n", name, failures);
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+#define TEST_CONFIG(CONFIG, HOOKS) failures += testConfig<CONFIG, HOOKS>(#CONFIG "/" #HOOKS);
+    TINY_CPU_CONFIGS(TEST_CONFIG)
+#undef TEST_CONFIG
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
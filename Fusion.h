@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "ISA.h"
+#include "Enums.h"
+
+// ========================== 指令融合 ==========================
+// 预译码时把常见的指令序列标记为融合序列：序列首条的分派索引改为 FUSED_INDEX_BASE + 编号，
+// 线程化解释器按该索引跳到一个依次内联执行整段序列的执行体，省去序列内的分派与查页。
+// 序列中其余指令的微操作保持原样，跳转目标落在序列中间时按普通指令执行；
+// 首条的执行函数也保持原样，逐条执行（step()、基本块、JIT）时不受融合影响。
+// 序列来自 ProfileHooks 统计的热点 n-gram（Test.cpp 的求和与斐波那契程序）。
+
+// 匹配条件：(sf << 5) | opcode；FUSE_ANY 表示不区分位宽
+#define FUSE_W(OP)   (OP_##OP)
+#define FUSE_X(OP)   (0x20 | OP_##OP)
+#define FUSE_ANY(OP) (0x80 | OP_##OP)
+
+// PAIR(NAME, FIRST, SECOND, H1, H2) / TRIPLE(NAME, FIRST, SECOND, THIRD, H1, H2, H3)
+// 首条必须精确匹配位宽；除末条外不得为分支或存储（序列中途不会改变控制流或使代码页失效）
+#define TINY_FUSIONS(PAIR, TRIPLE) \
+    PAIR(CMP_BCOND_W,   FUSE_W(CMP),   FUSE_ANY(B_COND), (uopALU<ALUOp::CMP, false, false>), (uopBCondAfterCmp<false>)) \
+    PAIR(CMP_BCOND_X,   FUSE_X(CMP),   FUSE_ANY(B_COND), (uopALU<ALUOp::CMP, true, false>),  (uopBCondAfterCmp<true>)) \
+    PAIR(CMPI_BCOND_W,  FUSE_W(CMPI),  FUSE_ANY(B_COND), (uopALU<ALUOp::CMP, false, true>),  (uopBCondAfterCmp<false>)) \
+    PAIR(CMPI_BCOND_X,  FUSE_X(CMPI),  FUSE_ANY(B_COND), (uopALU<ALUOp::CMP, true, true>),   (uopBCondAfterCmp<true>)) \
+    PAIR(MOV_MOV_W,     FUSE_W(MOV),   FUSE_W(MOV),      (uopMov<false>),    (uopMov<false>)) \
+    PAIR(MOV_MOV_X,     FUSE_X(MOV),   FUSE_X(MOV),      (uopMov<true>),     (uopMov<true>)) \
+    PAIR(MOVI_MOVI_W,   FUSE_W(MOVI),  FUSE_W(MOVI),     (uopMovImm<false>), (uopMovImm<false>)) \
+    PAIR(MOVI_MOVI_X,   FUSE_X(MOVI),  FUSE_X(MOVI),     (uopMovImm<true>),  (uopMovImm<true>)) \
+    TRIPLE(LDR_ADD_STR_W,  FUSE_W(LDRW), FUSE_W(ADD),  FUSE_W(STRW), (uopLoad<uint32_t, false>), (uopALU<ALUOp::ADD, false, false>), (uopStore<uint32_t, false>)) \
+    TRIPLE(LDR_ADDI_STR_W, FUSE_W(LDRW), FUSE_W(ADDI), FUSE_W(STRW), (uopLoad<uint32_t, false>), (uopALU<ALUOp::ADD, false, true>),  (uopStore<uint32_t, false>)) \
+    TRIPLE(LDR_ADD_STR_X,  FUSE_X(LDRD), FUSE_X(ADD),  FUSE_X(STRD), (uopLoad<uint64_t, true>),  (uopALU<ALUOp::ADD, true, false>),  (uopStore<uint64_t, true>)) \
+    TRIPLE(LDR_ADDI_STR_X, FUSE_X(LDRD), FUSE_X(ADDI), FUSE_X(STRD), (uopLoad<uint64_t, true>),  (uopALU<ALUOp::ADD, true, true>),   (uopStore<uint64_t, true>))
+
+static constexpr uint8_t FUSED_INDEX_BASE = 64;
+
+struct FusionInfo {
+    const char* name;
+    uint8_t length;
+    uint8_t ops[3];     // 匹配条件
+};
+
+#define TINY_FUSION_PAIR(NAME, A, B, H1, H2) FusionInfo{#NAME, 2, {A, B, 0}},
+#define TINY_FUSION_TRIPLE(NAME, A, B, C, H1, H2, H3) FusionInfo{#NAME, 3, {A, B, C}},
+inline constexpr FusionInfo FUSION_INFO[] = { TINY_FUSIONS(TINY_FUSION_PAIR, TINY_FUSION_TRIPLE) };
+#undef TINY_FUSION_TRIPLE
+#undef TINY_FUSION_PAIR
+
+inline constexpr size_t NUM_FUSIONS = sizeof(FUSION_INFO) / sizeof(FUSION_INFO[0]);
+static_assert(FUSED_INDEX_BASE + NUM_FUSIONS <= 256, "fused dispatch indices must fit in MicroOp::index");
+
+constexpr bool fusionSpecMatches(uint8_t spec, uint8_t index) {
+    return (spec & 0x80) ? (index & 0x1F) == (spec & 0x1F) : index == spec;
+}
+
+// 微操作原本的分派索引（融合序列首条的原索引即其匹配条件）
+constexpr uint8_t baseOpIndex(uint8_t index) {
+    return index < FUSED_INDEX_BASE ? index : FUSION_INFO[index - FUSED_INDEX_BASE].ops[0];
+}
+
+// 以 indices[0] 开始、最多 count 条指令可以组成的融合序列编号；长序列优先，无匹配时返回 -1
+inline int matchFusion(const uint8_t* indices, size_t count) {
+    int best = -1;
+    for (size_t k = 0; k < NUM_FUSIONS; ++k) {
+        const FusionInfo& info = FUSION_INFO[k];
+        if (info.length > count) continue;
+        if (best >= 0 && FUSION_INFO[best].length >= info.length) continue;
+        bool match = true;
+        for (uint8_t i = 0; i < info.length && match; ++i) {
+            match = fusionSpecMatches(info.ops[i], indices[i]);
+        }
+        if (match) best = static_cast<int>(k);
+    }
+    return best;
+}
+
+constexpr bool fusionHeadsExact() {
+    for (const FusionInfo& info : FUSION_INFO) {
+        if (info.ops[0] & 0x80) return false;
+        for (uint8_t i = 0; i + 1 < info.length; ++i) {
+            if (isBranchOpcode(info.ops[i] & 0x1F) || isStoreOpcode(info.ops[i] & 0x1F)) return false;
+        }
+    }
+    return true;
+}
+static_assert(fusionHeadsExact(), "fusion heads must match an exact width; only the last op may branch or store");
@@ -0,0 +1,987 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "CPUPolicies.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TINY_HAS_MMAP 1
+#define TINY_HAS_GUARDED_MEMORY 1
+#include <csetjmp>
+#include <csignal>
+#include <mutex>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+#define TINY_HAS_SHARED_REGION 1
+#endif
+
+// ========================== 客户机内存 ==========================
+// BasicCPU 按 Config::MEMORY 选择内存的存储方式（见 CPUPolicies.h），按 MemoryLayout 在运行时确定大小：
+//   FlatMemory   整块连续分配，地址即下标；JIT直接以宿主机指针访问
+//   PagedMemory  4级页表覆盖48位虚拟地址空间，4KB页在首次写入时分配，未写过的页读出为0
+//   GuardedMemory  mmap保留的连续内存，末尾与栈下方为不可访问的保护区；访存不检查边界，越界由SIGSEGV报告（仅POSIX）
+// 接口相同；前两者的边界检查由CPU在调用前完成，值按小端逐字节组装，与宿主机字节序无关。
+// 三者都按页记录写入：clear() 只清零写过的页，复位的开销与程序实际写过的内存成正比，而不是与内存大小成正比。
+// 只有 FlatMemory 可以被多个核共享（SHAREABLE，见 SMP.h），其原子访问使用宿主机原子指令
+
+static constexpr uint64_t GUEST_PAGE_SHIFT = 12;
+static constexpr uint64_t GUEST_PAGE_SIZE  = 1ULL << GUEST_PAGE_SHIFT;
+static constexpr uint64_t HUGE_PAGE_SIZE   = 2ULL << 20;
+
+// 客户机内存中一段连续字节的只读视图（不复制）
+class MemorySpan {
+public:
+    MemorySpan() = default;
+    MemorySpan(const uint8_t* bytes, size_t length) : bytes(bytes), length(length) {}
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    const uint8_t* begin() const { return bytes; }
+    const uint8_t* end() const { return bytes + length; }
+    uint8_t operator[](size_t i) const { return bytes[i]; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+};
+
+// ====================== 脏页记录 ======================
+// 每个客户机页一个标记字节：
+//   PAGE_WRITTEN  自上次清零以来写过；clear() 只清零这些页
+//   PAGE_CHANGED  自上次 clearChanged() 以来内容变化过（被写入或被清零），供增量同步、快照等使用者查询
+//   PAGE_PRIVATE  内容可能与写时复制的底层文件不同（见 HostRegion::fork）
+//   PAGE_UNPUBLISHED  变化尚未记入代数；publish(g) 把这些页的代数记为 g，观察者据此只读取某一代之后变化的页
+// 另有每64页一个字节的摘要，遍历时只查看摘要非0的组：512MB内存的摘要只有2KB，遍历开销与写过的页数成正比。
+// 写入只需两次字节存储（标记与摘要），JIT生成的存储指令也直接写这两张表
+
+static constexpr uint8_t PAGE_WRITTEN = 1;
+static constexpr uint8_t PAGE_CHANGED = 2;
+static constexpr uint8_t PAGE_PRIVATE = 4;
+static constexpr uint8_t PAGE_UNPUBLISHED = 8;
+static constexpr uint8_t PAGE_DIRTY   = PAGE_WRITTEN | PAGE_CHANGED | PAGE_PRIVATE | PAGE_UNPUBLISHED;  // 写入时置位的标记
+
+class DirtyMap {
+public:
+    static constexpr uint64_t GROUP_SHIFT = 6;  // 每组64页
+
+    void resize(uint64_t pages) {
+        flags.assign(pages, 0);
+        groups.assign((pages >> GROUP_SHIFT) + 1, 0);
+        generations.assign(pages, 0);
+        groupGenerations.assign(groups.size(), 0);
+    }
+
+    void mark(uint64_t pageIndex) {
+        flags[pageIndex] = PAGE_DIRTY;
+        groups[pageIndex >> GROUP_SHIFT] = 1;
+    }
+
+    // 标记 [address, address + size) 覆盖的各页
+    void markRange(uint64_t address, uint64_t size) {
+        for (uint64_t p = address >> GUEST_PAGE_SHIFT; p <= (address + size - 1) >> GUEST_PAGE_SHIFT; ++p) mark(p);
+    }
+
+    const uint8_t* data() const { return flags.data(); }
+    const uint8_t* groupData() const { return groups.data(); }
+
+    // 按页号升序对每个带 bit 标记的页调用 f(pageIndex)
+    template<typename F>
+    void forEach(uint8_t bit, F&& f) const {
+        for (size_t g = 0; g < groups.size(); ++g) {
+            if (groups[g] == 0) continue;
+            const size_t end = std::min(flags.size(), (g + 1) << GROUP_SHIFT);
+            for (size_t i = g << GROUP_SHIFT; i < end; ++i) {
+                if (flags[i] & bit) f(i);
+            }
+        }
+    }
+
+    // 对每个写过的页调用 zeroPage(pageIndex)，之后它们不再带 PAGE_WRITTEN
+    template<typename F>
+    void clearWritten(F&& zeroPage) {
+        forEach(PAGE_WRITTEN, [&](uint64_t pageIndex) {
+            zeroPage(pageIndex);
+            flags[pageIndex] = PAGE_CHANGED | PAGE_PRIVATE | PAGE_UNPUBLISHED;
+        });
+    }
+
+    std::vector<uint64_t> changedPages() const {
+        std::vector<uint64_t> pages;
+        forEach(PAGE_CHANGED, [&](uint64_t pageIndex) { pages.push_back(pageIndex); });
+        return pages;
+    }
+
+    void clearChanged() { clearBits(PAGE_CHANGED); }
+    void clearPrivate() { clearBits(PAGE_PRIVATE); }
+
+    // 把尚未记入代数的页的代数记为 generation
+    void publish(uint64_t generation) {
+        forEach(PAGE_UNPUBLISHED, [&](uint64_t pageIndex) {
+            generations[pageIndex] = generation;
+            groupGenerations[pageIndex >> GROUP_SHIFT] = generation;
+        });
+        clearBits(PAGE_UNPUBLISHED);
+    }
+
+    uint64_t generation(uint64_t pageIndex) const { return pageIndex < generations.size() ? generations[pageIndex] : 0; }
+
+    // 代数大于 generation 的页号（升序）
+    std::vector<uint64_t> changedSince(uint64_t generation) const {
+        std::vector<uint64_t> pages;
+        for (size_t g = 0; g < groupGenerations.size(); ++g) {
+            if (groupGenerations[g] <= generation) continue;
+            const size_t end = std::min(generations.size(), (g + 1) << GROUP_SHIFT);
+            for (size_t i = g << GROUP_SHIFT; i < end; ++i) {
+                if (generations[i] > generation) pages.push_back(i);
+            }
+        }
+        return pages;
+    }
+
+private:
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> groups;    // 组内是否有页带标记
+    std::vector<uint64_t> generations;       // 各页最近一次变化的代数
+    std::vector<uint64_t> groupGenerations;  // 组内的最大代数
+
+    // 不再有任何标记的组清除摘要
+    void clearBits(uint8_t bits) {
+        for (size_t g = 0; g < groups.size(); ++g) {
+            if (groups[g] == 0) continue;
+            const size_t end = std::min(flags.size(), (g + 1) << GROUP_SHIFT);
+            uint8_t any = 0;
+            for (size_t i = g << GROUP_SHIFT; i < end; ++i) {
+                flags[i] &= ~bits;
+                any |= flags[i];
+            }
+            groups[g] = any;
+        }
+    }
+};
+
+// ====================== 宿主机内存区域 ======================
+// 一段清零的宿主机内存，末尾可附带 guard 字节不可访问的保护区。
+// POSIX下以mmap分配：2MB及以上的区域按2MB对齐，按 HugePages 请求透明大页或 MAP_HUGETLB，
+// 客户机内存较大时宿主机TLB缺失不再占主导；其他平台以 new 分配，不支持保护区。
+// fork() 派生内容相同的区域：Linux下把区域转为 memfd 上的私有映射，父子共享物理页，首次写入时由内核复制
+
+class HostRegion {
+public:
+    HostRegion() = default;
+
+    HostRegion(uint64_t size, uint64_t guard, HugePages huge) : length(size), guard(guard), huge(huge) {
+#ifdef TINY_HAS_MMAP
+        const bool large = huge != HugePages::OFF && size >= HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+        if (large && huge == HugePages::EXPLICIT && guard == 0) {
+            uint64_t rounded = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+            void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                base = static_cast<uint8_t*>(p);
+                mapped = rounded;
+                hugetlb = true;
+                return;
+            }
+        }
+#endif
+        // 多保留2MB用于对齐，再把首尾多余的部分归还
+        const uint64_t slack = large ? HUGE_PAGE_SIZE : 0;
+        void* p = mmap(nullptr, size + guard + slack, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("Failed to reserve guest memory");
+        }
+        uint8_t* raw = static_cast<uint8_t*>(p);
+        base = large ? reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(raw) + slack - 1) & ~(slack - 1)) : raw;
+        mapped = size + guard;
+        if (base > raw) munmap(raw, base - raw);
+        if (raw + size + guard + slack > base + mapped) munmap(base + mapped, raw + size + guard + slack - (base + mapped));
+        if (size != 0 && mprotect(base, size, PROT_READ | PROT_WRITE) != 0) {
+            throw std::runtime_error("Failed to commit guest memory");
+        }
+        adviseHugePages();
+#else
+        if (guard != 0) {
+            throw std::runtime_error("Guard regions need mmap");
+        }
+        owned.reset(new uint8_t[size]());
+        base = owned.get();
+#endif
+    }
+
+    ~HostRegion() { release(); }
+
+    HostRegion(HostRegion&& other) noexcept { *this = std::move(other); }
+    HostRegion& operator=(HostRegion&& other) noexcept {
+        if (this != &other) {
+            release();
+            base = std::exchange(other.base, nullptr);
+            length = std::exchange(other.length, 0);
+            guard = std::exchange(other.guard, 0);
+            mapped = std::exchange(other.mapped, 0);
+            huge = other.huge;
+            hugetlb = other.hugetlb;
+            owned = std::move(other.owned);
+#ifdef TINY_HAS_SHARED_REGION
+            file = std::move(other.file);
+#endif
+        }
+        return *this;
+    }
+
+    uint8_t* data() const { return base; }
+    uint64_t size() const { return length; }
+    bool usesHugeTLB() const { return hugetlb; }
+
+    // 把文件 fd 从 fileOffset 开始的 size 字节私有映射到区域的 [offset, offset + size)，首次写入时由内核复制。
+    // 偏移须为页对齐；宿主机页不是4KB、区域使用 MAP_HUGETLB 或没有mmap时返回 false，由调用者改为复制
+    bool mapFileRange(int fd, uint64_t fileOffset, uint64_t offset, uint64_t size) {
+#ifdef TINY_HAS_MMAP
+        if (base == nullptr || hugetlb || sysconf(_SC_PAGESIZE) != static_cast<long>(GUEST_PAGE_SIZE)) return false;
+        return mmap(base + offset, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, static_cast<off_t>(fileOffset)) != MAP_FAILED;
+#else
+        return false;
+#endif
+    }
+
+    // 返回内容与本区域相同的新区域（保护区仍不可访问），之后双方的写入互不可见。
+    // 首次派生时把写过的页存入 memfd，本区域原地改为该文件的私有映射；此后派生的区域映射同一文件，
+    // 只需再复制带 PAGE_PRIVATE 的页（与文件内容不同的页）。dirty 为本区域的脏页记录，转换后清除其 PAGE_PRIVATE。
+    // 不支持时（非Linux或使用 MAP_HUGETLB）分配新区域并复制带 PAGE_PRIVATE 的页
+    HostRegion fork(DirtyMap& dirty) {
+        HostRegion child;
+#ifdef TINY_HAS_SHARED_REGION
+        if (!file && !hugetlb) shareThroughFile(dirty);
+        if (file) {
+            child.length = length;
+            child.guard = guard;
+            child.huge = huge;
+            child.file = file;
+            child.mapped = fileSize() + guard;
+            void* p = mmap(nullptr, child.mapped, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::runtime_error("Failed to reserve guest memory");
+            }
+            child.base = static_cast<uint8_t*>(p);
+            child.mapFile();
+        }
+#endif
+        if (child.base == nullptr) child = HostRegion(length, guard, huge);
+        dirty.forEach(PAGE_PRIVATE, [&](uint64_t pageIndex) {
+            uint64_t offset = pageIndex << GUEST_PAGE_SHIFT;
+            std::memcpy(child.base + offset, base + offset, std::min(GUEST_PAGE_SIZE, length - offset));
+        });
+        return child;
+    }
+
+private:
+    uint8_t* base = nullptr;
+    uint64_t length = 0;
+    uint64_t guard = 0;
+    uint64_t mapped = 0;                    // mmap的总长度（含保护区与大页取整）
+    HugePages huge = HugePages::OFF;
+    bool hugetlb = false;
+    std::unique_ptr<uint8_t[]> owned;       // 无mmap时的存储
+
+#ifdef TINY_HAS_SHARED_REGION
+    // 写时复制的底层文件，由派生出的各区域共享；文件创建后不再被写入
+    struct SharedFile {
+        int fd;
+        ~SharedFile() { close(fd); }
+    };
+    std::shared_ptr<SharedFile> file;
+
+    uint64_t fileSize() const { return (length + GUEST_PAGE_SIZE - 1) & ~(GUEST_PAGE_SIZE - 1); }
+
+    // 在 [base, base + fileSize()) 上建立文件的私有映射，替换原有映射
+    void mapFile() {
+        if (mmap(base, fileSize(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, file->fd, 0) == MAP_FAILED) {
+            throw std::runtime_error("Failed to map shared guest memory");
+        }
+    }
+
+    // 把写过的页存入新建的 memfd，再把本区域改为它的私有映射
+    void shareThroughFile(DirtyMap& dirty) {
+        int fd = memfd_create("tiny-guest", MFD_CLOEXEC);
+        if (fd < 0) return;
+        std::shared_ptr<SharedFile> created(new SharedFile{fd});
+        if (ftruncate(fd, static_cast<off_t>(fileSize())) != 0) return;
+        void* p = mmap(nullptr, fileSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return;
+        uint8_t* shared = static_cast<uint8_t*>(p);
+        dirty.forEach(PAGE_PRIVATE, [&](uint64_t pageIndex) {
+            uint64_t offset = pageIndex << GUEST_PAGE_SHIFT;
+            std::memcpy(shared + offset, base + offset, std::min(GUEST_PAGE_SIZE, length - offset));
+        });
+        munmap(shared, fileSize());
+        file = std::move(created);
+        mapFile();
+        dirty.clearPrivate();
+    }
+#endif
+
+    void adviseHugePages() {
+#if defined(TINY_HAS_MMAP) && defined(MADV_HUGEPAGE)
+        if (huge != HugePages::OFF && length >= HUGE_PAGE_SIZE) madvise(base, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    void release() {
+#ifdef TINY_HAS_MMAP
+        if (base != nullptr) munmap(base, mapped);
+#endif
+        base = nullptr;
+        owned.reset();
+#ifdef TINY_HAS_SHARED_REGION
+        file.reset();
+#endif
+    }
+};
+
+// ====================== 连续内存 ======================
+
+// 按 T 对齐的客户机内存就地作为 std::atomic<T> 访问（无锁的 std::atomic<T> 与 T 的大小和表示相同）；
+// 客户机为小端，这里要求宿主机也是小端（与快照格式相同）
+template<typename T>
+inline std::atomic<T>& hostAtomic(uint8_t* p) {
+    static_assert(sizeof(std::atomic<T>) == sizeof(T) && std::atomic<T>::is_always_lock_free,
+                  "guest atomics need lock-free host atomics of the same size");
+    return *reinterpret_cast<std::atomic<T>*>(p);
+}
+
+class FlatMemory {
+public:
+    static constexpr bool CONTIGUOUS = true;
+    static constexpr bool FAULTS_BY_SIGNAL = false;
+    static constexpr bool SHAREABLE = true;
+
+    // 按布局重新分配（内容清零）；padding 为末尾之后额外分配的字节（WRAP方式下跨越末尾的访问落在这里）
+    void configure(const MemoryLayout& layout, uint64_t padding) {
+        region = HostRegion(layout.memSize + padding, 0, layout.hugePages);
+        bytes = region.data();
+        capacity = region.size();
+        dirty.resize((capacity + GUEST_PAGE_SIZE - 1) >> GUEST_PAGE_SHIFT);
+    }
+
+    // 与 owner 共享同一块内存（多核），owner 须比本对象存活得久。脏页记录各自独立：
+    // 每个核只记录自己写过的页，各核都 clear() 之后整块内存才回到全0
+    void shareFrom(const FlatMemory& owner) {
+        region = HostRegion();
+        bytes = owner.bytes;
+        capacity = owner.capacity;
+        dirty.resize((capacity + GUEST_PAGE_SIZE - 1) >> GUEST_PAGE_SHIFT);
+    }
+
+    // 第 pageIndex 页的 GUEST_PAGE_SIZE 个字节
+    const uint8_t* readPage(uint64_t pageIndex) const { return bytes + (pageIndex << GUEST_PAGE_SHIFT); }
+
+    template<typename T>
+    T read(uint64_t address) const {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value |= static_cast<T>(bytes[address + i]) << (i * 8);
+        }
+        return value;
+    }
+
+    template<typename T>
+    void write(uint64_t address, T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            bytes[address + i] = (value >> (i * 8)) & 0xFF;
+        }
+        dirty.mark(address >> GUEST_PAGE_SHIFT);
+        dirty.mark((address + sizeof(T) - 1) >> GUEST_PAGE_SHIFT);
+    }
+
+    // 只清零写过的页
+    void clear() {
+        dirty.clearWritten([this](uint64_t pageIndex) {
+            uint64_t offset = pageIndex << GUEST_PAGE_SHIFT;
+            std::memset(bytes + offset, 0, std::min(GUEST_PAGE_SIZE, capacity - offset));
+        });
+    }
+
+    // 自上次 clearChanged() 以来内容变化过的页号（升序）
+    std::vector<uint64_t> changedPages() const { return dirty.changedPages(); }
+    void clearChanged() { dirty.clearChanged(); }
+
+    // 复制 [address, address + size) 到 out；调用者保证范围有效
+    void copyOut(uint64_t address, uint8_t* out, size_t size) const { std::memcpy(out, bytes + address, size); }
+
+    // 复制 in 到 [address, address + size) 并记录脏页；调用者保证范围有效
+    void copyIn(uint64_t address, const uint8_t* in, size_t size) {
+        if (size == 0) return;
+        std::memcpy(bytes + address, in, size);
+        dirty.markRange(address, size);
+    }
+
+    // 批量内存指令：内存内部复制（区间可以重叠）与填充，记录脏页；调用者保证范围有效
+    void move(uint64_t to, uint64_t from, size_t size) {
+        if (size == 0) return;
+        std::memmove(bytes + to, bytes + from, size);
+        dirty.markRange(to, size);
+    }
+    void fill(uint64_t address, uint8_t value, size_t size) {
+        if (size == 0) return;
+        std::memset(bytes + address, value, size);
+        dirty.markRange(address, size);
+    }
+
+    // 把文件中 fileOffset 开始的 count 页私有映射到第 pageIndex 页起（见 HostRegion::mapFileRange）
+    bool mapPages(int fd, uint64_t fileOffset, uint64_t pageIndex, uint64_t count) {
+        if (!region.mapFileRange(fd, fileOffset, pageIndex << GUEST_PAGE_SHIFT, count << GUEST_PAGE_SHIFT)) return false;
+        dirty.markRange(pageIndex << GUEST_PAGE_SHIFT, count << GUEST_PAGE_SHIFT);
+        return true;
+    }
+
+    // 按页号升序对可能非0的页调用 f(pageIndex)；其余页一定为0
+    template<typename F>
+    void forEachWrittenPage(F&& f) const { dirty.forEach(PAGE_WRITTEN, f); }
+
+    // 页的变化代数（见 DirtyMap::publish）
+    void publish(uint64_t generation) { dirty.publish(generation); }
+    uint64_t pageGeneration(uint64_t pageIndex) const { return dirty.generation(pageIndex); }
+    std::vector<uint64_t> pagesChangedSince(uint64_t generation) const { return dirty.changedSince(generation); }
+
+    // 成为 parent 的写时复制副本（见 HostRegion::fork）
+    void forkFrom(FlatMemory& parent) {
+        region = parent.region.fork(parent.dirty);
+        bytes = region.data();
+        capacity = parent.capacity;
+        dirty = parent.dirty;
+    }
+
+    // 原子访问：address 按 sizeof(T) 对齐，均为顺序一致
+    template<typename T>
+    T atomicLoad(uint64_t address) const {
+        return hostAtomic<T>(bytes + address).load();
+    }
+    // 内容等于 expected 时写入 desired 并返回true，否则把当前内容写入 expected
+    template<typename T>
+    bool compareExchange(uint64_t address, T& expected, T desired) {
+        if (!hostAtomic<T>(bytes + address).compare_exchange_strong(expected, desired)) return false;
+        dirty.mark(address >> GUEST_PAGE_SHIFT);
+        return true;
+    }
+    template<typename T>
+    T fetchAdd(uint64_t address, T value) {
+        dirty.mark(address >> GUEST_PAGE_SHIFT);
+        return hostAtomic<T>(bytes + address).fetch_add(value);
+    }
+
+    uint8_t* data() { return bytes; }
+    const uint8_t* data() const { return bytes; }
+
+    // JIT生成的存储指令直接写入脏页标记与摘要
+    const DirtyMap& dirtyMap() const { return dirty; }
+
+private:
+    HostRegion region;          // 共享其他内存时为空
+    uint8_t* bytes = nullptr;
+    uint64_t capacity = 0;      // 含填充字节
+    DirtyMap dirty;
+};
+
+// ====================== 稀疏分页内存 ======================
+// 地址空间按AArch64的48位虚拟地址取舍，不覆盖完整的64位：更宽的地址要再加页表级数，而客户机只用到
+// memSize 之内的地址（CPU::setMemoryLayout 拒绝超过 2^ADDRESS_BITS 的内存大小）。
+// 虚拟页号 [35:0] 分为4级、每级9位，与AArch64的4KB粒度页表相同；中间级页表与数据页都在首次写入时分配。
+// 读写各缓存最近一次访问的页：顺序访问与栈访问几乎总是命中，不必遍历页表。
+// 脏页标记按数据页的存储序号保存，写缓存未命中时置位；清除标记的同时作废写缓存，之后的写入重新置位。
+// clear() 清零写过的页但保留分配，反复运行同一程序时不再重复分配页。
+// 数据页以引用计数共享：forkFrom() 只复制页表，被多个内存共享的页在写入前复制
+
+class PagedMemory {
+public:
+    static constexpr bool CONTIGUOUS = false;
+    static constexpr bool FAULTS_BY_SIGNAL = false;
+    static constexpr bool SHAREABLE = false;
+    static constexpr uint32_t ADDRESS_BITS = 48;    // AArch64 的48位虚拟地址
+    static constexpr uint32_t LEVEL_BITS = 9;
+    static constexpr uint32_t LEVELS = (ADDRESS_BITS - GUEST_PAGE_SHIFT) / LEVEL_BITS;
+    static constexpr uint64_t ENTRIES = 1ULL << LEVEL_BITS;
+
+    static_assert(GUEST_PAGE_SHIFT + LEVELS * LEVEL_BITS == ADDRESS_BITS, "page table levels must cover the address space");
+
+    PagedMemory() = default;
+    PagedMemory(const PagedMemory&) = delete;
+    PagedMemory& operator=(const PagedMemory&) = delete;
+
+    // 未写过的页返回全0的共享页，不分配
+    const uint8_t* readPage(uint64_t pageIndex) const {
+        if (pageIndex != readTag) {
+            Frame* frame = findPage(pageIndex);
+            readTag = pageIndex;
+            readBytes = frame ? frame->bytes.data() : ZERO_PAGE.data();
+        }
+        return readBytes;
+    }
+
+    // 必要时分配该页及其上各级页表
+    uint8_t* writePage(uint64_t pageIndex) {
+        if (pageIndex != writeTag) {
+            Frame* frame = allocatePage(pageIndex);
+            pageFlags[frame->storageIndex] = PAGE_DIRTY;
+            writeBytes = frame->bytes.data();
+            writeTag = pageIndex;
+            if (readTag == pageIndex) readBytes = writeBytes;   // 原先读到的可能是共享零页
+        }
+        return writeBytes;
+    }
+
+    template<typename T>
+    T read(uint64_t address) const {
+        uint64_t offset = address & (GUEST_PAGE_SIZE - 1);
+        T value = 0;
+        if (offset <= GUEST_PAGE_SIZE - sizeof(T)) {
+            const uint8_t* p = readPage(address >> GUEST_PAGE_SHIFT) + offset;
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                value |= static_cast<T>(p[i]) << (i * 8);
+            }
+        } else {    // 跨页
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                value |= static_cast<T>(read<uint8_t>(address + i)) << (i * 8);
+            }
+        }
+        return value;
+    }
+
+    template<typename T>
+    void write(uint64_t address, T value) {
+        uint64_t offset = address & (GUEST_PAGE_SIZE - 1);
+        if (offset <= GUEST_PAGE_SIZE - sizeof(T)) {
+            uint8_t* p = writePage(address >> GUEST_PAGE_SHIFT) + offset;
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                p[i] = (value >> (i * 8)) & 0xFF;
+            }
+        } else {
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                write<uint8_t>(address + i, static_cast<uint8_t>(value >> (i * 8)));
+            }
+        }
+    }
+
+    void copyOut(uint64_t address, uint8_t* out, size_t size) const {
+        while (size != 0) {
+            uint64_t offset = address & (GUEST_PAGE_SIZE - 1);
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, GUEST_PAGE_SIZE - offset));
+            std::memcpy(out, readPage(address >> GUEST_PAGE_SHIFT) + offset, chunk);
+            address += chunk;
+            out += chunk;
+            size -= chunk;
+        }
+    }
+
+    void copyIn(uint64_t address, const uint8_t* in, size_t size) {
+        while (size != 0) {
+            uint64_t offset = address & (GUEST_PAGE_SIZE - 1);
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, GUEST_PAGE_SIZE - offset));
+            std::memcpy(writePage(address >> GUEST_PAGE_SHIFT) + offset, in, chunk);
+            address += chunk;
+            in += chunk;
+            size -= chunk;
+        }
+    }
+
+    // 页不连续：经临时缓冲复制，重叠的区间同样正确
+    void move(uint64_t to, uint64_t from, size_t size) {
+        std::vector<uint8_t> buffer(size);
+        copyOut(from, buffer.data(), size);
+        copyIn(to, buffer.data(), size);
+    }
+    void fill(uint64_t address, uint8_t value, size_t size) {
+        while (size != 0) {
+            uint64_t offset = address & (GUEST_PAGE_SIZE - 1);
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, GUEST_PAGE_SIZE - offset));
+            std::memset(writePage(address >> GUEST_PAGE_SHIFT) + offset, value, chunk);
+            address += chunk;
+            size -= chunk;
+        }
+    }
+
+    template<typename F>
+    void forEachWrittenPage(F&& f) const {
+        std::vector<uint64_t> pages;
+        for (size_t i = 0; i < pageStorage.size(); ++i) {
+            if (pageFlags[i] & PAGE_WRITTEN) pages.push_back(pageStorage[i]->index);
+        }
+        std::sort(pages.begin(), pages.end());
+        for (uint64_t pageIndex : pages) f(pageIndex);
+    }
+
+    // 地址空间由CPU限定在 memSize 之内；padding 无需分配，跨越末尾的访问按页逐字节处理
+    void configure(const MemoryLayout& /*layout*/, uint64_t /*padding*/) { release(); }
+
+    // 只清零写过的页，地址空间恢复为全0；共享的页换成新的零页
+    void clear() {
+        for (size_t i = 0; i < pageStorage.size(); ++i) {
+            if (!(pageFlags[i] & PAGE_WRITTEN)) continue;
+            if (pageStorage[i].use_count() > 1) {
+                replaceFrame(i, std::make_shared<Frame>());
+            } else {
+                pageStorage[i]->bytes.fill(0);
+            }
+            pageFlags[i] = PAGE_CHANGED | PAGE_UNPUBLISHED;
+        }
+        readTag = writeTag = NO_PAGE;
+    }
+
+    std::vector<uint64_t> changedPages() const {
+        std::vector<uint64_t> pages;
+        for (size_t i = 0; i < pageStorage.size(); ++i) {
+            if (pageFlags[i] & PAGE_CHANGED) pages.push_back(pageStorage[i]->index);
+        }
+        std::sort(pages.begin(), pages.end());
+        return pages;
+    }
+
+    void clearChanged() {
+        for (uint8_t& f : pageFlags) f &= ~PAGE_CHANGED;
+        writeTag = NO_PAGE;
+    }
+
+    void publish(uint64_t generation) {
+        for (size_t i = 0; i < pageStorage.size(); ++i) {
+            if (pageFlags[i] & PAGE_UNPUBLISHED) {
+                pageFlags[i] &= ~PAGE_UNPUBLISHED;
+                pageGenerations[i] = generation;
+            }
+        }
+        writeTag = NO_PAGE;
+    }
+
+    uint64_t pageGeneration(uint64_t pageIndex) const {
+        const Frame* frame = findPage(pageIndex);
+        return frame ? pageGenerations[frame->storageIndex] : 0;
+    }
+
+    std::vector<uint64_t> pagesChangedSince(uint64_t generation) const {
+        std::vector<uint64_t> pages;
+        for (size_t i = 0; i < pageStorage.size(); ++i) {
+            if (pageGenerations[i] > generation) pages.push_back(pageStorage[i]->index);
+        }
+        std::sort(pages.begin(), pages.end());
+        return pages;
+    }
+
+    // 成为 parent 的写时复制副本：复制页表与脏页标记，数据页由双方共享
+    void forkFrom(PagedMemory& parent) {
+        release();
+        pageStorage = parent.pageStorage;
+        pageFlags = parent.pageFlags;
+        pageGenerations = parent.pageGenerations;
+        copyTables(root, parent.root, LEVELS - 1);
+        parent.writeTag = NO_PAGE;      // 父内存缓存的写入页此后被共享，下一次写入需要重新检查
+    }
+
+    // 已分配的数据页数
+    size_t allocatedPages() const { return pageStorage.size(); }
+
+private:
+    struct Table {
+        std::array<void*, ENTRIES> entries{};   // 下一级页表或数据页
+    };
+    struct Frame {
+        std::array<uint8_t, GUEST_PAGE_SIZE> bytes{};
+        uint64_t index = 0;         // 虚拟页号
+        uint64_t storageIndex = 0;  // 在 pageStorage 中的位置；派生的内存复制 pageStorage，位置相同
+    };
+
+    static constexpr uint64_t NO_PAGE = ~0ULL;
+    static inline const std::array<uint8_t, GUEST_PAGE_SIZE> ZERO_PAGE{};
+
+    Table root;
+    std::vector<std::unique_ptr<Table>> tableStorage;
+    std::vector<std::shared_ptr<Frame>> pageStorage;
+    std::vector<uint8_t> pageFlags;     // 与 pageStorage 对应的脏页标记
+    std::vector<uint64_t> pageGenerations;  // 与 pageStorage 对应的变化代数
+
+    // 最近访问的页（readBytes 可能指向 ZERO_PAGE）
+    mutable uint64_t readTag = NO_PAGE;
+    mutable const uint8_t* readBytes = nullptr;
+    uint64_t writeTag = NO_PAGE;
+    uint8_t* writeBytes = nullptr;
+
+    static uint64_t slot(uint64_t pageIndex, uint32_t level) {
+        return (pageIndex >> (level * LEVEL_BITS)) & (ENTRIES - 1);
+    }
+
+    // 释放全部页与页表
+    void release() {
+        root = Table{};
+        tableStorage.clear();
+        pageStorage.clear();
+        pageFlags.clear();
+        pageGenerations.clear();
+        readTag = writeTag = NO_PAGE;
+    }
+
+    void copyTables(Table& dst, const Table& src, uint32_t level) {
+        for (uint64_t i = 0; i < ENTRIES; ++i) {
+            if (level == 0 || src.entries[i] == nullptr) {
+                dst.entries[i] = src.entries[i];
+                continue;
+            }
+            tableStorage.push_back(std::make_unique<Table>());
+            Table* table = tableStorage.back().get();
+            dst.entries[i] = table;
+            copyTables(*table, *static_cast<const Table*>(src.entries[i]), level - 1);
+        }
+    }
+
+    // 以 frame 替换第 storageIndex 个数据页（页号不变），返回新页
+    Frame* replaceFrame(uint64_t storageIndex, std::shared_ptr<Frame> frame) {
+        frame->index = pageStorage[storageIndex]->index;
+        frame->storageIndex = storageIndex;
+        Table* table = &root;
+        for (uint32_t level = LEVELS - 1; level > 0; --level) {
+            table = static_cast<Table*>(table->entries[slot(frame->index, level)]);
+        }
+        table->entries[slot(frame->index, 0)] = frame.get();
+        pageStorage[storageIndex] = std::move(frame);
+        return pageStorage[storageIndex].get();
+    }
+
+    Frame* findPage(uint64_t pageIndex) const {
+        const Table* table = &root;
+        for (uint32_t level = LEVELS - 1; level > 0; --level) {
+            table = static_cast<const Table*>(table->entries[slot(pageIndex, level)]);
+            if (table == nullptr) return nullptr;
+        }
+        return static_cast<Frame*>(table->entries[slot(pageIndex, 0)]);
+    }
+
+    Frame* allocatePage(uint64_t pageIndex) {
+        Table* table = &root;
+        for (uint32_t level = LEVELS - 1; level > 0; --level) {
+            void*& entry = table->entries[slot(pageIndex, level)];
+            if (entry == nullptr) {
+                tableStorage.push_back(std::make_unique<Table>());
+                entry = tableStorage.back().get();
+            }
+            table = static_cast<Table*>(entry);
+        }
+        void*& entry = table->entries[slot(pageIndex, 0)];
+        if (entry == nullptr) {
+            pageStorage.push_back(std::make_shared<Frame>());   // 值初始化为0
+            pageStorage.back()->index = pageIndex;
+            pageStorage.back()->storageIndex = pageStorage.size() - 1;
+            pageFlags.push_back(0);
+            pageGenerations.push_back(0);
+            entry = pageStorage.back().get();
+        }
+        Frame* frame = static_cast<Frame*>(entry);
+        if (pageStorage[frame->storageIndex].use_count() > 1) {    // 与派生的内存共享：写入前复制
+            frame = replaceFrame(frame->storageIndex, std::make_shared<Frame>(*frame));
+        }
+        return frame;
+    }
+};
+
+// ====================== 保护页内存 ======================
+// 客户机内存 [0, size) 之后紧接 GUARD_SIZE 字节的保护区，栈底之下另有 stackGuard 字节的保护区。
+// 访问时地址钳制到 size，越界的访问一律落在保护区，由 SIGSEGV/SIGBUS 处理函数跳回 guard() 的调用处。
+// 访存前的信号栅栏保证出错时PC、寄存器与步数已写回内存，调用者据此重新计算出错的地址
+
+#ifdef TINY_HAS_GUARDED_MEMORY
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "GuardedMemory accesses guest memory with host loads");
+
+class GuardedMemory {
+public:
+    static constexpr bool CONTIGUOUS = true;
+    static constexpr bool FAULTS_BY_SIGNAL = true;
+    static constexpr bool SHAREABLE = false;
+    static constexpr uint64_t GUARD_SIZE = 0x10000;     // 64KB：任何宿主机页大小的整数倍
+
+    GuardedMemory() { installHandler(); }
+
+    GuardedMemory(const GuardedMemory&) = delete;
+    GuardedMemory& operator=(const GuardedMemory&) = delete;
+
+    // 按布局重新保留（内容清零）；大小与栈保护区须为64KB对齐
+    void configure(const MemoryLayout& layout, uint64_t /*padding*/) {
+        if (layout.memSize % GUARD_SIZE != 0 || layout.stackLimit % GUARD_SIZE != 0 || layout.stackGuard % GUARD_SIZE != 0 ||
+            layout.stackGuard > layout.stackLimit) {
+            throw std::runtime_error("Guarded memory layout must be 64KB aligned");
+        }
+        region = HostRegion(layout.memSize, GUARD_SIZE, layout.hugePages);
+        base = region.data();
+        size = layout.memSize;
+        guardBegin = layout.stackLimit - layout.stackGuard;
+        guardEnd = layout.stackLimit;
+        dirty.resize(size >> GUEST_PAGE_SHIFT);
+        protectStackGuard();
+    }
+
+    // [address, address + n) 是否可以访问
+    bool accessible(uint64_t address, size_t n) const {
+        return address <= size && n <= size - address && (address + n <= guardBegin || address >= guardEnd);
+    }
+
+    const uint8_t* readPage(uint64_t pageIndex) const { return base + (pageIndex << GUEST_PAGE_SHIFT); }
+
+    template<typename T>
+    T read(uint64_t address) const {
+        T value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        std::memcpy(&value, base + std::min(address, size), sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void write(uint64_t address, T value) {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        std::memcpy(base + std::min(address, size), &value, sizeof(T));
+        // 出错的写入不会到达这里：被标记的页都在保护区之外
+        dirty.mark(address >> GUEST_PAGE_SHIFT);
+        dirty.mark((address + sizeof(T) - 1) >> GUEST_PAGE_SHIFT);
+    }
+
+    // 只清零写过的页
+    void clear() {
+        dirty.clearWritten([this](uint64_t pageIndex) {
+            std::memset(base + (pageIndex << GUEST_PAGE_SHIFT), 0, GUEST_PAGE_SIZE);
+        });
+    }
+
+    std::vector<uint64_t> changedPages() const { return dirty.changedPages(); }
+    void clearChanged() { dirty.clearChanged(); }
+
+    // 调用者保证范围可以访问
+    void copyIn(uint64_t address, const uint8_t* in, size_t n) {
+        if (n == 0) return;
+        std::memcpy(base + address, in, n);
+        dirty.markRange(address, n);
+    }
+    void move(uint64_t to, uint64_t from, size_t n) {
+        if (n == 0) return;
+        std::memmove(base + to, base + from, n);
+        dirty.markRange(to, n);
+    }
+    void fill(uint64_t address, uint8_t value, size_t n) {
+        if (n == 0) return;
+        std::memset(base + address, value, n);
+        dirty.markRange(address, n);
+    }
+
+    bool mapPages(int fd, uint64_t fileOffset, uint64_t pageIndex, uint64_t count) {
+        if (!accessible(pageIndex << GUEST_PAGE_SHIFT, count << GUEST_PAGE_SHIFT)) return false;
+        if (!region.mapFileRange(fd, fileOffset, pageIndex << GUEST_PAGE_SHIFT, count << GUEST_PAGE_SHIFT)) return false;
+        dirty.markRange(pageIndex << GUEST_PAGE_SHIFT, count << GUEST_PAGE_SHIFT);
+        return true;
+    }
+
+    template<typename F>
+    void forEachWrittenPage(F&& f) const { dirty.forEach(PAGE_WRITTEN, f); }
+
+    void publish(uint64_t generation) { dirty.publish(generation); }
+    uint64_t pageGeneration(uint64_t pageIndex) const { return dirty.generation(pageIndex); }
+    std::vector<uint64_t> pagesChangedSince(uint64_t generation) const { return dirty.changedSince(generation); }
+
+    // 成为 parent 的写时复制副本（见 HostRegion::fork）；重新映射后双方的栈保护区都需要重新设置
+    void forkFrom(GuardedMemory& parent) {
+        region = parent.region.fork(parent.dirty);
+        base = region.data();
+        size = parent.size;
+        guardBegin = parent.guardBegin;
+        guardEnd = parent.guardEnd;
+        dirty = parent.dirty;
+        parent.protectStackGuard();
+        protectStackGuard();
+    }
+
+    // 保护区内的字节读出为0
+    void copyOut(uint64_t address, uint8_t* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = accessible(address + i, 1) ? base[address + i] : 0;
+        }
+    }
+
+    uint8_t* data() { return base; }
+    const uint8_t* data() const { return base; }
+
+    // 执行 body；其间访问保护区时放弃 body 的剩余部分，改为返回 onFault() 的结果。
+    // body 中不得有需要析构的局部对象跨越访存（被跳过的栈帧不会析构）
+    template<typename Body, typename OnFault>
+    auto guard(Body&& body, OnFault&& onFault) -> decltype(body()) {
+        Recovery recovery{{}, base, base + size + GUARD_SIZE, activeRecovery};
+        if (sigsetjmp(recovery.env, 0) != 0) {
+            activeRecovery = recovery.previous;
+            return onFault();
+        }
+        activeRecovery = &recovery;
+        auto result = body();
+        activeRecovery = recovery.previous;
+        return result;
+    }
+
+private:
+    HostRegion region;
+    uint8_t* base = nullptr;
+    uint64_t size = 0;
+    uint64_t guardBegin = 0;    // 栈保护区
+    uint64_t guardEnd = 0;
+    DirtyMap dirty;
+
+    void protectStackGuard() {
+        if (guardEnd > guardBegin) mprotect(base + guardBegin, guardEnd - guardBegin, PROT_NONE);
+    }
+
+    // 当前线程正在执行的 guard() 调用，嵌套时串成链
+    struct Recovery {
+        sigjmp_buf env;
+        const uint8_t* begin;   // 该内存的保留范围
+        const uint8_t* end;
+        Recovery* previous;
+    };
+    static inline thread_local Recovery* activeRecovery = nullptr;
+    static inline struct sigaction previousSegv{};
+    static inline struct sigaction previousBus{};
+
+    static void handleFault(int sig, siginfo_t* info, void* /*context*/) {
+        const uint8_t* address = static_cast<const uint8_t*>(info->si_addr);
+        for (Recovery* r = activeRecovery; r != nullptr; r = r->previous) {
+            if (address >= r->begin && address < r->end) {
+                siglongjmp(r->env, 1);
+            }
+        }
+        // 不是客户机内存：恢复原处理方式，返回后重新执行出错的指令
+        sigaction(sig, sig == SIGSEGV ? &previousSegv : &previousBus, nullptr);
+    }
+
+    // SA_NODEFER：跳出处理函数时信号不会保持屏蔽，sigsetjmp 不必保存信号掩码
+    static void installHandler() {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            struct sigaction action{};
+            action.sa_sigaction = handleFault;
+            action.sa_flags = SA_SIGINFO | SA_NODEFER;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGSEGV, &action, &previousSegv);
+            sigaction(SIGBUS, &action, &previousBus);
+        });
+    }
+};
+
+#endif
+
+// ====================== 按配置选择 ======================
+
+template<MemoryModel Model> struct GuestMemoryFor { using type = FlatMemory; };
+template<> struct GuestMemoryFor<MemoryModel::PAGED> { using type = PagedMemory; };
+#ifdef TINY_HAS_GUARDED_MEMORY
+template<> struct GuestMemoryFor<MemoryModel::GUARDED> { using type = GuardedMemory; };
+#endif
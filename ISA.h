@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+// ========================== 指令集描述 ==========================
+// 指令集只在这里描述一次：操作码、助记符、操作数格式、属性与执行函数。
+// Opcode 枚举、预译码的执行函数表、线程化解释器的跳转表、基本块的终结/存储判断、
+// 汇编器与反汇编器都由下面的表在编译期生成，新增指令只需加一行并实现执行函数。
+//
+// 编码：sf[31] | opcode[30:26] | rd[25:21] | rn[20:16] | rm[4:0] / imm16[15:0]
+//   - B.cond 的条件码位于 [25:22]，分支偏移为 imm16 条指令（相对下一条指令）
+//   - opcode = OP_SYS 的系统指令由 [15:8] 的子操作码区分，见 TINY_SYSTEM_ISA
+
+// 操作数格式
+enum class InstrFormat : uint8_t {
+    RRR,        // Rd, Rn, Rm
+    RRI,        // Rd, Rn, #imm16
+    RR,         // Rd, Rn
+    RI,         // Rd, #imm16
+    CMP_RR,     // Rn, Rm        （Rn 位于 [25:21]，Rm 位于 [20:16]）
+    CMP_RI,     // Rn, #imm16    （Rn 位于 [25:21]）
+    MEM,        // Rt, [Rn, #simm16]
+    LABEL,      // label
+    COND_LABEL, // B.<cond> label
+    REG,        // Xn            （位于 [25:21]）
+    NONE,       // 无操作数
+    SYS,        // 系统指令，操作数由子操作码决定（见 TINY_SYSTEM_ISA）
+    CPY,        // [Xd]!, [Xs]!, Xn!  系统指令的三个寄存器：Xd [25:21]、Xs [20:16]、Xn [4:0]
+    SET,        // [Xd]!, Xn!, Xs     Xd [25:21]、Xn [20:16]、Xs [4:0]
+    LDX,        // Rt, [Xn]           Rt [25:21]、Xn [20:16]，sf 为 Rt 的位宽
+    STX,        // Ws, Rt, [Xn]       Ws [25:21]、Rt [20:16]、Xn [4:0]，sf 为 Rt 的位宽
+    RMW,        // Rs, Rt, [Xn]       Rs [25:21]、Rt [20:16]、Xn [4:0]，Rs 与 Rt 位宽相同
+    MRS         // Xd, <sysreg>       Xd [25:21]，系统寄存器编号位于 [4:0]
+};
+
+// 指令属性
+enum InstrFlag : uint8_t {
+    IF_BRANCH = 1 << 0,   // 改变控制流，结束基本块
+    IF_DIRECT = 1 << 1,   // 跳转目标在译码时已知，后继块可以链接
+    IF_LOAD   = 1 << 2,
+    IF_STORE  = 1 << 3,
+    IF_FLAGS  = 1 << 4,   // 设置NZCV
+    IF_FAULT  = 1 << 5,   // 可能出错停止（访存越界、除零）
+};
+
+// 汇编时对 Rd/Rt 位宽的要求（LDR/STR 按寄存器位宽选择字/双字版本）
+enum class InstrWidth : uint8_t {
+    ANY,
+    W,
+    X
+};
+
+// ENTRY(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER)
+// 按操作码顺序排列；HANDLER 中的 X64 由使用者代入 false / true（W / X 寄存器版本）
+#define TINY_ISA(ENTRY, X64) \
+    ENTRY(ADD,    0b00000, "ADD",  RRR,        ANY, IF_FLAGS,                (uopALU<ALUOp::ADD, X64, false>)) \
+    ENTRY(ADDI,   0b00001, "ADD",  RRI,        ANY, IF_FLAGS,                (uopALU<ALUOp::ADD, X64, true>)) \
+    ENTRY(SUB,    0b00010, "SUB",  RRR,        ANY, IF_FLAGS,                (uopALU<ALUOp::SUB, X64, false>)) \
+    ENTRY(SUBI,   0b00011, "SUB",  RRI,        ANY, IF_FLAGS,                (uopALU<ALUOp::SUB, X64, true>)) \
+    ENTRY(AND,    0b00100, "AND",  RRR,        ANY, IF_FLAGS,                (uopALU<ALUOp::AND, X64, false>)) \
+    ENTRY(ANDI,   0b00101, "AND",  RRI,        ANY, IF_FLAGS,                (uopALU<ALUOp::AND, X64, true>)) \
+    ENTRY(ORR,    0b00110, "ORR",  RRR,        ANY, IF_FLAGS,                (uopALU<ALUOp::ORR, X64, false>)) \
+    ENTRY(ORRI,   0b00111, "ORR",  RRI,        ANY, IF_FLAGS,                (uopALU<ALUOp::ORR, X64, true>)) \
+    ENTRY(EOR,    0b01000, "EOR",  RRR,        ANY, IF_FLAGS,                (uopALU<ALUOp::EOR, X64, false>)) \
+    ENTRY(EORI,   0b01001, "EOR",  RRI,        ANY, IF_FLAGS,                (uopALU<ALUOp::EOR, X64, true>)) \
+    ENTRY(MOV,    0b01010, "MOV",  RR,         ANY, 0,                       (uopMov<X64>)) \
+    ENTRY(MOVI,   0b01011, "MOV",  RI,         ANY, 0,                       (uopMovImm<X64>)) \
+    ENTRY(CMP,    0b01100, "CMP",  CMP_RR,     ANY, IF_FLAGS,                (uopALU<ALUOp::CMP, X64, false>)) \
+    ENTRY(CMPI,   0b01101, "CMP",  CMP_RI,     ANY, IF_FLAGS,                (uopALU<ALUOp::CMP, X64, true>)) \
+    ENTRY(MUL,    0b01110, "MUL",  RRR,        ANY, IF_FLAGS,                (uopALU<ALUOp::MUL, X64, false>)) \
+    ENTRY(SDIV,   0b01111, "SDIV", RRR,        ANY, IF_FLAGS | IF_FAULT,     (uopALU<ALUOp::SDIV, X64, false>)) \
+    ENTRY(UDIV,   0b10000, "UDIV", RRR,        ANY, IF_FLAGS | IF_FAULT,     (uopALU<ALUOp::UDIV, X64, false>)) \
+    ENTRY(LDRB,   0b10001, "LDRB", MEM,        ANY, IF_LOAD | IF_FAULT,      (uopLoad<uint8_t, X64>)) \
+    ENTRY(LDRH,   0b10010, "LDRH", MEM,        ANY, IF_LOAD | IF_FAULT,      (uopLoad<uint16_t, X64>)) \
+    ENTRY(LDRW,   0b10011, "LDR",  MEM,        W,   IF_LOAD | IF_FAULT,      (uopLoad<uint32_t, X64>)) \
+    ENTRY(LDRD,   0b10100, "LDR",  MEM,        X,   IF_LOAD | IF_FAULT,      (uopLoad<uint64_t, X64>)) \
+    ENTRY(STRB,   0b10101, "STRB", MEM,        ANY, IF_STORE | IF_FAULT,     (uopStore<uint8_t, X64>)) \
+    ENTRY(STRH,   0b10110, "STRH", MEM,        ANY, IF_STORE | IF_FAULT,     (uopStore<uint16_t, X64>)) \
+    ENTRY(STRW,   0b10111, "STR",  MEM,        W,   IF_STORE | IF_FAULT,     (uopStore<uint32_t, X64>)) \
+    ENTRY(STRD,   0b11000, "STR",  MEM,        X,   IF_STORE | IF_FAULT,     (uopStore<uint64_t, X64>)) \
+    ENTRY(B,      0b11001, "B",    LABEL,      ANY, IF_BRANCH | IF_DIRECT,   (uopB)) \
+    ENTRY(B_COND, 0b11010, "B.",   COND_LABEL, ANY, IF_BRANCH | IF_DIRECT,   (uopBCond)) \
+    ENTRY(BL,     0b11011, "BL",   LABEL,      ANY, IF_BRANCH | IF_DIRECT,   (uopBL)) \
+    ENTRY(BLR,    0b11100, "BLR",  REG,        ANY, IF_BRANCH,               (uopBLR)) \
+    ENTRY(BR,     0b11101, "BR",   REG,        ANY, IF_BRANCH,               (uopBR)) \
+    ENTRY(RET,    0b11110, "RET",  NONE,       ANY, IF_BRANCH,               (uopRet)) \
+    ENTRY(SYS,    0b11111, "",     SYS,        ANY, IF_BRANCH,               (uopSystem))
+
+// 系统指令：ENTRY(NAME, SUBOP, MNEMONIC, FORMAT, HANDLER)
+// 未列出的子操作码按HLT执行（与旧编码兼容：操作码为全1的字一律停机）
+// CPY*/SET* 为仿照 Armv8.8 MOPS 的批量复制/填充，三条一组使用，见 MicroOpHandlers.h
+// LDXR/STXR/LDADD/CAS/DMB 为多核同步指令（原子操作均为顺序一致），MRS 读取系统寄存器（见 SMP.h）
+#define TINY_SYSTEM_ISA(ENTRY) \
+    ENTRY(HLT,   0x00, "HLT",   NONE, (uopHlt)) \
+    ENTRY(NOP,   0x01, "NOP",   NONE, (uopNop)) \
+    ENTRY(CPYP,  0x10, "CPYP",  CPY,  (uopCpy<MopsStage::PROLOGUE>)) \
+    ENTRY(CPYM,  0x11, "CPYM",  CPY,  (uopCpy<MopsStage::MAIN>)) \
+    ENTRY(CPYE,  0x12, "CPYE",  CPY,  (uopCpy<MopsStage::EPILOGUE>)) \
+    ENTRY(SETP,  0x14, "SETP",  SET,  (uopSet<MopsStage::PROLOGUE>)) \
+    ENTRY(SETM,  0x15, "SETM",  SET,  (uopSet<MopsStage::MAIN>)) \
+    ENTRY(SETE,  0x16, "SETE",  SET,  (uopSet<MopsStage::EPILOGUE>)) \
+    ENTRY(LDXR,  0x20, "LDXR",  LDX,  (uopLdxr)) \
+    ENTRY(STXR,  0x21, "STXR",  STX,  (uopStxr)) \
+    ENTRY(LDADD, 0x22, "LDADD", RMW,  (uopLdadd)) \
+    ENTRY(CAS,   0x23, "CAS",   RMW,  (uopCas)) \
+    ENTRY(DMB,   0x24, "DMB",   NONE, (uopDmb)) \
+    ENTRY(MRS,   0x28, "MRS",   MRS,  (uopMrs))
+
+// MRS 可读的系统寄存器，按 [4:0] 的编号排列
+//   MPIDR_EL1  本核的编号（Aff0），单核时为0
+inline constexpr const char* SYSTEM_REGISTER_NAMES[] = {"MPIDR_EL1"};
+enum SystemRegister : uint8_t {
+    SYSREG_MPIDR = 0
+};
+
+// ====================== 由表生成 ======================
+
+struct InstrInfo {
+    uint8_t opcode;
+    const char* name;       // 枚举名（OP_ 之后的部分）
+    const char* mnemonic;   // 汇编助记符
+    InstrFormat format;
+    InstrWidth width;
+    uint8_t flags;
+};
+
+#define TINY_ISA_INFO(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) \
+    InstrInfo{OPCODE, #NAME, MNEMONIC, InstrFormat::FORMAT, InstrWidth::WIDTH, FLAGS},
+inline constexpr InstrInfo ISA_INFO[32] = { TINY_ISA(TINY_ISA_INFO, true) };
+#undef TINY_ISA_INFO
+
+constexpr bool isaInOpcodeOrder() {
+    for (uint8_t i = 0; i < 32; ++i) {
+        if (ISA_INFO[i].opcode != i) return false;
+    }
+    return true;
+}
+static_assert(isaInOpcodeOrder(), "TINY_ISA must list every opcode in order");
+
+struct SystemInstrInfo {
+    uint8_t subop;
+    const char* mnemonic;
+    InstrFormat format;     // NONE 或 CPY 之后的系统指令格式
+};
+
+#define TINY_SYSTEM_INFO(NAME, SUBOP, MNEMONIC, FORMAT, HANDLER) SystemInstrInfo{SUBOP, MNEMONIC, InstrFormat::FORMAT},
+inline constexpr SystemInstrInfo SYSTEM_ISA_INFO[] = { TINY_SYSTEM_ISA(TINY_SYSTEM_INFO) };
+#undef TINY_SYSTEM_INFO
+
+// 子操作码 -> 助记符，未定义的子操作码为 nullptr
+constexpr std::array<const char*, 256> makeSystemMnemonics() {
+    std::array<const char*, 256> names{};
+    for (const SystemInstrInfo& info : SYSTEM_ISA_INFO) {
+        names[info.subop] = info.mnemonic;
+    }
+    return names;
+}
+inline constexpr std::array<const char*, 256> SYSTEM_MNEMONICS = makeSystemMnemonics();
+
+// 条件码名称，按 BranchCondition 的编码排列
+inline constexpr const char* CONDITION_NAMES[16] = {
+    "EQ", "NE", "CS", "CC", "MI", "PL", "VS", "VC",
+    "HI", "LS", "GE", "LT", "GT", "LE", "AL", "NV"
+};
+
+constexpr bool isBranchOpcode(uint8_t opcode) { return ISA_INFO[opcode & 0x1F].flags & IF_BRANCH; }
+constexpr bool isDirectBranchOpcode(uint8_t opcode) { return ISA_INFO[opcode & 0x1F].flags & IF_DIRECT; }
+constexpr bool isStoreOpcode(uint8_t opcode) { return ISA_INFO[opcode & 0x1F].flags & IF_STORE; }
+constexpr bool setsFlagsOpcode(uint8_t opcode) { return ISA_INFO[opcode & 0x1F].flags & IF_FLAGS; }
+constexpr bool mayFaultOpcode(uint8_t opcode) { return ISA_INFO[opcode & 0x1F].flags & IF_FAULT; }
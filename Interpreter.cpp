@@ -0,0 +1,348 @@
+#include "CPU.h"
+#include "MicroOpHandlers.h"
+
+// ========================== 直接线程化解释器 ==========================
+// 每条指令只经过一次间接跳转：按微操作的 (sf << 5) | opcode 索引跳到对应的执行体，
+// 执行体末尾直接取下一条微操作并跳转，不再回到集中的取指/译码循环。
+// GCC/Clang 使用标签地址（computed goto），其他编译器退化为单层switch。
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(TINY_NO_COMPUTED_GOTO)
+#define TINY_COMPUTED_GOTO 1
+#endif
+
+// 跳转表与执行体由 ISA.h 的指令表生成；W/X 两个版本的标签分别以 _false/_true 结尾
+#define THREADED_W(X) TINY_ISA(X##_W, false)
+#define THREADED_X(X) TINY_ISA(X##_X, true)
+
+template<typename Config, typename Hooks>
+template<bool Breakpoint>
+StopReason BasicCPU<Config, Hooks>::interpret(uint64_t& remaining, uint64_t breakpoint) {
+    StopReason reason = StopReason::NONE;
+    const MicroOp* uop = nullptr;
+    const CodePage* page = &NO_CODE_PAGE; // 当前所在代码页，顺序执行时免去查表
+    uint64_t pageBase = 0;
+    uint64_t irPC = PC;               // 最近一条指令的地址，退出时据此更新IR
+    MicroOp slowOp;                   // 慢速路径临时译码的微操作
+    uint64_t fetched = 0;             // 慢速路径与退出时取指的物理地址
+
+#ifdef TINY_COMPUTED_GOTO
+
+#define LABEL_ADDR(NAME, X64) &&L_##NAME##_##X64,
+#define LABEL_ADDR_W(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) LABEL_ADDR(NAME, false)
+#define LABEL_ADDR_X(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) LABEL_ADDR(NAME, true)
+#define FUSED_ADDR_PAIR(NAME, A, B, H1, H2) &&L_FUSED_##NAME,
+#define FUSED_ADDR_TRIPLE(NAME, A, B, C, H1, H2, H3) &&L_FUSED_##NAME,
+    static void* const LABELS[FUSED_INDEX_BASE + NUM_FUSIONS] = {
+        THREADED_W(LABEL_ADDR)
+        THREADED_X(LABEL_ADDR)
+        TINY_FUSIONS(FUSED_ADDR_PAIR, FUSED_ADDR_TRIPLE)
+    };
+#undef FUSED_ADDR_TRIPLE
+#undef FUSED_ADDR_PAIR
+#undef LABEL_ADDR_X
+#undef LABEL_ADDR_W
+#undef LABEL_ADDR
+
+    // 快速路径：PC仍落在当前有效代码页内，直接取下一条微操作并跳转
+    // CHECK_BP为假时不检查断点（第一条指令总会执行）
+#define DISPATCH_IMPL(CHECK_BP)                                         \
+    do {                                                                \
+        if (remaining == 0) { reason = StopReason::STEP_LIMIT; goto L_STOP; } \
+        if (CHECK_BP && PC == breakpoint) { reason = StopReason::BREAKPOINT; goto L_STOP; } \
+        --remaining;                                                    \
+        uint64_t offset = PC - pageBase;                                \
+        if (offset >= CODE_PAGE_SIZE || (offset & 3) || !page->valid)   \
+            goto L_LOOKUP;                                              \
+        uop = &page->ops[offset >> 2];                                  \
+        irPC = PC;                                                      \
+        PC += 4;                                                        \
+        goto *LABELS[uop->index];                                       \
+    } while (0)
+#define DISPATCH() DISPATCH_IMPL(Breakpoint)
+
+    DISPATCH_IMPL(false);
+
+#define LABEL_BODY(NAME, X64, HANDLER)                                  \
+    L_##NAME##_##X64:                                                   \
+    hooks.onInstruction(irPC, uop->index);                              \
+    reason = HANDLER(*this, *uop);                                      \
+    if (reason != StopReason::NONE) goto L_STOP;                        \
+    DISPATCH();
+#define LABEL_BODY_W(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) LABEL_BODY(NAME, false, HANDLER)
+#define LABEL_BODY_X(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) LABEL_BODY(NAME, true, HANDLER)
+    THREADED_W(LABEL_BODY)
+    THREADED_X(LABEL_BODY)
+#undef LABEL_BODY_X
+#undef LABEL_BODY_W
+#undef LABEL_BODY
+
+    // 融合序列：首条已由分派计数，其余各条做与DISPATCH相同的步数与断点检查后直接执行，
+    // 序列内只有末条可能改变PC或使代码页失效，因此下一条微操作就在当前微操作之后
+#define FUSED_NEXT(HANDLER)                                             \
+    if (remaining == 0) { reason = StopReason::STEP_LIMIT; goto L_STOP; } \
+    if (Breakpoint && PC == breakpoint) { reason = StopReason::BREAKPOINT; goto L_STOP; } \
+    --remaining;                                                        \
+    ++uop;                                                              \
+    irPC = PC;                                                          \
+    PC += 4;                                                            \
+    reason = HANDLER(*this, *uop);                                      \
+    if (reason != StopReason::NONE) goto L_STOP;
+#define FUSED_HEAD(NAME, HANDLER)                                       \
+    L_FUSED_##NAME:                                                     \
+    reason = HANDLER(*this, *uop);                                      \
+    if (reason != StopReason::NONE) goto L_STOP;
+#define FUSED_PAIR(NAME, A, B, H1, H2)                                  \
+    FUSED_HEAD(NAME, H1)                                                \
+    FUSED_NEXT(H2)                                                      \
+    DISPATCH();
+#define FUSED_TRIPLE(NAME, A, B, C, H1, H2, H3)                         \
+    FUSED_HEAD(NAME, H1)                                                \
+    FUSED_NEXT(H2)                                                      \
+    FUSED_NEXT(H3)                                                      \
+    DISPATCH();
+    TINY_FUSIONS(FUSED_PAIR, FUSED_TRIPLE)
+#undef FUSED_TRIPLE
+#undef FUSED_PAIR
+#undef FUSED_HEAD
+#undef FUSED_NEXT
+
+    // 换页或代码页失效：重新查表（必要时重新译码）
+L_LOOKUP:
+    uop = lookupMicroOp(PC, page);
+    if (uop == nullptr) goto L_SLOW;
+    pageBase = PC & ~(CODE_PAGE_SIZE - 1);
+    irPC = PC;
+    PC += 4;
+    goto *LABELS[uop->index];
+
+    // PC未对齐或越界：越界（或不可执行）报告取指错误，未对齐时临时译码该地址的指令
+L_SLOW:
+    fetched = PC;
+    if (!fetchAddress(fetched)) {
+        reason = memoryFault(MemoryAccess::FETCH, PC);
+        goto L_STOP;
+    }
+    slowOp = predecode(readMemoryUnchecked<uint32_t>(fetched));
+    uop = &slowOp;
+    irPC = PC;
+    PC += 4;
+    goto *LABELS[uop->index];
+
+L_STOP:
+    ;
+
+#undef DISPATCH
+#undef DISPATCH_IMPL
+
+#else // 可移植的switch实现
+
+    bool first = true;
+    for (;;) {
+        if (remaining == 0) { reason = StopReason::STEP_LIMIT; break; }
+        if (Breakpoint && !first && PC == breakpoint) { reason = StopReason::BREAKPOINT; break; }
+        first = false;
+        --remaining;
+        uint64_t offset = PC - pageBase;
+        if (offset >= CODE_PAGE_SIZE || (offset & 3) || !page->valid) {
+            uop = lookupMicroOp(PC, page);
+            if (uop == nullptr) {
+                fetched = PC;
+                if (!fetchAddress(fetched)) {
+                    reason = memoryFault(MemoryAccess::FETCH, PC);
+                    break;
+                }
+                slowOp = predecode(readMemoryUnchecked<uint32_t>(fetched));
+                uop = &slowOp;
+            } else {
+                pageBase = PC & ~(CODE_PAGE_SIZE - 1);
+            }
+        } else {
+            uop = &page->ops[offset >> 2];
+        }
+        irPC = PC;
+        PC += 4;
+        hooks.onInstruction(irPC, uop->index);
+
+#define CASE_BODY(X64, OPCODE, HANDLER) \
+        case (X64 ? 32 : 0) + OPCODE: reason = HANDLER(*this, *uop); break;
+#define CASE_BODY_W(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) CASE_BODY(false, OPCODE, HANDLER)
+#define CASE_BODY_X(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) CASE_BODY(true, OPCODE, HANDLER)
+        switch (uop->index) {
+            THREADED_W(CASE_BODY)
+            THREADED_X(CASE_BODY)
+        default:  // 融合序列的首条：执行函数仍是首条指令本身，逐条执行
+            reason = uop->handler(*this, *uop);
+            break;
+        }
+#undef CASE_BODY_X
+#undef CASE_BODY_W
+#undef CASE_BODY
+        if (reason != StopReason::NONE) break;
+    }
+
+#endif
+
+    // IR只在退出解释器时写回
+    fetched = irPC;
+    if (fetchAddress(fetched)) {
+        IR = readMemoryUnchecked<uint32_t>(fetched);
+    }
+    return reason;
+}
+
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::run(uint64_t maxSteps) {
+    uint64_t remaining = maxSteps;
+    StopReason reason = catchGuardFault([&] { return interpret<false>(remaining, 0); });
+    runSteps = maxSteps - remaining;
+    return reason;
+}
+
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::runUntil(uint64_t pc, uint64_t maxSteps) {
+    uint64_t remaining = maxSteps;
+    StopReason reason = catchGuardFault([&] { return interpret<true>(remaining, pc); });
+    runSteps = maxSteps - remaining;
+    return reason;
+}
+
+// ========================== 基本块的线程化执行 ==========================
+// runBlocks() 与JIT的解释部分使用：块内指令同样按索引经标签地址跳到内联的执行体，
+// 步数只在块首检查一次，块内不查代码页、不逐条更新PC，块尾的哨兵转到块间链接。
+// 块内只有末条指令（分支或系统指令）读取PC，因此进入块时先把PC置为块尾。
+// 块中保留完整的融合序列；存储之后检查本块所在代码页是否失效，失效时在存储之后重新查块。
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::interpretBlocks(uint64_t& remaining) {
+    BasicBlock* block = nullptr;
+    const MicroOp* uop = nullptr;
+    StopReason reason = StopReason::NONE;
+
+#ifdef TINY_COMPUTED_GOTO
+#define BLOCK_ADDR(NAME, X64) &&B_##NAME##_##X64,
+#define BLOCK_ADDR_W(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) BLOCK_ADDR(NAME, false)
+#define BLOCK_ADDR_X(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) BLOCK_ADDR(NAME, true)
+#define FUSED_ADDR_PAIR(NAME, A, B, H1, H2) &&B_FUSED_##NAME,
+#define FUSED_ADDR_TRIPLE(NAME, A, B, C, H1, H2, H3) &&B_FUSED_##NAME,
+    static void* const LABELS[BLOCK_END_INDEX + 1] = {
+        THREADED_W(BLOCK_ADDR)
+        THREADED_X(BLOCK_ADDR)
+        TINY_FUSIONS(FUSED_ADDR_PAIR, FUSED_ADDR_TRIPLE)
+        &&B_END
+    };
+#undef FUSED_ADDR_TRIPLE
+#undef FUSED_ADDR_PAIR
+#undef BLOCK_ADDR_X
+#undef BLOCK_ADDR_W
+#undef BLOCK_ADDR
+#endif
+
+    while (remaining != 0) {
+        if (block == nullptr) {
+            block = lookupBlock(PC);
+            if (block == nullptr) {     // PC未对齐或越界，交给逐条解释
+                uint64_t one = 1;
+                reason = interpret<false>(one, 0);
+                remaining -= 1 - one;
+                if (reason != StopReason::STEP_LIMIT) return reason;
+                reason = StopReason::NONE;
+                continue;
+            }
+        }
+
+        const size_t count = block->count;
+        if (count > remaining) {        // 剩余步数不足一个块，逐条执行收尾
+            return interpret<false>(remaining, 0);
+        }
+
+        PC = block->end;
+        uop = block->ops.data();
+
+#ifdef TINY_COMPUTED_GOTO
+        goto *LABELS[uop->index];
+
+#define BLOCK_BODY(NAME, OPCODE, X64, HANDLER)                          \
+    B_##NAME##_##X64:                                                   \
+        hooks.onInstruction(block->start + (uop - block->ops.data()) * 4, uop->index); \
+        reason = HANDLER(*this, *uop);                                  \
+        if (reason != StopReason::NONE) goto B_STOP;                    \
+        if (isStoreOpcode(OPCODE) && !block->page->valid) goto B_STOP; \
+        ++uop;                                                          \
+        goto *LABELS[uop->index];
+#define BLOCK_BODY_W(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) BLOCK_BODY(NAME, OPCODE, false, HANDLER)
+#define BLOCK_BODY_X(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) BLOCK_BODY(NAME, OPCODE, true, HANDLER)
+        THREADED_W(BLOCK_BODY)
+        THREADED_X(BLOCK_BODY)
+#undef BLOCK_BODY_X
+#undef BLOCK_BODY_W
+#undef BLOCK_BODY
+
+        // 融合序列只有末条可能是存储
+#define BLOCK_FUSED_STEP(HANDLER)                                       \
+        reason = HANDLER(*this, *uop);                                  \
+        if (reason != StopReason::NONE) goto B_STOP;
+#define BLOCK_FUSED_TAIL(LAST, HANDLER)                                 \
+        ++uop;                                                          \
+        reason = HANDLER(*this, *uop);                                  \
+        if (reason != StopReason::NONE) goto B_STOP;                    \
+        if (isStoreOpcode((LAST) & 0x1F) && !block->page->valid) goto B_STOP; \
+        ++uop;                                                          \
+        goto *LABELS[uop->index];
+#define BLOCK_FUSED_PAIR(NAME, A, B, H1, H2)                            \
+    B_FUSED_##NAME:                                                     \
+        BLOCK_FUSED_STEP(H1)                                            \
+        BLOCK_FUSED_TAIL(B, H2)
+#define BLOCK_FUSED_TRIPLE(NAME, A, B, C, H1, H2, H3)                   \
+    B_FUSED_##NAME:                                                     \
+        BLOCK_FUSED_STEP(H1)                                            \
+        ++uop;                                                          \
+        BLOCK_FUSED_STEP(H2)                                            \
+        BLOCK_FUSED_TAIL(C, H3)
+        TINY_FUSIONS(BLOCK_FUSED_PAIR, BLOCK_FUSED_TRIPLE)
+#undef BLOCK_FUSED_TRIPLE
+#undef BLOCK_FUSED_PAIR
+#undef BLOCK_FUSED_TAIL
+#undef BLOCK_FUSED_STEP
+
+    B_END:
+    B_STOP:
+#else
+        for (; uop->index != BLOCK_END_INDEX; ++uop) {
+            hooks.onInstruction(block->start + (uop - block->ops.data()) * 4, uop->index);
+            reason = uop->handler(*this, *uop);     // 融合序列首条的执行函数仍是该指令本身
+            if (reason != StopReason::NONE) break;
+            if (isStoreOpcode(baseOpIndex(uop->index) & 0x1F) && !block->page->valid) break;
+        }
+#endif
+
+        // 中途停止，或存储改写了本页代码：PC与IR指向停止的指令之后/该指令
+        if (uop->index != BLOCK_END_INDEX) {
+            const size_t executed = uop - block->ops.data() + 1;
+            PC = block->start + executed * 4;
+            remaining -= executed;
+            IR = readMemoryUnchecked<uint32_t>(PC - 4);
+            if (reason != StopReason::NONE) return reason;
+            block = nullptr;            // 后续指令需重新译码
+            continue;
+        }
+
+        remaining -= count;
+        IR = readMemoryUnchecked<uint32_t>(block->end - 4);
+        if (remaining == 0) break;      // 由调用者（JIT执行）链接下一块，避免重复压入返回地址
+        BasicBlock* next = linkedSuccessor(block);
+        block = next != nullptr ? next : nextBlock(block);
+    }
+
+    return StopReason::STEP_LIMIT;
+}
+
+#undef THREADED_X
+#undef THREADED_W
+
+// interpret<false> 另由基本块执行与JIT执行在块尾步数不足或遇到慢速路径时调用
+#define INSTANTIATE_INTERPRETER(CONFIG, HOOKS) \
+    template StopReason BasicCPU<CONFIG, HOOKS>::interpret<false>(uint64_t& remaining, uint64_t breakpoint); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::run(uint64_t maxSteps); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::runUntil(uint64_t pc, uint64_t maxSteps); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::interpretBlocks(uint64_t& remaining);
+TINY_CPU_CONFIGS(INSTANTIATE_INTERPRETER)
+#undef INSTANTIATE_INTERPRETER
@@ -0,0 +1,852 @@
+#include "JitX64.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+#include "CPU.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TINY_JIT_X64 1
+#endif
+
+#if defined(TINY_JIT_X64)
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+// ========================== 指令编码 ==========================
+
+namespace {
+
+enum X64Reg {
+    RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+// x86条件码（Jcc/SETcc/CMOVcc的低4位）
+enum X64Cond {
+    CC_O = 0x0, CC_NO = 0x1, CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_BE = 0x6, CC_A = 0x7,
+    CC_S = 0x8, CC_NS = 0x9, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF
+};
+
+// [base + index*scale + disp32]
+struct Mem {
+    int base;
+    int index = -1;
+    int scale = 1;
+    int32_t disp = 0;
+};
+
+class X64Emitter {
+public:
+    std::vector<uint8_t> code;
+
+    size_t pos() const { return code.size(); }
+
+    void emit8(uint8_t v) { code.push_back(v); }
+    void emit32(uint32_t v) { for (int i = 0; i < 4; ++i) emit8(static_cast<uint8_t>(v >> (i * 8))); }
+    void emit64(uint64_t v) { for (int i = 0; i < 8; ++i) emit8(static_cast<uint8_t>(v >> (i * 8))); }
+
+    void patch32(size_t at, uint32_t v) { for (int i = 0; i < 4; ++i) code[at + i] = static_cast<uint8_t>(v >> (i * 8)); }
+    // 将at处的rel32指向当前位置
+    void bindHere(size_t at) { patch32(at, static_cast<uint32_t>(pos() - (at + 4))); }
+
+    // ---------------- ModRM ----------------
+    void rex(bool w, int reg, int index, int base, bool forceRex = false) {
+        uint8_t r = 0x40 | (w ? 8 : 0) | ((reg >> 3) & 1) << 2 | ((index >> 3) & 1) << 1 | ((base >> 3) & 1);
+        if (r != 0x40 || forceRex) emit8(r);
+    }
+
+    // 统一使用 mod=10 + disp32 编码内存操作数
+    void modrmMem(int reg, const Mem& m) {
+        if (m.index < 0 && (m.base & 7) != RSP) {
+            emit8(0x80 | (reg & 7) << 3 | (m.base & 7));
+        } else {
+            int ss = m.scale == 8 ? 3 : m.scale == 4 ? 2 : m.scale == 2 ? 1 : 0;
+            int idx = m.index < 0 ? RSP : m.index;
+            emit8(0x80 | (reg & 7) << 3 | 4);
+            emit8(ss << 6 | (idx & 7) << 3 | (m.base & 7));
+        }
+        emit32(static_cast<uint32_t>(m.disp));
+    }
+
+    void opMem(bool w, std::initializer_list<uint8_t> op, int reg, const Mem& m, bool p66 = false) {
+        if (p66) emit8(0x66);
+        rex(w, reg, m.index < 0 ? 0 : m.index, m.base);
+        for (uint8_t b : op) emit8(b);
+        modrmMem(reg, m);
+    }
+
+    void opReg(bool w, std::initializer_list<uint8_t> op, int reg, int rm) {
+        rex(w, reg, 0, rm);
+        for (uint8_t b : op) emit8(b);
+        emit8(0xC0 | (reg & 7) << 3 | (rm & 7));
+    }
+
+    // ---------------- 数据传送 ----------------
+    void load(bool w, int dst, const Mem& m)   { opMem(w, {0x8B}, dst, m); }          // mov r, [m]
+    void store(bool w, const Mem& m, int src)  { opMem(w, {0x89}, src, m); }          // mov [m], r
+    void store16(const Mem& m, int src)        { opMem(false, {0x89}, src, m, true); }
+    void store8(const Mem& m, int src)         { opMem(false, {0x88}, src, m); }      // 仅使用 al/cl/dl
+    void movzx8(int dst, const Mem& m)         { opMem(false, {0x0F, 0xB6}, dst, m); }
+    void movzx16(int dst, const Mem& m)        { opMem(false, {0x0F, 0xB7}, dst, m); }
+    void movRR(bool w, int dst, int src)       { opReg(w, {0x89}, src, dst); }
+
+    void movImm64(int dst, uint64_t v) {                                               // mov r64, imm64
+        rex(true, 0, 0, dst);
+        emit8(0xB8 | (dst & 7));
+        emit64(v);
+    }
+    void movImm32(int dst, uint32_t v) {                                               // mov r32, imm32（零扩展）
+        rex(false, 0, 0, dst);
+        emit8(0xB8 | (dst & 7));
+        emit32(v);
+    }
+    void movSImm32(int dst, int32_t v) {                                               // mov r64, simm32
+        rex(true, 0, 0, dst);
+        emit8(0xC7);
+        emit8(0xC0 | (dst & 7));
+        emit32(static_cast<uint32_t>(v));
+    }
+    void movMemImm8(const Mem& m, uint8_t v) { opMem(false, {0xC6}, 0, m); emit8(v); }
+
+    // ---------------- 运算 ----------------
+    // ALU r/m, r 形式的操作码：add 01, or 09, and 21, sub 29, xor 31, cmp 39
+    void aluRR(uint8_t op, bool w, int dst, int src) { opReg(w, {op}, src, dst); }
+    // ALU r/m, imm32 形式的 /digit：add 0, or 1, and 4, sub 5, xor 6, cmp 7
+    void aluRI(int digit, bool w, int dst, int32_t imm) {
+        opReg(w, {0x81}, digit, dst);
+        emit32(static_cast<uint32_t>(imm));
+    }
+    void imulRR(bool w, int dst, int src) { opReg(w, {0x0F, 0xAF}, dst, src); }
+    void testRR(bool w, int a, int b)     { opReg(w, {0x85}, b, a); }
+    void neg(bool w, int r)               { opReg(w, {0xF7}, 3, r); }
+    void idiv(bool w, int r)              { opReg(w, {0xF7}, 7, r); }
+    void div(bool w, int r)               { opReg(w, {0xF7}, 6, r); }
+    void signExtendAx(bool w)             { if (w) emit8(0x48); emit8(0x99); }         // cqo / cdq
+    void shrImm(bool w, int r, uint8_t n) { opReg(w, {0xC1}, 5, r); emit8(n); }
+    void addRR(bool w, int dst, int src)  { aluRR(0x01, w, dst, src); }
+    void orRR(bool w, int dst, int src)   { aluRR(0x09, w, dst, src); }
+    void btRR(int base, int bit)          { opReg(false, {0x0F, 0xA3}, bit, base); }   // bt r32, r32
+    void cmovRR(uint8_t cc, int dst, int src) { opReg(true, {0x0F, static_cast<uint8_t>(0x40 | cc)}, dst, src); }
+    void setccMem(uint8_t cc, const Mem& m)   { opMem(false, {0x0F, static_cast<uint8_t>(0x90 | cc)}, 0, m); }
+    void cmpMemImm8(const Mem& m, uint8_t v)  { opMem(false, {0x80}, 7, m); emit8(v); }
+    void cmpMemImm32(const Mem& m, uint32_t v) { opMem(false, {0x81}, 7, m); emit32(v); }
+    void leaDisp(int dst, int base, int32_t disp) { opMem(true, {0x8D}, dst, Mem{base, -1, 1, disp}); }
+    void leaRip(int dst, size_t target) {                                              // lea r64, [rip+到target]
+        rex(true, dst, 0, 0);
+        emit8(0x8D);
+        emit8(0x05 | (dst & 7) << 3);
+        emit32(static_cast<uint32_t>(target - (pos() + 4)));
+    }
+
+    // ---------------- 控制流 ----------------
+    // 返回rel32字段的位置，稍后用 bindHere/patch 回填
+    size_t jcc(uint8_t cc) { emit8(0x0F); emit8(0x80 | cc); size_t at = pos(); emit32(0); return at; }
+    size_t jmp()           { emit8(0xE9); size_t at = pos(); emit32(0); return at; }
+    void jmpTo(size_t target) { emit8(0xE9); emit32(static_cast<uint32_t>(target - (pos() + 4))); }
+    void push(int r) { rex(false, 0, 0, r); emit8(0x50 | (r & 7)); }
+    void pop(int r)  { rex(false, 0, 0, r); emit8(0x58 | (r & 7)); }
+    void ret()       { emit8(0xC3); }
+};
+
+// 生成代码中固定使用的宿主寄存器
+const int REG_REGS  = RBX;  // 客户机寄存器文件
+const int REG_MEM   = R12;  // 客户机内存
+const int REG_CTX   = R13;  // JitContext
+const int REG_FLAGS = R14;  // StatusRegister
+const int REG_BUDGET = R15; // 剩余步数（JitContext::remaining）
+
+// 可分配给客户机寄存器的宿主寄存器；RAX/RCX/RDX 留作临时寄存器
+const int CACHE_POOL[] = {RSI, RDI, R8, R9, R10, R11, RBP};
+const int CACHE_POOL_SIZE = sizeof(CACHE_POOL) / sizeof(CACHE_POOL[0]);
+
+// 最近一条设置标志位的指令留在宿主 EFLAGS 中的标志位语义
+enum class HostFlags { NONE, ADD, SUB, LOGIC };
+
+// 条件码在宿主 EFLAGS 上的等价条件；无法用一个x86条件表示时返回-1
+//   减法：AArch64 的C为“无借位”，与CF相反；加法与逻辑运算（C=V=0）的C即CF
+int hostCondition(HostFlags kind, BranchCondition cond) {
+    if (kind == HostFlags::NONE) return -1;
+    const bool sub = (kind == HostFlags::SUB);
+    switch (cond) {
+    case BranchCondition::EQ: return CC_E;
+    case BranchCondition::NE: return CC_NE;
+    case BranchCondition::CS: return sub ? CC_AE : CC_B;
+    case BranchCondition::CC: return sub ? CC_B : CC_AE;
+    case BranchCondition::MI: return CC_S;
+    case BranchCondition::PL: return CC_NS;
+    case BranchCondition::VS: return CC_O;
+    case BranchCondition::VC: return CC_NO;
+    case BranchCondition::HI: return sub ? CC_A : -1;
+    case BranchCondition::LS: return sub ? CC_BE : -1;
+    case BranchCondition::GE: return CC_GE;
+    case BranchCondition::LT: return CC_L;
+    case BranchCondition::GT: return CC_G;
+    case BranchCondition::LE: return CC_LE;
+    default: return -1;
+    }
+}
+
+// 指令读写的客户机寄存器（-1 表示无）
+struct Operands {
+    int read0 = -1;
+    int read1 = -1;
+    int write = -1;
+};
+
+template<typename MicroOp>
+Operands operandsOf(const MicroOp& u, uint8_t opcode) {
+    Operands o;
+    switch (opcode) {
+    case OP_ADD: case OP_SUB: case OP_AND: case OP_ORR: case OP_EOR:
+    case OP_MUL: case OP_SDIV: case OP_UDIV:
+        o.read0 = u.rn; o.read1 = u.rm; o.write = u.rd; break;
+    case OP_CMP:
+        o.read0 = u.rn; o.read1 = u.rm; break;
+    case OP_CMPI: case OP_BR:
+        o.read0 = u.rn; break;
+    case OP_ADDI: case OP_SUBI: case OP_ANDI: case OP_ORRI: case OP_EORI: case OP_MOV:
+    case OP_LDRB: case OP_LDRH: case OP_LDRW: case OP_LDRD:
+        o.read0 = u.rn; o.write = u.rd; break;
+    case OP_MOVI:
+        o.write = u.rd; break;
+    case OP_STRB: case OP_STRH: case OP_STRW: case OP_STRD:
+        o.read0 = u.rn; o.read1 = u.rd; break;
+    case OP_BL:
+        o.write = 30; break;
+    case OP_BLR:
+        o.read0 = u.rn; o.write = 30; break;
+    case OP_RET:
+        o.read0 = 30; break;
+    default:
+        break;
+    }
+    return o;
+}
+
+#if defined(_WIN32)
+const int REG_ARG0 = RCX;
+#else
+const int REG_ARG0 = RDI;
+#endif
+
+inline Mem guestReg(uint8_t r) { return Mem{REG_REGS, -1, 1, static_cast<int32_t>(r) * 8}; }
+inline Mem flagN() { return Mem{REG_FLAGS, -1, 1, static_cast<int32_t>(offsetof(StatusRegister, N))}; }
+inline Mem flagZ() { return Mem{REG_FLAGS, -1, 1, static_cast<int32_t>(offsetof(StatusRegister, Z))}; }
+inline Mem flagC() { return Mem{REG_FLAGS, -1, 1, static_cast<int32_t>(offsetof(StatusRegister, C))}; }
+inline Mem flagV() { return Mem{REG_FLAGS, -1, 1, static_cast<int32_t>(offsetof(StatusRegister, V))}; }
+inline Mem ctxField(size_t offset) { return Mem{REG_CTX, -1, 1, static_cast<int32_t>(offset)}; }
+
+} // namespace
+
+// ========================== 可执行内存 ==========================
+
+JitX64::JitX64(size_t capacity) {
+#if defined(TINY_JIT_X64)
+#if defined(_WIN32)
+    void* p = VirtualAlloc(nullptr, capacity, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+    if (p == nullptr) return;
+#else
+    void* p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return;
+#endif
+    buffer = static_cast<uint8_t*>(p);
+    this->capacity = capacity;
+#endif
+}
+
+JitX64::~JitX64() {
+#if defined(TINY_JIT_X64)
+    if (buffer == nullptr) return;
+#if defined(_WIN32)
+    VirtualFree(buffer, 0, MEM_RELEASE);
+#else
+    munmap(buffer, capacity);
+#endif
+#endif
+}
+
+// ========================== 基本块编译 ==========================
+
+// 生成代码的布局：
+//   序言          保存被调用者保存寄存器，载入上下文与步数预算
+//   链接入口      检查本块仍有效、预算足够，扣除整块的步数后载入分配的寄存器
+//   块体          逐条翻译；跳回块首的分支重新检查后留在宿主寄存器中循环
+//   尾声          写出 nextPC / remaining 并返回
+//   桩代码        提前退出、未链接的直接分支出口
+// 直接分支出口写回寄存器后以 jmp rel32 离开，初始指向记录 chainSite 后返回的桩，
+// 调用者在后继块编译后用 link() 把它改为后继块的链接入口
+template<typename Core>
+JitX64::BlockFn JitX64::compile(const Core& cpu, const typename Core::MicroOp* ops, size_t count, uint64_t start, bool halts,
+                                uint8_t*& entry) {
+    using MicroOp = typename Core::MicroOp;
+    using CodePage = typename Core::CodePage;
+
+    const size_t body = halts ? count - 1 : count;     // HLT不编译，由解释器执行
+    if (!available() || body == 0) return nullptr;
+
+    X64Emitter e;
+    const uint64_t end = start + count * 4;
+    const CodePage* ownPage = cpu.codeCache[start >> Core::CODE_PAGE_SHIFT];
+
+    // 提前退出：nextPC / 已执行指令数 / 是否出错
+    struct Exit {
+        size_t at;
+        uint64_t pc;
+        uint32_t executed;
+        bool fault;
+    };
+    std::vector<Exit> exits;
+    auto exitIf = [&](uint8_t cc, uint64_t pc, uint32_t executed, bool fault) {
+        exits.push_back({e.jcc(cc), pc, executed, fault});
+    };
+
+    // 未链接的直接分支出口：jmp的rel32位置 / 跳转目标
+    struct ChainSite {
+        size_t at;
+        uint64_t target;
+    };
+    std::vector<ChainSite> chainSites;
+
+    // 标志位活跃性：被后续指令覆盖且中间无人读取的标志位不必写回
+    std::vector<bool> flagsLive(count, true);
+    bool live = true;
+    for (size_t i = count; i-- > 0;) {
+        uint8_t opcode = baseOpIndex(ops[i].index) & 0x1F;
+        if (setsFlagsOpcode(opcode)) {
+            flagsLive[i] = live;
+            live = false;
+        }
+        // 可能提前退出到解释器的指令：退出时标志位必须已是最新值
+        if (opcode == OP_B_COND || mayFaultOpcode(opcode)) live = true;
+    }
+
+    // 寄存器分配：块内使用两次以上的客户机寄存器按使用次数分配宿主寄存器，
+    // 块内写过的在每个出口写回
+    int uses[32] = {};
+    bool written[32] = {};
+    for (size_t i = 0; i < body; ++i) {
+        Operands o = operandsOf(ops[i], baseOpIndex(ops[i].index) & 0x1F);
+        if (o.read0 >= 0) ++uses[o.read0];
+        if (o.read1 >= 0) ++uses[o.read1];
+        if (o.write >= 0) {
+            ++uses[o.write];
+            written[o.write] = true;
+        }
+    }
+    std::vector<int> cached;
+    for (int r = 0; r < 32; ++r) {
+        if (uses[r] >= 2) cached.push_back(r);
+    }
+    std::stable_sort(cached.begin(), cached.end(), [&](int a, int b) { return uses[a] > uses[b]; });
+    if (cached.size() > static_cast<size_t>(CACHE_POOL_SIZE)) cached.resize(CACHE_POOL_SIZE);
+    int hostOf[32];
+    std::fill(std::begin(hostOf), std::end(hostOf), -1);
+    for (size_t k = 0; k < cached.size(); ++k) hostOf[cached[k]] = CACHE_POOL[k];
+
+    // 读客户机寄存器到 dst（w为假时零扩展低32位）
+    auto readInto = [&](int dst, uint8_t r, bool w) {
+        if (hostOf[r] >= 0) e.movRR(w, dst, hostOf[r]);
+        else e.load(w, dst, guestReg(r));
+    };
+    // 客户机寄存器的值所在的宿主寄存器，未分配时载入 scratch
+    auto source = [&](uint8_t r, bool w, int scratch) {
+        if (hostOf[r] >= 0) return hostOf[r];
+        e.load(w, scratch, guestReg(r));
+        return scratch;
+    };
+    // 写客户机寄存器（src为完整的64位值）
+    auto writeReg = [&](uint8_t r, int src) {
+        if (hostOf[r] < 0) e.store(true, guestReg(r), src);
+        else if (hostOf[r] != src) e.movRR(true, hostOf[r], src);
+    };
+    auto writeBack = [&] {
+        for (int r : cached) {
+            if (written[r]) e.store(true, guestReg(static_cast<uint8_t>(r)), hostOf[r]);
+        }
+    };
+    auto storeLastPC = [&](uint64_t pc) {
+        e.movImm64(RAX, pc);
+        e.store(true, ctxField(offsetof(JitContext, lastPC)), RAX);
+    };
+    // 本块仍有效且预算足够时扣除整块的步数，否则跳到 fails 中的某个出口
+    auto checkEntry = [&](std::vector<size_t>& fails) {
+        e.movImm64(RCX, reinterpret_cast<uint64_t>(ownPage));
+        e.cmpMemImm8(Mem{RCX, -1, 1, static_cast<int32_t>(offsetof(CodePage, valid))}, 0);
+        fails.push_back(e.jcc(CC_E));
+        e.cmpMemImm32(Mem{RCX, -1, 1, static_cast<int32_t>(offsetof(CodePage, generation))}, ownPage->generation);
+        fails.push_back(e.jcc(CC_NE));
+        e.aluRI(7, true, REG_BUDGET, static_cast<int32_t>(body));
+        fails.push_back(e.jcc(CC_B));
+        e.aluRI(5, true, REG_BUDGET, static_cast<int32_t>(body));
+    };
+
+    // 序言：保存被调用者保存寄存器（Win64 下含 RSI/RDI），载入上下文
+    static const int SAVED[] = {RBX, RBP, RSI, RDI, R12, R13, R14, R15};
+    for (int r : SAVED) e.push(r);
+    e.movRR(true, REG_CTX, REG_ARG0);
+    e.load(true, REG_REGS, ctxField(offsetof(JitContext, regs)));
+    e.load(true, REG_MEM, ctxField(offsetof(JitContext, memory)));
+    e.load(true, REG_FLAGS, ctxField(offsetof(JitContext, flags)));
+    e.load(true, REG_BUDGET, ctxField(offsetof(JitContext, remaining)));
+
+    // 链接入口
+    const size_t entryOffset = e.pos();
+    std::vector<size_t> entryFails;
+    checkEntry(entryFails);
+    for (int r : cached) e.load(true, hostOf[r], guestReg(static_cast<uint8_t>(r)));
+    const size_t loopTop = e.pos();
+    std::vector<size_t> loopFails;
+
+    // 直接分支出口：跳回块首时重新检查后继续循环，否则写回寄存器经可链接的jmp离开
+    auto chainExit = [&](uint64_t target) {
+        if (target == start) {
+            checkEntry(loopFails);
+            e.jmpTo(loopTop);
+            return;
+        }
+        writeBack();
+        storeLastPC(end - 4);
+        chainSites.push_back({e.jmp(), target});
+    };
+
+    auto writeFlags = [&](bool subtract) {
+        e.setccMem(CC_S, flagN());
+        e.setccMem(CC_E, flagZ());
+        e.setccMem(subtract ? CC_AE : CC_B, flagC());   // AArch64减法的C为“无借位”
+        e.setccMem(CC_O, flagV());
+    };
+
+    // 访存地址 -> rax，越界时退出（WRAP方式下对内存大小取模）；size为访问字节数
+    auto emitAddress = [&](const MicroOp& u, bool w, size_t size, size_t i) {
+        readInto(RAX, u.rn, w);
+        e.aluRI(0, true, RAX, u.imm);
+        if constexpr (Core::BOUNDS == BoundsCheck::WRAP) {
+            e.movImm64(RCX, cpu.layout.memSize - 1);
+            e.aluRR(0x21, true, RAX, RCX);                     // and rax, rcx
+        } else {
+            e.movImm64(RCX, cpu.layout.memSize - size);
+            e.aluRR(0x39, true, RAX, RCX);                     // cmp rax, rcx
+            exitIf(CC_A, start + i * 4, static_cast<uint32_t>(i), true);
+        }
+    };
+
+    // 标记脏页（与 DirtyMap::mark 一致），写入已译码代码页时使其失效（与 CPU::invalidateCodeRange 一致）；
+    // 代码区之外的写入不检查代码页
+    auto emitInvalidate = [&](int addrReg) {
+        const DirtyMap* dirty = cpu.jitDirtyMap();
+        e.movRR(true, RCX, addrReg);
+        e.shrImm(true, RCX, Core::CODE_PAGE_SHIFT + DirtyMap::GROUP_SHIFT);
+        e.movImm64(RDX, reinterpret_cast<uint64_t>(dirty->groupData()));
+        e.movMemImm8(Mem{RDX, RCX, 1, 0}, 1);
+        e.movRR(true, RCX, addrReg);
+        e.shrImm(true, RCX, Core::CODE_PAGE_SHIFT);
+        e.movImm64(RDX, reinterpret_cast<uint64_t>(dirty->data()));
+        e.movMemImm8(Mem{RDX, RCX, 1, 0}, PAGE_DIRTY);
+        e.aluRI(7, true, RCX, static_cast<int32_t>(cpu.codeCache.size()));    // cmp rcx, 代码页数
+        size_t outside = e.jcc(CC_AE);
+        e.movImm64(RDX, reinterpret_cast<uint64_t>(cpu.codeCache.data()));
+        e.load(true, RCX, Mem{RDX, RCX, 8, 0});
+        e.testRR(true, RCX, RCX);
+        size_t skip = e.jcc(CC_E);
+        e.movMemImm8(Mem{RCX, -1, 1, static_cast<int32_t>(offsetof(CodePage, valid))}, 0);
+        e.bindHere(skip);
+        e.bindHere(outside);
+    };
+
+    bool hasTerminator = false;
+    HostFlags hostFlags = HostFlags::NONE;
+
+    for (size_t i = 0; i < body; ++i) {
+        const MicroOp& u = ops[i];
+        const uint8_t index = baseOpIndex(u.index);    // 块中保留了融合序列，按原指令编译
+        const uint8_t opcode = index & 0x1F;
+        const bool w = (index & 0x20) != 0;
+        const uint64_t next = start + (i + 1) * 4;
+        HostFlags flagsAfter = HostFlags::NONE;
+
+        switch (opcode) {
+        case OP_CMP: case OP_CMPI: {
+            int a = source(u.rn, w, RAX);
+            if (opcode == OP_CMPI) e.aluRI(7, w, a, u.imm);
+            else e.aluRR(0x39, w, a, source(u.rm, w, RCX));
+            if (flagsLive[i]) writeFlags(true);
+            flagsAfter = HostFlags::SUB;
+            break;
+        }
+
+        case OP_ADD: case OP_ADDI: case OP_SUB: case OP_SUBI:
+        case OP_AND: case OP_ANDI: case OP_ORR: case OP_ORRI:
+        case OP_EOR: case OP_EORI: {
+            static const uint8_t RR[] = {0x01, 0x01, 0x29, 0x29, 0x21, 0x21, 0x09, 0x09, 0x31, 0x31};
+            static const int RI[]     = {0, 0, 5, 5, 4, 4, 1, 1, 6, 6};
+            const bool imm = (opcode & 1) != 0;
+            // 目标已分配时直接在宿主寄存器上运算（rd同时是另一源操作数时除外）
+            int dst = RAX;
+            if (hostOf[u.rd] >= 0 && (imm || u.rm != u.rd || u.rn == u.rd)) dst = hostOf[u.rd];
+            if (dst == RAX || u.rn != u.rd) readInto(dst, u.rn, w);
+            if (imm) e.aluRI(RI[opcode], w, dst, u.imm);
+            else e.aluRR(RR[opcode], w, dst, source(u.rm, w, RCX));
+            const bool subtract = (opcode == OP_SUB || opcode == OP_SUBI);
+            if (flagsLive[i]) writeFlags(subtract);
+            writeReg(u.rd, dst);
+            flagsAfter = subtract ? HostFlags::SUB : (opcode <= OP_ADDI ? HostFlags::ADD : HostFlags::LOGIC);
+            break;
+        }
+
+        case OP_MUL: {
+            int dst = RAX;
+            if (hostOf[u.rd] >= 0 && (u.rm != u.rd || u.rn == u.rd)) dst = hostOf[u.rd];
+            if (dst == RAX || u.rn != u.rd) readInto(dst, u.rn, w);
+            e.imulRR(w, dst, source(u.rm, w, RCX));
+            if (flagsLive[i]) {
+                e.testRR(w, dst, dst);                          // N/Z取自结果，C=V=0
+                writeFlags(false);
+                flagsAfter = HostFlags::LOGIC;
+            }
+            writeReg(u.rd, dst);
+            break;
+        }
+
+        case OP_SDIV:
+        case OP_UDIV: {
+            readInto(RAX, u.rn, w);
+            readInto(RCX, u.rm, w);
+            e.testRR(w, RCX, RCX);
+            exitIf(CC_E, start + i * 4, static_cast<uint32_t>(i), true);   // 除零
+            if (opcode == OP_SDIV) {
+                // x/-1 在x86上对最小负数会触发异常，直接取负（结果与 aluExec 一致）
+                e.aluRI(7, w, RCX, -1);
+                size_t doDiv = e.jcc(CC_NE);
+                e.neg(w, RAX);
+                size_t done = e.jmp();
+                e.bindHere(doDiv);
+                e.signExtendAx(w);
+                e.idiv(w, RCX);
+                e.bindHere(done);
+            } else {
+                e.aluRR(0x31, false, RDX, RDX);
+                e.div(w, RCX);
+            }
+            if (flagsLive[i]) {
+                e.testRR(w, RAX, RAX);
+                writeFlags(false);
+                flagsAfter = HostFlags::LOGIC;
+            }
+            writeReg(u.rd, RAX);
+            break;
+        }
+
+        case OP_MOV:        // 传送不影响宿主标志位
+            if (hostOf[u.rd] >= 0) {
+                readInto(hostOf[u.rd], u.rn, w);
+            } else {
+                readInto(RAX, u.rn, w);
+                e.store(true, guestReg(u.rd), RAX);
+            }
+            flagsAfter = hostFlags;
+            break;
+
+        case OP_MOVI: {
+            int dst = hostOf[u.rd] >= 0 ? hostOf[u.rd] : RAX;
+            if (w) e.movSImm32(dst, u.imm);
+            else   e.movImm32(dst, static_cast<uint32_t>(u.imm));
+            writeReg(u.rd, dst);
+            flagsAfter = hostFlags;
+            break;
+        }
+
+        case OP_LDRB: case OP_LDRH: case OP_LDRW: case OP_LDRD: {
+            const size_t size = size_t(1) << (opcode - OP_LDRB);
+            emitAddress(u, w, size, i);
+            const int dst = hostOf[u.rd] >= 0 ? hostOf[u.rd] : RCX;
+            Mem m{REG_MEM, RAX, 1, 0};
+            switch (size) {
+            case 1: e.movzx8(dst, m); break;
+            case 2: e.movzx16(dst, m); break;
+            case 4: e.load(false, dst, m); break;
+            default: e.load(w, dst, m); break;     // W寄存器只保留低32位
+            }
+            writeReg(u.rd, dst);
+            break;
+        }
+
+        case OP_STRB: case OP_STRH: case OP_STRW: case OP_STRD: {
+            const size_t size = size_t(1) << (opcode - OP_STRB);
+            emitAddress(u, w, size, i);
+            // 字节存储只能使用 dl；W寄存器的8字节存储需要零扩展后的值
+            int src = RDX;
+            if (hostOf[u.rd] >= 0 && size != 1 && (size != 8 || w)) src = hostOf[u.rd];
+            else readInto(RDX, u.rd, w);
+            Mem m{REG_MEM, RAX, 1, 0};
+            switch (size) {
+            case 1: e.store8(m, src); break;
+            case 2: e.store16(m, src); break;
+            case 4: e.store(false, m, src); break;
+            default: e.store(true, m, src); break;
+            }
+            emitInvalidate(RAX);
+            if (size > 1) {
+                e.leaDisp(RAX, RAX, static_cast<int32_t>(size - 1));
+                emitInvalidate(RAX);
+            }
+            // 改写了本块所在代码页：执行完这条指令后退出，剩余指令重新译码
+            e.movImm64(RCX, reinterpret_cast<uint64_t>(ownPage));
+            e.cmpMemImm8(Mem{RCX, -1, 1, static_cast<int32_t>(offsetof(CodePage, valid))}, 0);
+            exitIf(CC_E, next, static_cast<uint32_t>(i + 1), false);
+            break;
+        }
+
+        case OP_B:
+            chainExit(end + u.imm);
+            hasTerminator = true;
+            break;
+
+        case OP_BL:
+            e.movImm64(RAX, end);
+            writeReg(30, RAX);
+            chainExit(end + u.imm);
+            hasTerminator = true;
+            break;
+
+        case OP_B_COND: {
+            const BranchCondition cond = static_cast<BranchCondition>(u.rm);
+            int cc = hostCondition(hostFlags, cond);
+            if (cc < 0) {
+                // eax = N<<3 | Z<<2 | C<<1 | V，按条件掩码取位决定是否跳转
+                e.movzx8(RAX, flagN());
+                e.addRR(false, RAX, RAX);
+                e.movzx8(RCX, flagZ());
+                e.orRR(false, RAX, RCX);
+                e.addRR(false, RAX, RAX);
+                e.movzx8(RCX, flagC());
+                e.orRR(false, RAX, RCX);
+                e.addRR(false, RAX, RAX);
+                e.movzx8(RCX, flagV());
+                e.orRR(false, RAX, RCX);
+                e.movImm32(RCX, Core::conditionMask(cond));
+                e.btRR(RCX, RAX);
+                cc = CC_B;
+            }
+            size_t taken = e.jcc(static_cast<uint8_t>(cc));
+            chainExit(end);
+            e.bindHere(taken);
+            chainExit(end + u.imm);
+            hasTerminator = true;
+            break;
+        }
+
+        case OP_BLR:
+            readInto(RDX, u.rn, true);      // 先读目标：BLR X30 跳到原来的X30
+            e.movImm64(RAX, end);
+            writeReg(30, RAX);
+            writeBack();
+            storeLastPC(end - 4);
+            hasTerminator = true;
+            break;
+
+        case OP_BR:
+        case OP_RET:
+            readInto(RDX, opcode == OP_BR ? u.rn : 30, true);
+            writeBack();
+            storeLastPC(end - 4);
+            hasTerminator = true;
+            break;
+
+        case OP_SYS:
+            if (u.rm != SYS_NOP) return nullptr;
+            flagsAfter = hostFlags;
+            break;
+
+        default:
+            return nullptr;     // 无法编译，由解释器执行
+        }
+        hostFlags = flagsAfter;
+    }
+
+    // 没有分支结尾：停在HLT处，或顺序执行到下一块
+    if (!hasTerminator) {
+        if (halts) {
+            writeBack();
+            storeLastPC(end - 8);
+            e.movImm64(RDX, end - 4);
+        } else {
+            chainExit(end);
+        }
+    }
+
+    // 尾声：rdx = 下一条指令地址
+    const size_t epilogue = e.pos();
+    e.store(true, ctxField(offsetof(JitContext, nextPC)), RDX);
+    e.store(true, ctxField(offsetof(JitContext, remaining)), REG_BUDGET);
+    for (size_t k = sizeof(SAVED) / sizeof(SAVED[0]); k-- > 0;) e.pop(SAVED[k]);
+    e.ret();
+
+    // 进入检查失败：一条也未执行，寄存器尚未载入
+    for (size_t at : entryFails) e.bindHere(at);
+    e.movImm64(RDX, start);
+    e.jmpTo(epilogue);
+
+    // 循环检查失败：上一轮已完整执行
+    for (size_t at : loopFails) e.bindHere(at);
+    writeBack();
+    storeLastPC(end - 4);
+    e.movImm64(RDX, start);
+    e.jmpTo(epilogue);
+
+    // 提前退出：退还未执行指令的步数
+    for (const Exit& x : exits) {
+        e.bindHere(x.at);
+        writeBack();
+        if (body != x.executed) e.aluRI(0, true, REG_BUDGET, static_cast<int32_t>(body - x.executed));
+        if (x.executed != 0) storeLastPC(start + (x.executed - 1) * 4);
+        if (x.fault) e.movMemImm8(ctxField(offsetof(JitContext, fault)), 1);
+        e.movImm64(RDX, x.pc);
+        e.jmpTo(epilogue);
+    }
+
+    // 未链接的出口：报告jmp的位置，由调用者链接
+    for (const ChainSite& c : chainSites) {
+        e.bindHere(c.at);
+        e.leaRip(RAX, c.at);
+        e.store(true, ctxField(offsetof(JitContext, chainSite)), RAX);
+        e.movImm64(RDX, c.target);
+        e.jmpTo(epilogue);
+    }
+
+    if (used + e.code.size() > capacity) {
+        outOfSpace = true;
+        return nullptr;
+    }
+    uint8_t* dst = buffer + used;
+    std::memcpy(dst, e.code.data(), e.code.size());
+    used += (e.code.size() + 15) & ~size_t(15);
+    entry = dst + entryOffset;
+    return reinterpret_cast<BlockFn>(dst);
+}
+
+void JitX64::link(uint8_t* site, const uint8_t* entry) {
+    int32_t rel = static_cast<int32_t>(entry - (site + 4));
+    std::memcpy(site, &rel, sizeof(rel));
+}
+
+// ========================== CPU接口 ==========================
+
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::flushJit() {
+    jit->reset();
+    for (auto& entry : blockCache) {
+        entry.second->jitCode = nullptr;
+        entry.second->jitEntry = nullptr;
+        entry.second->hotness = 0;
+    }
+}
+
+// 本地代码沿已链接的出口在块间直接跳转，只在未链接的出口、间接分支、提前退出、
+// 预算不足或块过期时返回；返回后按PC重新查块，并把未链接的出口链接到该块
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::executeJit(uint64_t& remaining) {
+    if constexpr (Hooks::ENABLED || !Memory::CONTIGUOUS || Memory::FAULTS_BY_SIGNAL || Config::MMU) {
+        // 本地代码不调用钩子，需要逐条观察时按基本块解释执行；本地代码以基址+偏移访存，需要连续内存、不能从信号恢复，也不做地址转换
+        return executeBlocks(remaining);
+    }
+    if (!jit) {
+        jit = std::make_unique<JitX64>();
+    }
+    if (!jit->available()) {
+        return executeBlocks(remaining);
+    }
+
+    BasicBlock* block = nullptr;
+    uint8_t* pendingSite = nullptr;     // 上一次返回时未链接出口的jmp，目标为当前PC
+
+    while (remaining != 0) {
+        if (block == nullptr) {
+            block = lookupBlock(PC);
+            if (block == nullptr) {     // PC未对齐或越界，交给逐条解释
+                pendingSite = nullptr;
+                uint64_t one = 1;
+                StopReason reason = interpret<false>(one, 0);
+                remaining -= 1 - one;
+                if (reason != StopReason::STEP_LIMIT) return reason;
+                continue;
+            }
+        }
+
+        size_t count = block->count;
+        if (count > remaining) {
+            return interpret<false>(remaining, 0);
+        }
+
+        if (block->jitCode == nullptr && !block->jitFailed && ++block->hotness >= JIT_THRESHOLD) {
+            block->jitCode = jit->compile(*this, block->ops.data(), count, block->start, block->halts, block->jitEntry);
+            if (block->jitCode == nullptr && jit->full()) {    // 代码区已满：清空后重试一次
+                flushJit();
+                pendingSite = nullptr;
+                block->jitCode = jit->compile(*this, block->ops.data(), count, block->start, block->halts, block->jitEntry);
+            }
+            block->jitFailed = (block->jitCode == nullptr);
+        }
+
+        if (block->jitCode == nullptr) {
+            // 解释执行：预算恰好是这一个块
+            pendingSite = nullptr;
+            uint64_t budget = count;
+            StopReason reason = executeBlocks(budget);
+            remaining -= count - budget;
+            if (reason != StopReason::STEP_LIMIT) return reason;
+            block = nextBlock(block);
+            continue;
+        }
+
+        if (pendingSite != nullptr) {
+            JitX64::link(pendingSite, block->jitEntry);
+            pendingSite = nullptr;
+        }
+
+        materializeFlags();     // 本地代码直接读写 statusReg
+        JitContext ctx{regs.data(), jitMemoryBase(), reinterpret_cast<uint8_t*>(&statusReg), remaining, 0, ~0ull, nullptr, 0};
+        block->jitCode(&ctx);
+        remaining = ctx.remaining;
+        PC = ctx.nextPC;
+        if (ctx.lastPC != ~0ull) {
+            IR = readMemoryUnchecked<uint32_t>(ctx.lastPC);
+        }
+        block = nullptr;
+
+        if (ctx.fault) {
+            // 由解释器重新执行出错的指令，得到与 step() 相同的停止原因
+            uint64_t one = 1;
+            StopReason reason = interpret<false>(one, 0);
+            remaining -= 1 - one;
+            if (reason != StopReason::NONE && reason != StopReason::STEP_LIMIT) return reason;
+            continue;
+        }
+        pendingSite = ctx.chainSite;
+    }
+
+    return StopReason::STEP_LIMIT;
+}
+
+template<typename Config, typename Hooks>
+StopReason BasicCPU<Config, Hooks>::runJit(uint64_t maxSteps) {
+    uint64_t remaining = maxSteps;
+    StopReason reason = executeJit(remaining);
+    runSteps = maxSteps - remaining;
+    return reason;
+}
+
+#define INSTANTIATE_JIT(CONFIG, HOOKS) \
+    template JitX64::BlockFn JitX64::compile(const BasicCPU<CONFIG, HOOKS>& cpu, \
+        const BasicCPU<CONFIG, HOOKS>::MicroOp* ops, size_t count, uint64_t start, bool halts, uint8_t*& entry); \
+    template void BasicCPU<CONFIG, HOOKS>::flushJit(); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::executeJit(uint64_t& remaining); \
+    template StopReason BasicCPU<CONFIG, HOOKS>::runJit(uint64_t maxSteps);
+TINY_CPU_CONFIGS(INSTANTIATE_JIT)
+#undef INSTANTIATE_JIT
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "MicroOp.h"
+
+// ========================== x86-64 JIT ==========================
+
+// 本地代码与CPU之间交换的状态
+struct JitContext {
+    uint64_t* regs;     // 寄存器文件
+    uint8_t* memory;    // 客户机内存
+    uint8_t* flags;     // StatusRegister（N/Z/C/V各一个字节）
+    uint64_t remaining; // 进入时为步数预算，退出时为余量（链接的块在本地代码内逐块扣减）
+    uint64_t nextPC;    // 退出时下一条要执行的指令地址
+    uint64_t lastPC;    // 最后执行的指令地址；一条也未执行时保持进入时的值
+    uint8_t* chainSite; // 经尚未链接的直接分支出口退出时为该出口跳转的rel32，调用者据此链接后继块
+    uint8_t fault;      // 访存越界或除零：nextPC指向出错指令，由解释器重新执行以报告错误
+};
+
+// 将基本块翻译为x86-64本地代码
+// 块内使用多次的客户机寄存器分配到宿主寄存器，进入块时载入、退出时写回；标志位保存在
+// StatusRegister 中，条件分支紧随设置标志位的指令时直接使用宿主机的标志位。
+// 直接分支的出口在后继块编译后改写为跳到后继块的链接入口，跳回本块的循环不离开宿主寄存器。
+// 语义与 BasicCPU::aluExec / BasicCPU::checkCondition 保持逐位一致
+class JitX64 {
+public:
+    using BlockFn = void (*)(JitContext* ctx);
+
+    explicit JitX64(size_t capacity = 4 << 20);
+    ~JitX64();
+
+    JitX64(const JitX64&) = delete;
+    JitX64& operator=(const JitX64&) = delete;
+
+    // 宿主机为x86-64且成功分配了可执行内存
+    bool available() const { return buffer != nullptr; }
+
+    // 编译以start开始的count条微操作，entry 给出供其他块链接的入口；
+    // 无法编译或代码区已满时返回nullptr（full() 为真时需 reset() 后重试）
+    // Core 为 BasicCPU 的实例类型，在 JitX64.cpp 中按已发布的配置显式实例化
+    template<typename Core>
+    BlockFn compile(const Core& cpu, const typename Core::MicroOp* ops, size_t count, uint64_t start, bool halts,
+                    uint8_t*& entry);
+
+    // 把出口 site（JitContext::chainSite）改为直接跳到另一块的链接入口
+    static void link(uint8_t* site, const uint8_t* entry);
+
+    // 最近一次 compile() 因代码区已满而失败
+    bool full() const { return outOfSpace; }
+
+    // 丢弃全部已生成代码（链接随之失效）
+    void reset() { used = 0; outOfSpace = false; }
+
+private:
+    uint8_t* buffer = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    bool outOfSpace = false;
+};
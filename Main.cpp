@@ -5,6 +5,8 @@
 #include "Views/MemoryView.h"
 #include "Views/RegisterView.h"
 
+#include "Server.h"
+
 int screenW, screenH;
 
 // Dear ImGui: standalone example application for GLFW + OpenGL 3, using programmable pipeline
@@ -44,8 +46,15 @@ static void glfw_error_callback(int error, const char* description)
 }
 
 // Main code
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    // 无界面的执行服务：--serve <套接字路径> 或 --serve-stdio
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--serve" || arg == "--serve-stdio")
+            return serverMain(std::vector<std::string>(argv + 1, argv + argc));
+    }
+
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit())
         return 1;
@@ -223,6 +232,7 @@ int main(int, char**)
 #endif
 
     // Cleanup
+    ExecutionThread::GetInstance().stop();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -0,0 +1,256 @@
+#include <cstring>
+#include <algorithm>
+
+#include "MemoryScan.h"
+
+// 以 TINY_NO_SIMD_SCAN 构建时在 x86-64 上也使用标量实现
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(TINY_NO_SIMD_SCAN)
+#define TINY_SCAN_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TINY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#include <intrin.h>
+#define TINY_TARGET_AVX2
+#endif
+#endif
+
+// ========================== 向量化内核 ==========================
+// 内核只做宽比较：按32字节一块，把每块的比较结果压成一个32位掩码（第 j 位对应块内第 j 个字节），
+// 逐段（CHUNK_BLOCKS 块）写入调用者的数组；掩码到结果的转换与实现无关，由下面的公共代码完成
+
+static constexpr size_t BLOCK_BYTES = 32;
+static constexpr size_t CHUNK_BLOCKS = 128;     // 每次调用内核处理 4KB
+
+struct ScanKernels {
+    const char* name;
+    // masks[i] 的第 j 位：a 与 b 在 i * 32 + j 处不同；返回是否有任何不同
+    bool (*diff)(const uint8_t* a, const uint8_t* b, size_t blocks, uint32_t* masks);
+    // masks[i] 的第 j 位：p = i * 32 + j 处 data[p] == first 且 data[p + lastOffset] == last
+    // （调用者保证读取不越界）；返回是否有任何候选位置
+    bool (*match)(const uint8_t* data, size_t blocks, uint8_t first, uint8_t last, size_t lastOffset, uint32_t* masks);
+};
+
+#ifndef TINY_SCAN_X86
+// ====================== 标量 ======================
+static uint32_t byteMask(const uint8_t* data, uint8_t value) {
+    uint32_t mask = 0;
+    for (size_t j = 0; j < BLOCK_BYTES; ++j) mask |= static_cast<uint32_t>(data[j] == value) << j;
+    return mask;
+}
+
+static bool diffScalar(const uint8_t* a, const uint8_t* b, size_t blocks, uint32_t* masks) {
+    bool any = false;
+    for (size_t i = 0; i < blocks; ++i, a += BLOCK_BYTES, b += BLOCK_BYTES) {
+        uint32_t mask = 0;
+        for (size_t w = 0; w < BLOCK_BYTES; w += 8) {
+            uint64_t x, y;
+            std::memcpy(&x, a + w, 8);
+            std::memcpy(&y, b + w, 8);
+            if (x == y) continue;
+            for (size_t j = w; j < w + 8; ++j) mask |= static_cast<uint32_t>(a[j] != b[j]) << j;
+        }
+        masks[i] = mask;
+        any |= mask != 0;
+    }
+    return any;
+}
+
+static bool matchScalar(const uint8_t* data, size_t blocks, uint8_t first, uint8_t last, size_t lastOffset, uint32_t* masks) {
+    bool any = false;
+    for (size_t i = 0; i < blocks; ++i, data += BLOCK_BYTES) {
+        uint32_t mask = byteMask(data, first);
+        if (mask != 0) mask &= byteMask(data + lastOffset, last);
+        masks[i] = mask;
+        any |= mask != 0;
+    }
+    return any;
+}
+
+#else
+// ====================== SSE2 ======================
+// x86-64 的基线指令集，总是可用；两个16字节比较拼成一块的掩码
+static inline uint32_t eqMaskSse2(const uint8_t* a, __m128i lo, __m128i hi) {
+    uint32_t low = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)), lo)));
+    uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16)), hi)));
+    return low | (high << 16);
+}
+
+static bool diffSse2(const uint8_t* a, const uint8_t* b, size_t blocks, uint32_t* masks) {
+    bool any = false;
+    for (size_t i = 0; i < blocks; ++i, a += BLOCK_BYTES, b += BLOCK_BYTES) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16));
+        uint32_t mask = ~eqMaskSse2(a, lo, hi);
+        masks[i] = mask;
+        any |= mask != 0;
+    }
+    return any;
+}
+
+static bool matchSse2(const uint8_t* data, size_t blocks, uint8_t first, uint8_t last, size_t lastOffset, uint32_t* masks) {
+    const __m128i f = _mm_set1_epi8(static_cast<char>(first));
+    const __m128i l = _mm_set1_epi8(static_cast<char>(last));
+    bool any = false;
+    for (size_t i = 0; i < blocks; ++i, data += BLOCK_BYTES) {
+        uint32_t mask = eqMaskSse2(data, f, f);
+        if (mask != 0) mask &= eqMaskSse2(data + lastOffset, l, l);
+        masks[i] = mask;
+        any |= mask != 0;
+    }
+    return any;
+}
+
+// ====================== AVX2 ======================
+// 只在运行时检测到AVX2时调用
+TINY_TARGET_AVX2 static bool diffAvx2(const uint8_t* a, const uint8_t* b, size_t blocks, uint32_t* masks) {
+    bool any = false;
+    for (size_t i = 0; i < blocks; ++i, a += BLOCK_BYTES, b += BLOCK_BYTES) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        masks[i] = mask;
+        any |= mask != 0;
+    }
+    return any;
+}
+
+TINY_TARGET_AVX2 static bool matchAvx2(const uint8_t* data, size_t blocks, uint8_t first, uint8_t last, size_t lastOffset, uint32_t* masks) {
+    const __m256i f = _mm256_set1_epi8(static_cast<char>(first));
+    const __m256i l = _mm256_set1_epi8(static_cast<char>(last));
+    bool any = false;
+    for (size_t i = 0; i < blocks; ++i, data += BLOCK_BYTES) {
+        __m256i head = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), f);
+        __m256i tail = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + lastOffset)), l);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(head, tail)));
+        masks[i] = mask;
+        any |= mask != 0;
+    }
+    return any;
+}
+
+static bool hasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;   // OSXSAVE 且操作系统保存YMM状态
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#endif
+}
+#endif
+
+static const ScanKernels& kernels() {
+    static const ScanKernels selected = [] {
+#ifdef TINY_SCAN_X86
+        if (hasAvx2()) return ScanKernels{"avx2", diffAvx2, matchAvx2};
+        return ScanKernels{"sse2", diffSse2, matchSse2};
+#else
+        return ScanKernels{"scalar", diffScalar, matchScalar};
+#endif
+    }();
+    return selected;
+}
+
+const char* memoryScanImplementation() {
+    return kernels().name;
+}
+
+// ====================== 查找 ======================
+static inline int lowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#else
+    int bit = 0;
+    while (!(mask & 1)) { mask >>= 1; ++bit; }
+    return bit;
+#endif
+}
+
+// 按首末字节筛出候选位置，再逐个比较完整的模式
+std::vector<uint64_t> findBytes(MemorySpan memory, const uint8_t* pattern, size_t length, size_t alignment, size_t maxResults) {
+    std::vector<uint64_t> results;
+    const size_t size = memory.size();
+    if (length == 0 || length > size || maxResults == 0) return results;
+    if (alignment == 0 || alignment > 8 || (alignment & (alignment - 1)) != 0) alignment = 1;
+
+    const uint8_t* data = memory.data();
+    const uint8_t first = pattern[0], last = pattern[length - 1];
+    const size_t lastOffset = length - 1;
+    const size_t positions = size - length + 1;     // 可能的起始位置数
+    uint32_t alignMask = 0;
+    for (size_t j = 0; j < BLOCK_BYTES; j += alignment) alignMask |= 1u << j;
+
+    auto accept = [&](uint64_t p) {
+        if (std::memcmp(data + p, pattern, length) != 0) return false;
+        results.push_back(p);
+        return results.size() == maxResults;
+    };
+
+    // 整块部分：块内每个位置加上 lastOffset 都不越界
+    const ScanKernels& k = kernels();
+    uint32_t masks[CHUNK_BLOCKS];
+    size_t pos = 0;
+    while (positions - pos >= BLOCK_BYTES) {
+        size_t blocks = std::min(CHUNK_BLOCKS, (positions - pos) / BLOCK_BYTES);
+        if (k.match(data + pos, blocks, first, last, lastOffset, masks)) {
+            for (size_t i = 0; i < blocks; ++i) {
+                for (uint32_t mask = masks[i] & alignMask; mask != 0; mask &= mask - 1) {
+                    if (accept(pos + i * BLOCK_BYTES + lowestBit(mask))) return results;
+                }
+            }
+        }
+        pos += blocks * BLOCK_BYTES;
+    }
+    for (; pos < positions; ++pos) {
+        if (pos % alignment == 0 && data[pos] == first && accept(pos)) return results;
+    }
+    return results;
+}
+
+std::vector<uint64_t> findValue(MemorySpan memory, uint64_t value, size_t width, bool aligned, size_t maxResults) {
+    uint8_t pattern[8];
+    for (size_t i = 0; i < 8; ++i) pattern[i] = static_cast<uint8_t>(value >> (i * 8));
+    width = std::min<size_t>(std::max<size_t>(width, 1), 8);
+    return findBytes(memory, pattern, width, aligned ? width : 1, maxResults);
+}
+
+// ====================== 比较 ======================
+static void appendRange(std::vector<MemoryRange>& ranges, uint64_t offset, uint64_t size) {
+    if (!ranges.empty() && ranges.back().offset + ranges.back().size == offset) {
+        ranges.back().size += size;
+    } else {
+        ranges.push_back(MemoryRange{offset, size});
+    }
+}
+
+void diffMemory(MemorySpan a, MemorySpan b, uint64_t base, std::vector<MemoryRange>& ranges) {
+    const size_t size = std::min(a.size(), b.size());
+    const uint8_t* x = a.data();
+    const uint8_t* y = b.data();
+    const ScanKernels& k = kernels();
+    uint32_t masks[CHUNK_BLOCKS];
+
+    size_t pos = 0;
+    while (size - pos >= BLOCK_BYTES) {
+        size_t blocks = std::min(CHUNK_BLOCKS, (size - pos) / BLOCK_BYTES);
+        if (k.diff(x + pos, y + pos, blocks, masks)) {
+            for (size_t i = 0; i < blocks; ++i) {
+                // 掩码中连续的1即为一段不同的字节
+                uint64_t mask = masks[i];
+                while (mask != 0) {
+                    int start = lowestBit(mask);
+                    int length = lowestBit(~(mask >> start));   // 掩码只有低32位，取反后必有1
+                    appendRange(ranges, base + pos + i * BLOCK_BYTES + start, length);
+                    mask &= ~(((1ULL << length) - 1) << start);
+                }
+            }
+        }
+        pos += blocks * BLOCK_BYTES;
+    }
+    for (; pos < size; ++pos) {
+        if (x[pos] != y[pos]) appendRange(ranges, base + pos, 1);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "GuestMemory.h"
+
+// ========================== 内存搜索与比较 ==========================
+// 供调试界面在整块客户机内存上查找值与比较两份内存映像。x86-64 上按 AVX2（运行时检测）或 SSE2 每次处理
+// 32/16 字节，其他平台使用逐字（8字节）比较的标量实现；结果与实现无关。
+// 输入为不复制的 MemorySpan（见 BasicCPU::viewMemory()），偏移均相对于 span 起点
+
+// 内存中的一段字节 [offset, offset + size)
+struct MemoryRange {
+    uint64_t offset;
+    uint64_t size;
+};
+
+// pattern 在 memory 中出现的位置（升序），至多 maxResults 个；alignment（1/2/4/8）为1时报告任意位置，
+// 否则只报告按它对齐的位置（相对于 memory 起点）
+std::vector<uint64_t> findBytes(MemorySpan memory, const uint8_t* pattern, size_t length,
+                                size_t alignment = 1, size_t maxResults = SIZE_MAX);
+
+// 按小端查找 width（1/2/4/8）字节宽的 value；aligned 为 true 时只报告按 width 对齐的位置
+std::vector<uint64_t> findValue(MemorySpan memory, uint64_t value, size_t width,
+                                bool aligned = true, size_t maxResults = SIZE_MAX);
+
+// 比较等长的 a 与 b，把内容不同的区间（偏移加上 base）追加到 ranges；
+// 与 ranges 末项相接的区间并入末项，因此可以按地址顺序逐页调用
+void diffMemory(MemorySpan a, MemorySpan b, uint64_t base, std::vector<MemoryRange>& ranges);
+
+inline std::vector<MemoryRange> diffMemory(MemorySpan a, MemorySpan b) {
+    std::vector<MemoryRange> ranges;
+    diffMemory(a, b, 0, ranges);
+    return ranges;
+}
+
+// 当前使用的实现："avx2"、"sse2" 或 "scalar"
+const char* memoryScanImplementation();
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+#include "Enums.h"
+
+// ========================== 预译码微操作 ==========================
+
+// 预译码后的指令：寄存器编号已解析、立即数已符号扩展、执行函数已绑定
+// 固定16字节，一个4KB代码页对应1024个微操作
+// Core 为执行它的 BasicCPU 类型，执行函数按CPU的配置与钩子分别实例化
+template<typename Core>
+struct BasicMicroOp {
+    using Handler = StopReason (*)(Core& cpu, const BasicMicroOp& uop);  // 正常执行返回 StopReason::NONE
+
+    Handler handler;  // 执行函数
+    int32_t imm;      // 符号扩展后的立即数（分支指令为已左移2位的字节偏移）
+    uint8_t index;    // 分派索引：(sf << 5) | opcode；融合序列的首条为 FUSED_INDEX_BASE + 融合编号
+    uint8_t rd;       // 目的寄存器 / Rt
+    uint8_t rn;       // 第一源寄存器 / 基址寄存器
+    uint8_t rm;       // 第二源寄存器 / 分支条件 / 系统指令子操作码
+};
+
+// ====================== 操作数解码 ======================
+// 系统指令按子操作码索引，未定义的子操作码按HLT执行
+constexpr std::array<uint8_t, 256> makeSystemSubops() {
+    std::array<uint8_t, 256> subops{};
+    for (const SystemInstrInfo& info : SYSTEM_ISA_INFO) {
+        subops[info.subop] = info.subop;
+    }
+    return subops;
+}
+inline constexpr std::array<uint8_t, 256> SYSTEM_SUBOPS = makeSystemSubops();
+static_assert(SYS_HLT == 0, "undefined system sub-ops fall back to HLT");
+
+// 指令字按操作数格式解出的字段，含义同 BasicMicroOp（预译码与 SIMT.h 共用）
+struct DecodedInstr {
+    int32_t imm;
+    uint8_t index;
+    uint8_t rd;
+    uint8_t rn;
+    uint8_t rm;
+};
+
+inline DecodedInstr decodeInstr(uint32_t ir) {
+    DecodedInstr d{};
+    d.index = (ir >> 26) & 0x3F;
+    d.rd = (ir >> 21) & 0x1F;
+    d.rn = (ir >> 16) & 0x1F;
+    d.rm = ir & 0x1F;
+    d.imm = static_cast<int16_t>(ir & 0xFFFF);
+
+    // 按操作数格式把操作数统一放到 rd/rn/rm/imm 中
+    switch (ISA_INFO[d.index & 0x1F].format) {
+    case InstrFormat::CMP_RR:
+        d.rm = d.rn;
+        d.rn = d.rd;
+        break;
+    case InstrFormat::CMP_RI:
+    case InstrFormat::REG:
+        d.rn = d.rd;
+        break;
+    case InstrFormat::COND_LABEL:
+        d.rm = (ir >> 22) & 0x0F;
+        d.imm *= 4;
+        break;
+    case InstrFormat::LABEL:
+        d.imm *= 4;
+        break;
+    case InstrFormat::SYS:
+        // 子操作码放在 rm 中
+        d.rm = SYSTEM_SUBOPS[(ir >> 8) & 0xFF];
+        break;
+    default:
+        break;
+    }
+    return d;
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+#include "CPU.h"
+
+// 微操作执行函数的定义放在头文件中，
+// 以便逐条调用的 step() 与直接线程化的 run() 都能内联它们。
+// 错误不抛出异常而是返回停止原因，不会出错的执行函数恒返回 NONE，内联后检查被消除
+// 分支执行时 PC 已指向分支指令之后（基本块执行时末条指令前PC被置为块尾），钩子据此得到分支地址
+
+// ====================== 微操作执行函数 ======================
+template<typename Config, typename Hooks>
+template<ALUOp Op, bool Is64, bool Imm>
+inline StopReason BasicCPU<Config, Hooks>::uopALU(BasicCPU& cpu, const MicroOp& u) {
+    uint64_t b = Imm ? static_cast<uint64_t>(static_cast<int64_t>(u.imm)) : cpu.readReg<Is64>(u.rm);
+    if constexpr (Op == ALUOp::SDIV || Op == ALUOp::UDIV) {
+        if (b == 0) return StopReason::DIVIDE_BY_ZERO;
+    }
+    cpu.aluExec<Op, Is64>(u.rd, cpu.readReg<Is64>(u.rn), b);
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+template<bool Is64>
+inline StopReason BasicCPU<Config, Hooks>::uopMov(BasicCPU& cpu, const MicroOp& u) {
+    cpu.writeReg<Is64>(u.rd, cpu.readReg<Is64>(u.rn));
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+template<bool Is64>
+inline StopReason BasicCPU<Config, Hooks>::uopMovImm(BasicCPU& cpu, const MicroOp& u) {
+    cpu.writeReg<Is64>(u.rd, static_cast<uint64_t>(static_cast<int64_t>(u.imm)));
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+template<typename T, bool Is64>
+inline StopReason BasicCPU<Config, Hooks>::uopLoad(BasicCPU& cpu, const MicroOp& u) {
+    uint64_t address = cpu.readReg<Is64>(u.rn) + static_cast<int64_t>(u.imm);
+    if (!cpu.dataAddress<T, MemoryAccess::READ>(address)) {
+        return cpu.memoryFault(MemoryAccess::READ, address);
+    }
+    cpu.hooks.onMemoryAccess(MemoryAccess::READ, address, sizeof(T));
+    cpu.writeReg<Is64>(u.rd, cpu.readMemoryUnchecked<T>(address));
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+template<typename T, bool Is64>
+inline StopReason BasicCPU<Config, Hooks>::uopStore(BasicCPU& cpu, const MicroOp& u) {
+    uint64_t address = cpu.readReg<Is64>(u.rn) + static_cast<int64_t>(u.imm);
+    if (!cpu.dataAddress<T, MemoryAccess::WRITE>(address)) {
+        return cpu.memoryFault(MemoryAccess::WRITE, address);
+    }
+    cpu.hooks.onMemoryAccess(MemoryAccess::WRITE, address, sizeof(T));
+    cpu.writeMemoryUnchecked<T>(address, static_cast<T>(cpu.readReg<Is64>(u.rd)));
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopB(BasicCPU& cpu, const MicroOp& u) {
+    cpu.hooks.onBranch(cpu.PC - 4, cpu.PC + static_cast<int64_t>(u.imm), true);
+    cpu.PC += static_cast<int64_t>(u.imm);
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopBCond(BasicCPU& cpu, const MicroOp& u) {
+    bool taken = cpu.checkCondition(static_cast<BranchCondition>(u.rm));
+    cpu.hooks.onBranch(cpu.PC - 4, taken ? cpu.PC + static_cast<int64_t>(u.imm) : cpu.PC, taken);
+    if (taken) {
+        cpu.PC += static_cast<int64_t>(u.imm);
+    }
+    return StopReason::NONE;
+}
+
+// 融合序列 CMP + B.cond 中的条件分支：前一条必为同位宽的CMP，标志位按减法直接求值，不经过 nzcv() 的分派
+template<typename Config, typename Hooks>
+template<bool Is64>
+inline StopReason BasicCPU<Config, Hooks>::uopBCondAfterCmp(BasicCPU& cpu, const MicroOp& u) {
+    using U = std::conditional_t<Is64, uint64_t, uint32_t>;
+    bool taken = (conditionMask(static_cast<BranchCondition>(u.rm)) >> cpu.arithNZCV<U, true>()) & 1;
+    cpu.hooks.onBranch(cpu.PC - 4, taken ? cpu.PC + static_cast<int64_t>(u.imm) : cpu.PC, taken);
+    if (taken) {
+        cpu.PC += static_cast<int64_t>(u.imm);
+    }
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopBL(BasicCPU& cpu, const MicroOp& u) {
+    cpu.hooks.onBranch(cpu.PC - 4, cpu.PC + static_cast<int64_t>(u.imm), true);
+    cpu.regs[30] = cpu.PC;  // 保存返回地址到LR (X30)
+    cpu.PC += static_cast<int64_t>(u.imm);
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopBLR(BasicCPU& cpu, const MicroOp& u) {
+    uint64_t target = cpu.regs[u.rn];
+    cpu.hooks.onBranch(cpu.PC - 4, target, true);
+    cpu.regs[30] = cpu.PC;
+    cpu.PC = target;
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopBR(BasicCPU& cpu, const MicroOp& u) {
+    cpu.hooks.onBranch(cpu.PC - 4, cpu.regs[u.rn], true);
+    cpu.PC = cpu.regs[u.rn];
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopRet(BasicCPU& cpu, const MicroOp& /*u*/) {
+    cpu.hooks.onBranch(cpu.PC - 4, cpu.regs[30], true);
+    cpu.PC = cpu.regs[30];
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopHlt(BasicCPU& /*cpu*/, const MicroOp& /*u*/) {
+    return StopReason::HALT;
+}
+
+// 预译码已按子操作码绑定具体的执行函数，这里只在直接按 HANDLERS 分派时使用
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopSystem(BasicCPU& cpu, const MicroOp& u) {
+    return SYSTEM_HANDLERS[u.rm](cpu, u);
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopNop(BasicCPU& /*cpu*/, const MicroOp& /*u*/) {
+    return StopReason::NONE;
+}
+
+// 批量内存指令：寄存器在预译码时放在 rd、rn 与 imm 的低5位
+template<typename Config, typename Hooks>
+template<MopsStage Stage>
+inline StopReason BasicCPU<Config, Hooks>::uopCpy(BasicCPU& cpu, const MicroOp& u) {
+    return cpu.bulkCopy(Stage, u.rd, u.rn, static_cast<uint8_t>(u.imm & 0x1F));
+}
+
+template<typename Config, typename Hooks>
+template<MopsStage Stage>
+inline StopReason BasicCPU<Config, Hooks>::uopSet(BasicCPU& cpu, const MicroOp& u) {
+    return cpu.bulkSet(Stage, u.rd, u.rn, static_cast<uint8_t>(u.imm & 0x1F));
+}
+
+// ====================== 多核同步指令 ======================
+// 寄存器在预译码时放在 rd、rn 与 imm 的低5位；sf 选择32/64位，地址寄存器总是按64位读取
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopLdxr(BasicCPU& cpu, const MicroOp& u) {
+    return (u.index & 0x20) ? cpu.exclusiveLoad<uint64_t>(u.rd, u.rn) : cpu.exclusiveLoad<uint32_t>(u.rd, u.rn);
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopStxr(BasicCPU& cpu, const MicroOp& u) {
+    uint8_t rn = static_cast<uint8_t>(u.imm & 0x1F);
+    return (u.index & 0x20) ? cpu.exclusiveStore<uint64_t>(u.rd, u.rn, rn) : cpu.exclusiveStore<uint32_t>(u.rd, u.rn, rn);
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopLdadd(BasicCPU& cpu, const MicroOp& u) {
+    uint8_t rn = static_cast<uint8_t>(u.imm & 0x1F);
+    return (u.index & 0x20) ? cpu.atomicAdd<uint64_t>(u.rd, u.rn, rn) : cpu.atomicAdd<uint32_t>(u.rd, u.rn, rn);
+}
+
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopCas(BasicCPU& cpu, const MicroOp& u) {
+    uint8_t rn = static_cast<uint8_t>(u.imm & 0x1F);
+    return (u.index & 0x20) ? cpu.compareAndSwap<uint64_t>(u.rd, u.rn, rn) : cpu.compareAndSwap<uint32_t>(u.rd, u.rn, rn);
+}
+
+// 普通访存不是原子的，核之间的顺序只由原子指令与 DMB 保证
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopDmb(BasicCPU& /*cpu*/, const MicroOp& /*u*/) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return StopReason::NONE;
+}
+
+// 未定义的系统寄存器读出为0
+template<typename Config, typename Hooks>
+inline StopReason BasicCPU<Config, Hooks>::uopMrs(BasicCPU& cpu, const MicroOp& u) {
+    cpu.regs[u.rd] = (u.imm & 0x1F) == SYSREG_MPIDR ? cpu.coreId : 0;
+    return StopReason::NONE;
+}
+
+template<typename Config, typename Hooks>
+template<typename T>
+inline StopReason BasicCPU<Config, Hooks>::exclusiveLoad(uint8_t rt, uint8_t rn) {
+    uint64_t address = regs[rn];
+    if (!atomicAddress<T, MemoryAccess::READ>(address)) {
+        return memoryFault(MemoryAccess::READ, regs[rn]);
+    }
+    hooks.onMemoryAccess(MemoryAccess::READ, address, sizeof(T));
+    T value = atomicRead<T>(address);
+    exclusiveAddress = address;
+    exclusiveValue = value;
+    exclusiveSize = sizeof(T);
+    writeReg<sizeof(T) == 8>(rt, value);
+    return StopReason::NONE;
+}
+
+// Ws 写入0表示成功，1表示失败
+template<typename Config, typename Hooks>
+template<typename T>
+inline StopReason BasicCPU<Config, Hooks>::exclusiveStore(uint8_t rs, uint8_t rt, uint8_t rn) {
+    uint64_t address = regs[rn];
+    if (!atomicAddress<T, MemoryAccess::WRITE>(address)) {
+        return memoryFault(MemoryAccess::WRITE, regs[rn]);
+    }
+    bool stored = false;
+    if (exclusiveAddress == address && exclusiveSize == sizeof(T)) {
+        hooks.onMemoryAccess(MemoryAccess::WRITE, address, sizeof(T));
+        T expected = static_cast<T>(exclusiveValue);
+        stored = atomicCompareExchange<T>(address, expected, static_cast<T>(regs[rt]));
+    }
+    exclusiveAddress = NO_EXCLUSIVE;
+    writeReg<false>(rs, stored ? 0 : 1);
+    return StopReason::NONE;
+}
+
+// LDADD Rs, Rt, [Xn]：[Xn] += Rs，Rt 为原值
+template<typename Config, typename Hooks>
+template<typename T>
+inline StopReason BasicCPU<Config, Hooks>::atomicAdd(uint8_t rs, uint8_t rt, uint8_t rn) {
+    uint64_t address = regs[rn], check = regs[rn];
+    if (!atomicAddress<T, MemoryAccess::READ>(check)) return memoryFault(MemoryAccess::READ, regs[rn]);
+    if (!atomicAddress<T, MemoryAccess::WRITE>(address)) return memoryFault(MemoryAccess::WRITE, regs[rn]);
+    hooks.onMemoryAccess(MemoryAccess::READ, address, sizeof(T));
+    hooks.onMemoryAccess(MemoryAccess::WRITE, address, sizeof(T));
+    T old = atomicFetchAdd<T>(address, static_cast<T>(regs[rs]));
+    writeReg<sizeof(T) == 8>(rt, old);
+    return StopReason::NONE;
+}
+
+// CAS Rs, Rt, [Xn]：[Xn] 等于 Rs 时写入 Rt；Rs 总是得到原值
+template<typename Config, typename Hooks>
+template<typename T>
+inline StopReason BasicCPU<Config, Hooks>::compareAndSwap(uint8_t rs, uint8_t rt, uint8_t rn) {
+    uint64_t address = regs[rn], check = regs[rn];
+    if (!atomicAddress<T, MemoryAccess::READ>(check)) return memoryFault(MemoryAccess::READ, regs[rn]);
+    if (!atomicAddress<T, MemoryAccess::WRITE>(address)) return memoryFault(MemoryAccess::WRITE, regs[rn]);
+    hooks.onMemoryAccess(MemoryAccess::READ, address, sizeof(T));
+    T expected = static_cast<T>(regs[rs]);
+    if (atomicCompareExchange<T>(address, expected, static_cast<T>(regs[rt]))) {
+        hooks.onMemoryAccess(MemoryAccess::WRITE, address, sizeof(T));
+    }
+    writeReg<sizeof(T) == 8>(rs, expected);
+    return StopReason::NONE;
+}
@@ -0,0 +1,160 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+
+// ========================== 软件MMU测试 ==========================
+// VirtualConfig 下代码与数据都映射到 VA_BASE 起的虚拟页（物理页在别处，虚拟地址与物理地址不同）：
+//   第0页 代码  R|X      第1页 数据 R|W      第2页 只读 R      第3页 不可执行 R|W
+//   第4页 未映射         第5页 只可执行 X
+// 每个用例先做一次允许的读写，再执行一条违反权限的指令：run / runBlocks / runJit 与逐条 step()
+// 都须报告 MEMORY_FAULT，出错地址为虚拟地址，访问类型与违反的权限一致。全部通过时返回0
+
+namespace {
+
+using Core = BasicCPU<VirtualConfig, NoHooks>;
+
+const uint64_t MAX_STEPS = 1000;
+const uint64_t VA_BASE = 64ULL << 30;   // 第1级表的第64项
+const uint64_t PAGE_TABLES = 0x80000;   // 第0~3级表依次占用的物理页
+const uint64_t DATA_PHYSICAL = 0x10000; // 第1~5页的物理地址从这里开始
+
+struct Mapping {
+    uint64_t page;          // VA_BASE 起的虚拟页序号
+    uint64_t physical;
+    uint64_t permissions;
+};
+
+const Mapping MAPPINGS[] = {
+    {0, 0x0000,                PTE_READ | PTE_EXEC},
+    {1, DATA_PHYSICAL,         PTE_READ | PTE_WRITE},
+    {2, DATA_PHYSICAL + 0x1000, PTE_READ},
+    {3, DATA_PHYSICAL + 0x2000, PTE_READ | PTE_WRITE},
+    {5, DATA_PHYSICAL + 0x4000, PTE_EXEC},
+};
+
+struct FaultCase {
+    const char* name;
+    const char* instruction;    // x8 = VA_BASE，x9 = 不可执行页的地址
+    uint64_t address;           // 出错的虚拟地址
+    MemoryAccess access;
+};
+
+const FaultCase CASES[] = {
+    {"write to a read-only page",        "str x1, [x8, #0x2010]", VA_BASE + 0x2010, MemoryAccess::WRITE},
+    {"write to the code page",           "str x1, [x8, #0x100]",  VA_BASE + 0x100,  MemoryAccess::WRITE},
+    {"read from an execute-only page",   "ldr x3, [x8, #0x5008]", VA_BASE + 0x5008, MemoryAccess::READ},
+    {"read from an unmapped page",       "ldr x3, [x8, #0x4000]", VA_BASE + 0x4000, MemoryAccess::READ},
+    {"write to an unmapped page",        "str x1, [x8, #0x4ff8]", VA_BASE + 0x4FF8, MemoryAccess::WRITE},
+    {"execute a non-executable page",    "br x9",                 VA_BASE + 0x3000, MemoryAccess::FETCH},
+};
+
+std::vector<uint32_t> assembleQuietly(const std::string& text) {
+    Assembler assembler;
+    assembler.setVerbose(false);
+    return assembler.assemble(text);
+}
+
+void write64(Core& cpu, uint64_t address, uint64_t value) {
+    std::vector<uint8_t> bytes(sizeof(value));
+    std::memcpy(bytes.data(), &value, sizeof(value));
+    cpu.writeMemoryRange(address, bytes);
+}
+
+uint64_t read64(const Core& cpu, uint64_t address) {
+    std::vector<uint8_t> bytes = cpu.readMemoryRange(address, sizeof(uint64_t));
+    uint64_t value;
+    std::memcpy(&value, bytes.data(), sizeof(value));
+    return value;
+}
+
+// 复位后装入程序并建立页表，从 VA_BASE 开始执行
+void prepare(Core& cpu, const std::vector<uint32_t>& program) {
+    cpu.reset();
+    cpu.loadProgram(program);
+    for (int level = 0; level < 3; ++level) {
+        const uint64_t index = level == 1 ? (VA_BASE >> 30) & 511 : 0;
+        write64(cpu, PAGE_TABLES + level * 0x1000 + index * 8, (PAGE_TABLES + (level + 1) * 0x1000) | PTE_VALID);
+    }
+    for (const Mapping& m : MAPPINGS) {
+        write64(cpu, PAGE_TABLES + 3 * 0x1000 + m.page * 8, m.physical | m.permissions | PTE_VALID);
+    }
+    cpu.setTranslationTable(PAGE_TABLES);
+    cpu.setReg(8, VA_BASE);
+    cpu.setReg(9, VA_BASE + 0x3000);
+    cpu.setPC(VA_BASE);
+}
+
+int testCase(Core& cpu, const FaultCase& c) {
+    // 允许的访问：写第1页、读第2页
+    const std::vector<uint32_t> program = assembleQuietly(std::string(R"(
+        mov     x1, #77
+        str     x1, [x8, #0x1008]
+        ldr     x2, [x8, #0x2010]
+        )") + c.instruction + "\nHLT\n");
+    const uint64_t faultPC = VA_BASE + 3 * 4;
+
+    struct Engine {
+        const char* name;
+        StopReason (Core::*run)(uint64_t);
+    };
+    const Engine engines[] = {{"run", &Core::run}, {"runBlocks", &Core::runBlocks}, {"runJit", &Core::runJit}};
+
+    int failures = 0;
+    auto expect = [&](bool ok, const char* engine, const char* what) {
+        if (ok) return;
+        printf("  %s / %s: %s\n", c.name, engine, what);
+        ++failures;
+    };
+
+    for (const Engine& engine : engines) {
+        prepare(cpu, program);
+        write64(cpu, DATA_PHYSICAL + 0x1010, 0x5555);
+        StopReason reason = (cpu.*engine.run)(MAX_STEPS);
+        expect(reason == StopReason::MEMORY_FAULT, engine.name, cpu.describeStop(reason).c_str());
+        expect(cpu.getFaultAddress() == c.address, engine.name, "fault address is the virtual address");
+        expect(cpu.getFaultAccess() == c.access, engine.name, "fault access type");
+        // 取指错误在分支之后另计一步
+        expect(cpu.getRunSteps() == (c.access == MemoryAccess::FETCH ? 5u : 4u), engine.name, "faulting instruction is counted");
+        expect(read64(cpu, DATA_PHYSICAL + 0x8) == 77, engine.name, "store to a writable page reaches its physical page");
+        expect(cpu.getReg(2) == 0x5555, engine.name, "load from a readable page");
+        expect(read64(cpu, 0x2010) == 0 && read64(cpu, DATA_PHYSICAL + 0x1010) == 0x5555, engine.name,
+               "faulting store leaves memory unchanged");
+    }
+
+    // 逐条执行：出错指令抛出异常，PC与批量执行停止时相同
+    prepare(cpu, program);
+    uint64_t batchPC = 0;
+    {
+        auto reference = std::make_unique<Core>();
+        prepare(*reference, program);
+        reference->run(MAX_STEPS);
+        batchPC = reference->getPC();
+    }
+    bool threw = false;
+    try {
+        for (int i = 0; i < 5; ++i) cpu.step();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    expect(threw && cpu.getFaultAddress() == c.address && cpu.getPC() == batchPC, "step", "step() reports the same fault");
+    expect(batchPC == (c.access == MemoryAccess::FETCH ? c.address : faultPC + 4), "run",
+           "PC is the branch target, or past the faulting access");
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    auto instance = std::make_unique<Core>();
+    int failures = 0;
+    for (const FaultCase& c : CASES) {
+        failures += testCase(*instance, c);
+    }
+    printf("%zu cases, %d failures\n", sizeof(CASES) / sizeof(CASES[0]), failures);
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include "CPU.h"
+#include "MicroOpHandlers.h"
+
+// ====================== 执行函数表 ======================
+// 由 ISA.h 的指令表生成：前32项为W寄存器版本（sf=0），后32项为X寄存器版本（sf=1）
+#define HANDLER_ENTRY(NAME, OPCODE, MNEMONIC, FORMAT, WIDTH, FLAGS, HANDLER) &HANDLER,
+
+template<typename Config, typename Hooks>
+const typename BasicCPU<Config, Hooks>::MicroOp::Handler BasicCPU<Config, Hooks>::HANDLERS[64] = {
+    TINY_ISA(HANDLER_ENTRY, false)
+    TINY_ISA(HANDLER_ENTRY, true)
+};
+
+#undef HANDLER_ENTRY
+
+#define SYSTEM_HANDLER_ENTRY(NAME, SUBOP, MNEMONIC, FORMAT, HANDLER) handlers[SUBOP] = &HANDLER;
+
+template<typename Config, typename Hooks>
+const std::array<typename BasicCPU<Config, Hooks>::MicroOp::Handler, 256> BasicCPU<Config, Hooks>::SYSTEM_HANDLERS = [] {
+    std::array<typename MicroOp::Handler, 256> handlers;
+    handlers.fill(&uopHlt);
+    TINY_SYSTEM_ISA(SYSTEM_HANDLER_ENTRY)
+    return handlers;
+}();
+
+#undef SYSTEM_HANDLER_ENTRY
+
+template<typename Config, typename Hooks>
+const typename BasicCPU<Config, Hooks>::CodePage BasicCPU<Config, Hooks>::NO_CODE_PAGE{};
+
+// ====================== 预译码 ======================
+template<typename Config, typename Hooks>
+typename BasicCPU<Config, Hooks>::MicroOp BasicCPU<Config, Hooks>::predecode(uint32_t ir) {
+    const DecodedInstr d = decodeInstr(ir);
+    MicroOp uop{};
+    uop.index = d.index;
+    uop.rd = d.rd;
+    uop.rn = d.rn;
+    uop.rm = d.rm;
+    uop.imm = d.imm;
+    // 系统指令的执行函数直接绑定到具体的子操作码
+    uop.handler = (d.index & 0x1F) == OP_SYS ? SYSTEM_HANDLERS[d.rm] : HANDLERS[d.index];
+    return uop;
+}
+
+template<typename Config, typename Hooks>
+typename BasicCPU<Config, Hooks>::CodePage& BasicCPU<Config, Hooks>::predecodePage(uint64_t pageIndex) {
+    CodePage*& page = codeCache[pageIndex];
+    if (page == nullptr) {
+        codePageStorage.push_back(std::make_unique<CodePage>());
+        page = codePageStorage.back().get();
+    }
+
+    const uint8_t* base = memory.readPage(pageIndex);
+    for (uint64_t i = 0; i < CODE_PAGE_OPS; ++i) {
+        uint32_t ir;
+        std::memcpy(&ir, base + i * 4, sizeof(ir));
+        page->ops[i] = predecode(ir);
+    }
+    if (fusionEnabled) {
+        fusePage(*page);
+    }
+    page->valid = true;
+    page->generation++;
+    return *page;
+}
+
+// 融合只在页内进行；按顺序扫描，被标记的首条之后的指令仍可作为另一序列的首条
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::fusePage(CodePage& page) {
+    for (uint64_t i = 0; i + 1 < CODE_PAGE_OPS; ++i) {
+        uint8_t indices[3] = {page.ops[i].index, page.ops[i + 1].index,
+                              i + 2 < CODE_PAGE_OPS ? page.ops[i + 2].index : uint8_t(0)};
+        int fusion = matchFusion(indices, std::min<uint64_t>(3, CODE_PAGE_OPS - i));
+        if (fusion >= 0) {
+            page.ops[i].index = static_cast<uint8_t>(FUSED_INDEX_BASE + fusion);
+        }
+    }
+}
+
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::invalidateCodeCache() {
+    for (CodePage* page : codeCache) {
+        if (page) page->valid = false;
+    }
+}
+
+#define INSTANTIATE_PREDECODE(CONFIG, HOOKS) \
+    template const BasicCPU<CONFIG, HOOKS>::MicroOp::Handler BasicCPU<CONFIG, HOOKS>::HANDLERS[64]; \
+    template const std::array<BasicCPU<CONFIG, HOOKS>::MicroOp::Handler, 256> BasicCPU<CONFIG, HOOKS>::SYSTEM_HANDLERS; \
+    template const BasicCPU<CONFIG, HOOKS>::CodePage BasicCPU<CONFIG, HOOKS>::NO_CODE_PAGE; \
+    template BasicCPU<CONFIG, HOOKS>::MicroOp BasicCPU<CONFIG, HOOKS>::predecode(uint32_t ir); \
+    template BasicCPU<CONFIG, HOOKS>::CodePage& BasicCPU<CONFIG, HOOKS>::predecodePage(uint64_t pageIndex); \
+    template void BasicCPU<CONFIG, HOOKS>::fusePage(CodePage& page); \
+    template void BasicCPU<CONFIG, HOOKS>::invalidateCodeCache();
+TINY_CPU_CONFIGS(INSTANTIATE_PREDECODE)
+#undef INSTANTIATE_PREDECODE
@@ -0,0 +1,912 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "SIMT.h"
+
+// 以 TINY_NO_SIMD_SIMT 构建时在 x86-64 上也使用标量实现
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(TINY_NO_SIMD_SIMT)
+#define TINY_SIMT_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TINY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#include <intrin.h>
+#define TINY_TARGET_AVX2
+#endif
+#endif
+
+// ========================== 向量化内核 ==========================
+// 每个内核对 count 个通道执行同一个ALU操作：源操作数按位宽截断，结果写回目的寄存器，
+// 并记录惰性求值标志位所需的操作数与结果。Masked 时只改写掩码为全1的通道，其余通道原样保留
+
+namespace {
+
+enum class LaneOp : uint8_t {
+    ADD, SUB, CMP, AND, ORR, EOR, MUL,
+    MOV         // 结果为第二操作数（MOV 的源寄存器或 MOVI 的立即数）
+};
+constexpr size_t LANE_OPS = 8;
+constexpr size_t KERNEL_WIDTH = 4;      // 通道数按此向上取整，最宽的内核一次处理4个通道
+
+constexpr bool isArith(LaneOp op) { return op == LaneOp::ADD || op == LaneOp::SUB || op == LaneOp::CMP; }
+
+struct AluArgs {
+    uint64_t* dst;
+    const uint64_t* a;          // MOV 时不使用
+    const uint64_t* b;          // Imm 时不使用
+    uint64_t imm;               // 已按位宽截断
+    const uint64_t* mask;       // Masked 时使用
+    uint64_t* flagA;            // 加减法的操作数
+    uint64_t* flagB;
+    uint64_t* flagResult;
+    size_t count;               // KERNEL_WIDTH 的倍数
+};
+
+using AluKernel = void (*)(const AluArgs& x);
+using AluTable = AluKernel[LANE_OPS][2][2][2];     // [操作][Is64][Imm][Masked]
+
+struct SimtKernels {
+    const char* name;
+    AluTable alu;
+};
+
+// 按内核族 Family::alu<Op, Is64, Imm, Masked> 填表
+template<typename Family, LaneOp Op>
+void fillOp(AluTable& table) {
+    auto& t = table[static_cast<size_t>(Op)];
+    t[0][0][0] = &Family::template alu<Op, false, false, false>;
+    t[0][0][1] = &Family::template alu<Op, false, false, true>;
+    t[0][1][0] = &Family::template alu<Op, false, true, false>;
+    t[0][1][1] = &Family::template alu<Op, false, true, true>;
+    t[1][0][0] = &Family::template alu<Op, true, false, false>;
+    t[1][0][1] = &Family::template alu<Op, true, false, true>;
+    t[1][1][0] = &Family::template alu<Op, true, true, false>;
+    t[1][1][1] = &Family::template alu<Op, true, true, true>;
+}
+
+template<typename Family>
+SimtKernels makeKernels(const char* name) {
+    SimtKernels k{name, {}};
+    fillOp<Family, LaneOp::ADD>(k.alu);
+    fillOp<Family, LaneOp::SUB>(k.alu);
+    fillOp<Family, LaneOp::CMP>(k.alu);
+    fillOp<Family, LaneOp::AND>(k.alu);
+    fillOp<Family, LaneOp::ORR>(k.alu);
+    fillOp<Family, LaneOp::EOR>(k.alu);
+    fillOp<Family, LaneOp::MUL>(k.alu);
+    fillOp<Family, LaneOp::MOV>(k.alu);
+    return k;
+}
+
+// ====================== 标量 ======================
+struct ScalarKernels {
+    template<LaneOp Op>
+    static uint64_t apply(uint64_t a, uint64_t b) {
+        if constexpr (Op == LaneOp::ADD) return a + b;
+        else if constexpr (Op == LaneOp::SUB || Op == LaneOp::CMP) return a - b;
+        else if constexpr (Op == LaneOp::AND) return a & b;
+        else if constexpr (Op == LaneOp::ORR) return a | b;
+        else if constexpr (Op == LaneOp::EOR) return a ^ b;
+        else if constexpr (Op == LaneOp::MUL) return a * b;
+        else return b;
+    }
+
+    template<LaneOp Op, bool Is64, bool Imm, bool Masked>
+    static void alu(const AluArgs& x) {
+        const uint64_t width = Is64 ? ~0ULL : 0xFFFFFFFFULL;
+        for (size_t i = 0; i < x.count; ++i) {
+            if (Masked && x.mask[i] == 0) continue;
+            uint64_t a = Op == LaneOp::MOV ? 0 : x.a[i] & width;
+            uint64_t b = Imm ? x.imm : x.b[i] & width;
+            uint64_t r = apply<Op>(a, b) & width;
+            if constexpr (Op != LaneOp::CMP) x.dst[i] = r;
+            if constexpr (isArith(Op)) {
+                x.flagA[i] = a;
+                x.flagB[i] = b;
+            }
+            if constexpr (Op != LaneOp::MOV) x.flagResult[i] = r;
+        }
+    }
+};
+
+#ifdef TINY_SIMT_X86
+// ====================== SSE2 ======================
+// x86-64 的基线指令集，总是可用；一次处理2个通道，64位乘法由三次32位乘法拼成
+struct Sse2Kernels {
+    static __m128i load(const uint64_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+
+    template<bool Masked>
+    static void store(uint64_t* p, __m128i value, __m128i mask) {
+        if constexpr (Masked) {
+            value = _mm_or_si128(_mm_and_si128(mask, value), _mm_andnot_si128(mask, load(p)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), value);
+    }
+
+    static __m128i mul64(__m128i a, __m128i b) {
+        __m128i cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b), _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+        return _mm_add_epi64(_mm_mul_epu32(a, b), _mm_slli_epi64(cross, 32));
+    }
+
+    template<LaneOp Op>
+    static __m128i apply(__m128i a, __m128i b) {
+        if constexpr (Op == LaneOp::ADD) return _mm_add_epi64(a, b);
+        else if constexpr (Op == LaneOp::SUB || Op == LaneOp::CMP) return _mm_sub_epi64(a, b);
+        else if constexpr (Op == LaneOp::AND) return _mm_and_si128(a, b);
+        else if constexpr (Op == LaneOp::ORR) return _mm_or_si128(a, b);
+        else if constexpr (Op == LaneOp::EOR) return _mm_xor_si128(a, b);
+        else if constexpr (Op == LaneOp::MUL) return mul64(a, b);
+        else return b;
+    }
+
+    template<LaneOp Op, bool Is64, bool Imm, bool Masked>
+    static void alu(const AluArgs& x) {
+        const __m128i width = _mm_set1_epi64x(Is64 ? -1LL : 0xFFFFFFFFLL);
+        const __m128i imm = _mm_set1_epi64x(static_cast<long long>(x.imm));
+        for (size_t i = 0; i < x.count; i += 2) {
+            __m128i mask = _mm_setzero_si128();
+            if constexpr (Masked) {
+                mask = load(x.mask + i);
+                if (_mm_movemask_epi8(mask) == 0) continue;
+            }
+            __m128i a = Op == LaneOp::MOV ? _mm_setzero_si128() : _mm_and_si128(load(x.a + i), width);
+            __m128i b = Imm ? imm : _mm_and_si128(load(x.b + i), width);
+            __m128i r = _mm_and_si128(apply<Op>(a, b), width);
+            if constexpr (Op != LaneOp::CMP) store<Masked>(x.dst + i, r, mask);
+            if constexpr (isArith(Op)) {
+                store<Masked>(x.flagA + i, a, mask);
+                store<Masked>(x.flagB + i, b, mask);
+            }
+            if constexpr (Op != LaneOp::MOV) store<Masked>(x.flagResult + i, r, mask);
+        }
+    }
+};
+
+// ====================== AVX2 ======================
+// 只在运行时检测到AVX2时使用；一次处理4个通道
+struct Avx2Kernels {
+    TINY_TARGET_AVX2 static __m256i load(const uint64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+
+    template<bool Masked>
+    TINY_TARGET_AVX2 static void store(uint64_t* p, __m256i value, __m256i mask) {
+        if constexpr (Masked) {
+            value = _mm256_blendv_epi8(load(p), value, mask);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), value);
+    }
+
+    TINY_TARGET_AVX2 static __m256i mul64(__m256i a, __m256i b) {
+        __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+    }
+
+    template<LaneOp Op>
+    TINY_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) {
+        if constexpr (Op == LaneOp::ADD) return _mm256_add_epi64(a, b);
+        else if constexpr (Op == LaneOp::SUB || Op == LaneOp::CMP) return _mm256_sub_epi64(a, b);
+        else if constexpr (Op == LaneOp::AND) return _mm256_and_si256(a, b);
+        else if constexpr (Op == LaneOp::ORR) return _mm256_or_si256(a, b);
+        else if constexpr (Op == LaneOp::EOR) return _mm256_xor_si256(a, b);
+        else if constexpr (Op == LaneOp::MUL) return mul64(a, b);
+        else return b;
+    }
+
+    template<LaneOp Op, bool Is64, bool Imm, bool Masked>
+    TINY_TARGET_AVX2 static void alu(const AluArgs& x) {
+        const __m256i width = _mm256_set1_epi64x(Is64 ? -1LL : 0xFFFFFFFFLL);
+        const __m256i imm = _mm256_set1_epi64x(static_cast<long long>(x.imm));
+        for (size_t i = 0; i < x.count; i += 4) {
+            __m256i mask = _mm256_setzero_si256();
+            if constexpr (Masked) {
+                mask = load(x.mask + i);
+                if (_mm256_testz_si256(mask, mask)) continue;
+            }
+            __m256i a = Op == LaneOp::MOV ? _mm256_setzero_si256() : _mm256_and_si256(load(x.a + i), width);
+            __m256i b = Imm ? imm : _mm256_and_si256(load(x.b + i), width);
+            __m256i r = _mm256_and_si256(apply<Op>(a, b), width);
+            if constexpr (Op != LaneOp::CMP) store<Masked>(x.dst + i, r, mask);
+            if constexpr (isArith(Op)) {
+                store<Masked>(x.flagA + i, a, mask);
+                store<Masked>(x.flagB + i, b, mask);
+            }
+            if constexpr (Op != LaneOp::MOV) store<Masked>(x.flagResult + i, r, mask);
+        }
+    }
+};
+
+bool hasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;   // OSXSAVE 且操作系统保存YMM状态
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#endif
+}
+#endif
+
+const SimtKernels& kernels() {
+    static const SimtKernels selected = [] {
+#ifdef TINY_SIMT_X86
+        if (hasAvx2()) return makeKernels<Avx2Kernels>("avx2");
+        return makeKernels<Sse2Kernels>("sse2");
+#else
+        return makeKernels<ScalarKernels>("scalar");
+#endif
+    }();
+    return selected;
+}
+
+// 操作码对应的向量ALU操作；其余指令逐通道执行
+struct AluOpcode {
+    bool vector;
+    LaneOp op;
+    bool imm;
+};
+
+constexpr std::array<AluOpcode, 32> makeAluOpcodes() {
+    std::array<AluOpcode, 32> ops{};
+    ops[OP_ADD]  = {true, LaneOp::ADD, false};
+    ops[OP_ADDI] = {true, LaneOp::ADD, true};
+    ops[OP_SUB]  = {true, LaneOp::SUB, false};
+    ops[OP_SUBI] = {true, LaneOp::SUB, true};
+    ops[OP_AND]  = {true, LaneOp::AND, false};
+    ops[OP_ANDI] = {true, LaneOp::AND, true};
+    ops[OP_ORR]  = {true, LaneOp::ORR, false};
+    ops[OP_ORRI] = {true, LaneOp::ORR, true};
+    ops[OP_EOR]  = {true, LaneOp::EOR, false};
+    ops[OP_EORI] = {true, LaneOp::EOR, true};
+    ops[OP_MOV]  = {true, LaneOp::MOV, false};
+    ops[OP_MOVI] = {true, LaneOp::MOV, true};
+    ops[OP_CMP]  = {true, LaneOp::CMP, false};
+    ops[OP_CMPI] = {true, LaneOp::CMP, true};
+    ops[OP_MUL]  = {true, LaneOp::MUL, false};
+    return ops;
+}
+constexpr std::array<AluOpcode, 32> ALU_OPCODES = makeAluOpcodes();
+
+// 同 BasicCPU::arithNZCV
+template<typename U, bool Sub>
+uint32_t arithNZCV(uint64_t flagA, uint64_t flagB, uint64_t flagResult) {
+    constexpr U SIGN = U(1) << (sizeof(U) * 8 - 1);
+    U a = static_cast<U>(flagA), b = static_cast<U>(flagB), r = static_cast<U>(flagResult);
+    uint32_t n = (r & SIGN) != 0;
+    uint32_t z = (r == 0);
+    uint32_t c = Sub ? (a >= b) : (r < a);
+    uint32_t v = Sub ? (((a ^ b) & (a ^ r) & SIGN) != 0) : (((a ^ r) & (b ^ r) & SIGN) != 0);
+    return (n << 3) | (z << 2) | (c << 1) | v;
+}
+
+} // namespace
+
+const char* simtImplementation() {
+    return kernels().name;
+}
+
+// ====================== 标志位 ======================
+// Kind 在编译期确定的NZCV，B.cond 对同一组的所有通道使用同一个实例
+template<uint8_t Kind>
+static inline uint32_t kindNZCV(uint64_t a, uint64_t b, uint64_t r) {
+    if constexpr (Kind == 1) return arithNZCV<uint32_t, false>(a, b, r);       // ADD32
+    else if constexpr (Kind == 2) return arithNZCV<uint64_t, false>(a, b, r);  // ADD64
+    else if constexpr (Kind == 3) return arithNZCV<uint32_t, true>(a, b, r);   // SUB32
+    else if constexpr (Kind == 4) return arithNZCV<uint64_t, true>(a, b, r);   // SUB64
+    else if constexpr (Kind == 5) return ((r >> 28) & 8) | (static_cast<uint32_t>(r) == 0) << 2;
+    else if constexpr (Kind == 6) return ((r >> 60) & 8) | (r == 0) << 2;
+    else return static_cast<uint32_t>(r) & 0xF;
+}
+
+uint32_t SimtEngine::laneNZCV(uint32_t lane, uint8_t kind) const {
+    const uint64_t a = flagA[lane], b = flagB[lane], r = flagResult[lane];
+    switch (kind) {
+    case ADD32:   return kindNZCV<ADD32>(a, b, r);
+    case ADD64:   return kindNZCV<ADD64>(a, b, r);
+    case SUB32:   return kindNZCV<SUB32>(a, b, r);
+    case SUB64:   return kindNZCV<SUB64>(a, b, r);
+    case LOGIC32: return kindNZCV<LOGIC32>(a, b, r);
+    case LOGIC64: return kindNZCV<LOGIC64>(a, b, r);
+    default:      return kindNZCV<EXPLICIT>(a, b, r);
+    }
+}
+
+static_assert(SimtEngine::NUM_REGS == 32, "register file layout");
+
+// ====================== 状态 ======================
+SimtEngine::SimtEngine(uint32_t laneCount, const MemoryLayout& memoryLayout)
+    : lanes(laneCount), layout(memoryLayout) {
+    if (lanes == 0) {
+        throw std::runtime_error("SIMT engine needs at least one lane");
+    }
+    const uint64_t memSize = layout.memSize;
+    if (memSize == 0 || memSize % GUEST_PAGE_SIZE != 0) {
+        throw std::runtime_error("Memory size must be a nonzero multiple of 4KB");
+    }
+    if (layout.codeSize == 0 || layout.codeSize % GUEST_PAGE_SIZE != 0 || layout.codeSize > memSize) {
+        throw std::runtime_error("Code region must be whole pages within memory");
+    }
+    if (layout.stackBase > memSize || layout.stackLimit > layout.stackBase) {
+        throw std::runtime_error("Stack must lie within memory");
+    }
+
+    stride = (lanes + KERNEL_WIDTH - 1) / KERNEL_WIDTH * KERNEL_WIDTH;
+    regs.assign(NUM_REGS * stride, 0);
+    flagA.assign(stride, 0);
+    flagB.assign(stride, 0);
+    flagResult.assign(stride, 0);
+    flagKinds.assign(lanes, EXPLICIT);
+    pcs.assign(lanes, 0);
+    memories = std::vector<FlatMemory>(lanes);
+    for (FlatMemory& memory : memories) memory.configure(layout, 0);
+    stopReasons.assign(lanes, StopReason::NONE);
+    runSteps.assign(lanes, 0);
+    faultAddresses.assign(lanes, 0);
+    faultAccesses.assign(lanes, MemoryAccess::READ);
+    exclusiveAddresses.assign(lanes, CPU::NO_EXCLUSIVE);
+    exclusiveValues.assign(lanes, 0);
+    exclusiveSizes.assign(lanes, 0);
+    code.assign(layout.codeSize, 0);
+    opPages.resize(layout.codeSize >> GUEST_PAGE_SHIFT);
+    groupMask.assign(stride, 0);
+    nextPCs.assign(lanes, 0);
+    reset();
+}
+
+void SimtEngine::reset() {
+    std::fill(regs.begin(), regs.end(), 0);
+    std::fill(reg(31), reg(31) + lanes, layout.stackBase);  // X31作为SP寄存器
+    std::fill(flagA.begin(), flagA.end(), 0);
+    std::fill(flagB.begin(), flagB.end(), 0);
+    std::fill(flagResult.begin(), flagResult.end(), 0);
+    std::fill(flagKinds.begin(), flagKinds.end(), EXPLICIT);
+    std::fill(pcs.begin(), pcs.end(), 0);
+    for (FlatMemory& memory : memories) memory.clear();     // 只清零上次复位以来写过的页
+    std::fill(stopReasons.begin(), stopReasons.end(), StopReason::NONE);
+    std::fill(runSteps.begin(), runSteps.end(), 0);
+    std::fill(exclusiveAddresses.begin(), exclusiveAddresses.end(), CPU::NO_EXCLUSIVE);
+    std::fill(code.begin(), code.end(), 0);
+    for (auto& page : opPages) page.reset();
+    issueCount = 0;
+}
+
+void SimtEngine::loadProgram(const std::vector<uint32_t>& program) {
+    if (program.size() * 4 > layout.codeSize) {
+        throw std::runtime_error("Program too large for memory");
+    }
+    for (size_t i = 0; i < program.size(); ++i) {
+        for (size_t b = 0; b < 4; ++b) code[i * 4 + b] = static_cast<uint8_t>(program[i] >> (b * 8));
+    }
+    for (FlatMemory& memory : memories) memory.copyIn(0, code.data(), program.size() * 4);
+    for (auto& page : opPages) page.reset();
+}
+
+void SimtEngine::checkLane(uint32_t lane) const {
+    if (lane >= lanes) throw std::runtime_error("Invalid lane: " + std::to_string(lane));
+}
+
+void SimtEngine::setReg(uint32_t lane, uint8_t idx, uint64_t value) {
+    checkLane(lane);
+    if (idx >= NUM_REGS) throw std::runtime_error("Invalid register: " + std::to_string(idx));
+    regs[idx * stride + lane] = value;
+}
+
+uint64_t SimtEngine::getReg(uint32_t lane, uint8_t idx) const {
+    checkLane(lane);
+    if (idx >= NUM_REGS) throw std::runtime_error("Invalid register: " + std::to_string(idx));
+    return regs[idx * stride + lane];
+}
+
+void SimtEngine::setPC(uint32_t lane, uint64_t pc) {
+    checkLane(lane);
+    pcs[lane] = pc;
+}
+
+uint64_t SimtEngine::getPC(uint32_t lane) const {
+    checkLane(lane);
+    return pcs[lane];
+}
+
+void SimtEngine::setStatusReg(uint32_t lane, const StatusRegister& status) {
+    checkLane(lane);
+    flagKinds[lane] = EXPLICIT;
+    flagResult[lane] = (status.N << 3) | (status.Z << 2) | (status.C << 1) | static_cast<uint64_t>(status.V);
+}
+
+StatusRegister SimtEngine::getStatusReg(uint32_t lane) const {
+    checkLane(lane);
+    uint32_t nzcv = laneNZCV(lane, flagKinds[lane]);
+    return StatusRegister{(nzcv & 8) != 0, (nzcv & 4) != 0, (nzcv & 2) != 0, (nzcv & 1) != 0};
+}
+
+void SimtEngine::writeMemoryRange(uint32_t lane, uint64_t address, const std::vector<uint8_t>& bytes) {
+    checkLane(lane);
+    if (address > layout.memSize || bytes.size() > layout.memSize - address) {
+        throw std::runtime_error("Memory write out of bounds: " + std::to_string(address));
+    }
+    if (!bytes.empty()) memories[lane].copyIn(address, bytes.data(), bytes.size());
+}
+
+std::vector<uint8_t> SimtEngine::readMemoryRange(uint32_t lane, uint64_t address, size_t size) const {
+    checkLane(lane);
+    if (address > layout.memSize || size > layout.memSize - address) {
+        throw std::runtime_error("Memory read out of bounds: " + std::to_string(address));
+    }
+    std::vector<uint8_t> bytes(size);
+    if (size != 0) memories[lane].copyOut(address, bytes.data(), size);
+    return bytes;
+}
+
+// ====================== 取指 ======================
+// 代码页在首次执行时译码；PC未对齐时临时译码该地址的指令。调用者保证 pc <= codeSize - 4
+const SimtEngine::Op& SimtEngine::fetch(uint64_t pc, Op& slowOp) {
+    auto toOp = [](uint32_t ir) {
+        DecodedInstr d = decodeInstr(ir);
+        return Op{d.imm, d.index, d.rd, d.rn, d.rm};
+    };
+    if (pc & 3) {
+        uint32_t ir;
+        std::memcpy(&ir, code.data() + pc, sizeof(ir));
+        slowOp = toOp(ir);
+        return slowOp;
+    }
+    std::unique_ptr<OpPage>& page = opPages[pc >> GUEST_PAGE_SHIFT];
+    if (!page) {
+        page = std::make_unique<OpPage>();
+        const uint8_t* base = code.data() + (pc & ~(GUEST_PAGE_SIZE - 1));
+        for (uint64_t i = 0; i < PAGE_OPS; ++i) {
+            uint32_t ir;
+            std::memcpy(&ir, base + i * 4, sizeof(ir));
+            (*page)[i] = toOp(ir);
+        }
+    }
+    return (*page)[(pc & (GUEST_PAGE_SIZE - 1)) >> 2];
+}
+
+// ====================== 分组 ======================
+// 在可执行的通道（未停止且尚有步数）中取PC最小的一组；没有可执行的通道时返回false
+bool SimtEngine::schedule(uint64_t maxSteps) {
+    bool any = false;
+    uint64_t minPC = 0;
+    for (uint32_t l = 0; l < lanes; ++l) {
+        if (stopped(l) || runSteps[l] >= maxSteps) continue;
+        if (!any || pcs[l] < minPC) minPC = pcs[l];
+        any = true;
+    }
+    if (!any) return false;
+
+    group.clear();
+    std::fill(groupMask.begin(), groupMask.end(), 0);
+    waitPC = ~0ULL;
+    waiting = 0;
+    groupBudget = maxSteps;
+    for (uint32_t l = 0; l < lanes; ++l) {
+        if (stopped(l) || runSteps[l] >= maxSteps) continue;
+        if (pcs[l] != minPC) {
+            waitPC = std::min(waitPC, pcs[l]);
+            ++waiting;
+            continue;
+        }
+        groupFlags = (group.empty() || groupFlags == flagKinds[l]) ? static_cast<FlagKind>(flagKinds[l]) : MIXED;
+        group.push_back(l);
+        groupMask[l] = ~0ULL;
+        groupBudget = std::min(groupBudget, maxSteps - runSteps[l]);
+    }
+    groupPC = minPC;
+    groupFull = group.size() == lanes;
+    groupSteps = 0;
+    return true;
+}
+
+// 把组执行的步数与标志位种类（以及PC）记入各通道
+void SimtEngine::flushGroup(bool writePC) {
+    for (uint32_t l : group) {
+        runSteps[l] += groupSteps;
+        if (groupFlags != MIXED) flagKinds[l] = groupFlags;
+        if (writePC) pcs[l] = groupPC;
+    }
+    groupSteps = 0;
+}
+
+// retiring 中的通道以 reason 停止在 pc，并离开当前组
+void SimtEngine::retire(StopReason reason, uint64_t pc) {
+    for (uint32_t l : retiring) {
+        runSteps[l] += groupSteps;
+        if (groupFlags != MIXED) flagKinds[l] = groupFlags;
+        pcs[l] = pc;
+        stopReasons[l] = reason;
+        groupMask[l] = 0;
+    }
+    group.erase(std::remove_if(group.begin(), group.end(), [this](uint32_t l) { return groupMask[l] == 0; }), group.end());
+    groupFull = false;
+    retiring.clear();
+}
+
+// 组内各通道跳到 nextPCs：目标相同时整组继续，否则解散
+bool SimtEngine::branchPerLane() {
+    if (group.empty()) return true;
+    const uint64_t target = nextPCs[group[0]];
+    bool uniform = true;
+    for (uint32_t l : group) uniform &= nextPCs[l] == target;
+    if (uniform) {
+        groupPC = target;
+        return true;
+    }
+    for (uint32_t l : group) pcs[l] = nextPCs[l];
+    flushGroup(false);
+    group.clear();
+    return false;
+}
+
+// ====================== 执行 ======================
+StopReason SimtEngine::run(uint64_t maxSteps) {
+    for (uint32_t l = 0; l < lanes; ++l) {
+        runSteps[l] = 0;
+        if (!stopped(l)) stopReasons[l] = StopReason::NONE;
+    }
+    issueCount = 0;
+    while (schedule(maxSteps)) {
+        executeGroup();
+    }
+
+    bool limited = false;
+    for (uint32_t l = 0; l < lanes; ++l) {
+        if (!stopped(l)) {
+            stopReasons[l] = StopReason::STEP_LIMIT;
+            limited = true;
+        }
+    }
+    if (limited) return StopReason::STEP_LIMIT;
+    for (uint32_t l = 0; l < lanes; ++l) {
+        if (stopReasons[l] != StopReason::HALT) return stopReasons[l];
+    }
+    return StopReason::HALT;
+}
+
+// 执行当前组直到它解散：分歧、到达等待通道的PC（合并）、用完步数或全部停止
+void SimtEngine::executeGroup() {
+    const SimtKernels& k = kernels();
+    Op slowOp;
+    for (;;) {
+        if (group.empty()) return;
+        if ((waiting != 0 && groupPC >= waitPC) || groupSteps == groupBudget) {
+            flushGroup(true);
+            return;
+        }
+        ++groupSteps;
+        ++issueCount;
+
+        if (groupPC > layout.codeSize - 4) {
+            for (uint32_t l : group) {
+                faultAddresses[l] = groupPC;
+                faultAccesses[l] = MemoryAccess::FETCH;
+            }
+            retiring = group;
+            retire(StopReason::MEMORY_FAULT, groupPC);
+            return;
+        }
+        const Op& op = fetch(groupPC, slowOp);
+        const uint64_t next = groupPC + 4;
+        const bool is64 = (op.index & 0x20) != 0;
+        const uint8_t opcode = op.index & 0x1F;
+
+        const AluOpcode alu = ALU_OPCODES[opcode];
+        if (alu.vector) {
+            AluArgs x;
+            x.dst = reg(op.rd);
+            x.a = reg(op.rn);
+            x.b = alu.op == LaneOp::MOV ? reg(op.rn) : reg(op.rm);
+            x.imm = is64 ? static_cast<uint64_t>(static_cast<int64_t>(op.imm)) : static_cast<uint32_t>(op.imm);
+            x.mask = groupMask.data();
+            x.flagA = flagA.data();
+            x.flagB = flagB.data();
+            x.flagResult = flagResult.data();
+            x.count = stride;
+            k.alu[static_cast<size_t>(alu.op)][is64][alu.imm][!groupFull](x);
+            if (isArith(alu.op)) {
+                groupFlags = alu.op == LaneOp::ADD ? (is64 ? ADD64 : ADD32) : (is64 ? SUB64 : SUB32);
+            } else if (alu.op != LaneOp::MOV) {
+                groupFlags = is64 ? LOGIC64 : LOGIC32;
+            }
+            groupPC = next;
+            continue;
+        }
+
+        switch (opcode) {
+        case OP_SDIV:
+        case OP_UDIV:
+            if (is64) divide<true>(op, opcode == OP_SDIV);
+            else divide<false>(op, opcode == OP_SDIV);
+            groupPC = next;
+            break;
+        case OP_LDRB: is64 ? load<uint8_t, true>(op)  : load<uint8_t, false>(op);  groupPC = next; break;
+        case OP_LDRH: is64 ? load<uint16_t, true>(op) : load<uint16_t, false>(op); groupPC = next; break;
+        case OP_LDRW: is64 ? load<uint32_t, true>(op) : load<uint32_t, false>(op); groupPC = next; break;
+        case OP_LDRD: is64 ? load<uint64_t, true>(op) : load<uint64_t, false>(op); groupPC = next; break;
+        case OP_STRB: is64 ? store<uint8_t, true>(op)  : store<uint8_t, false>(op);  groupPC = next; break;
+        case OP_STRH: is64 ? store<uint16_t, true>(op) : store<uint16_t, false>(op); groupPC = next; break;
+        case OP_STRW: is64 ? store<uint32_t, true>(op) : store<uint32_t, false>(op); groupPC = next; break;
+        case OP_STRD: is64 ? store<uint64_t, true>(op) : store<uint64_t, false>(op); groupPC = next; break;
+        case OP_B:
+            groupPC = next + static_cast<int64_t>(op.imm);
+            break;
+        case OP_BL: {
+            uint64_t* lr = reg(30);
+            for (uint32_t l : group) lr[l] = next;  // 保存返回地址到LR (X30)
+            groupPC = next + static_cast<int64_t>(op.imm);
+            break;
+        }
+        case OP_B_COND:
+            if (!(is64 ? branchCondition<true>(op) : branchCondition<false>(op))) return;
+            break;
+        case OP_BLR:
+        case OP_BR:
+        case OP_RET: {
+            const uint64_t* target = reg(opcode == OP_RET ? 30 : op.rn);
+            for (uint32_t l : group) nextPCs[l] = target[l];
+            if (opcode == OP_BLR) {
+                uint64_t* lr = reg(30);
+                for (uint32_t l : group) lr[l] = next;
+            }
+            if (!branchPerLane()) return;
+            break;
+        }
+        default:    // OP_SYS
+            system(op);
+            if (group.empty()) return;
+            break;
+        }
+    }
+}
+
+template<typename T, bool Is64>
+void SimtEngine::load(const Op& op) {
+    const uint64_t* base = reg(op.rn);
+    uint64_t* dst = reg(op.rd);
+    for (uint32_t l : group) {
+        uint64_t address = (Is64 ? base[l] : static_cast<uint32_t>(base[l])) + static_cast<int64_t>(op.imm);
+        if (address > layout.memSize - sizeof(T)) {
+            faultAddresses[l] = address;
+            faultAccesses[l] = MemoryAccess::READ;
+            retiring.push_back(l);
+            continue;
+        }
+        uint64_t value = memories[l].read<T>(address);
+        dst[l] = Is64 ? value : static_cast<uint32_t>(value);
+    }
+    if (!retiring.empty()) retire(StopReason::MEMORY_FAULT, groupPC + 4);
+}
+
+template<typename T, bool Is64>
+void SimtEngine::store(const Op& op) {
+    const uint64_t* base = reg(op.rn);
+    const uint64_t* src = reg(op.rd);
+    for (uint32_t l : group) {
+        uint64_t address = (Is64 ? base[l] : static_cast<uint32_t>(base[l])) + static_cast<int64_t>(op.imm);
+        if (address > layout.memSize - sizeof(T)) {
+            faultAddresses[l] = address;
+            faultAccesses[l] = MemoryAccess::WRITE;
+            retiring.push_back(l);
+            continue;
+        }
+        memories[l].write<T>(address, static_cast<T>(Is64 ? src[l] : static_cast<uint32_t>(src[l])));
+    }
+    if (!retiring.empty()) retire(StopReason::MEMORY_FAULT, groupPC + 4);
+}
+
+// 除数为0的通道停止；INT_MIN / -1 按AArch64语义结果为INT_MIN
+template<bool Is64>
+void SimtEngine::divide(const Op& op, bool isSigned) {
+    using S = std::conditional_t<Is64, int64_t, int32_t>;
+    using U = std::make_unsigned_t<S>;
+    const uint64_t* a = reg(op.rn);
+    const uint64_t* b = reg(op.rm);
+    uint64_t* dst = reg(op.rd);
+    for (uint32_t l : group) {
+        S sa = static_cast<S>(a[l]), sb = static_cast<S>(b[l]);
+        if (sb == 0) {
+            retiring.push_back(l);
+            continue;
+        }
+        S result;
+        if (isSigned) result = (sb == -1) ? static_cast<S>(U(0) - static_cast<U>(sa)) : sa / sb;
+        else result = static_cast<S>(static_cast<U>(sa) / static_cast<U>(sb));
+        dst[l] = static_cast<U>(result);
+        flagResult[l] = static_cast<U>(result);
+    }
+    if (!retiring.empty()) retire(StopReason::DIVIDE_BY_ZERO, groupPC + 4);
+    groupFlags = Is64 ? LOGIC64 : LOGIC32;
+}
+
+// 组内条件一致时整组跳转并返回true；分歧时各通道记下自己的PC，组解散并返回false
+template<bool Is64>
+bool SimtEngine::branchCondition(const Op& op) {
+    const uint16_t table = CONDITION_TABLE[op.rm & 0xF];
+    const uint64_t fall = groupPC + 4;
+    const uint64_t taken = fall + static_cast<int64_t>(op.imm);
+    size_t count = 0;
+
+    auto evaluate = [&](auto nzcvOf) {
+        for (uint32_t l : group) {
+            uint32_t bit = (table >> nzcvOf(l)) & 1;
+            nextPCs[l] = bit ? taken : fall;
+            count += bit;
+        }
+    };
+    const uint64_t* a = flagA.data();
+    const uint64_t* b = flagB.data();
+    const uint64_t* r = flagResult.data();
+    switch (groupFlags) {
+    case ADD32:   evaluate([&](uint32_t l) { return kindNZCV<ADD32>(a[l], b[l], r[l]); }); break;
+    case ADD64:   evaluate([&](uint32_t l) { return kindNZCV<ADD64>(a[l], b[l], r[l]); }); break;
+    case SUB32:   evaluate([&](uint32_t l) { return kindNZCV<SUB32>(a[l], b[l], r[l]); }); break;
+    case SUB64:   evaluate([&](uint32_t l) { return kindNZCV<SUB64>(a[l], b[l], r[l]); }); break;
+    case LOGIC32: evaluate([&](uint32_t l) { return kindNZCV<LOGIC32>(a[l], b[l], r[l]); }); break;
+    case LOGIC64: evaluate([&](uint32_t l) { return kindNZCV<LOGIC64>(a[l], b[l], r[l]); }); break;
+    case EXPLICIT: evaluate([&](uint32_t l) { return kindNZCV<EXPLICIT>(a[l], b[l], r[l]); }); break;
+    default:      evaluate([&](uint32_t l) { return laneNZCV(l, flagKinds[l]); }); break;
+    }
+
+    if (count == group.size() || count == 0) {
+        groupPC = count ? taken : fall;
+        return true;
+    }
+    for (uint32_t l : group) pcs[l] = nextPCs[l];
+    flushGroup(false);
+    group.clear();
+    return false;
+}
+
+// ====================== 系统指令 ======================
+void SimtEngine::system(const Op& op) {
+    const uint64_t next = groupPC + 4;
+    const bool is64 = (op.index & 0x20) != 0;
+    switch (op.rm) {
+    case SYS_NOP:
+    case SYS_DMB:       // 各通道互不共享内存
+        groupPC = next;
+        break;
+    case SYS_MRS: {
+        uint64_t* dst = reg(op.rd);
+        for (uint32_t l : group) dst[l] = 0;
+        groupPC = next;
+        break;
+    }
+    case SYS_LDXR:
+    case SYS_STXR:
+    case SYS_LDADD:
+    case SYS_CAS:
+        if (is64) atomic<uint64_t>(op);
+        else atomic<uint32_t>(op);
+        groupPC = next;
+        break;
+    case SYS_CPYP: case SYS_CPYM: case SYS_CPYE:
+    case SYS_SETP: case SYS_SETM: case SYS_SETE:
+        bulk(op);
+        branchPerLane();
+        break;
+    default:            // HLT 与未定义的子操作码
+        retiring = group;
+        retire(StopReason::HALT, next);
+        break;
+    }
+}
+
+// 语义同 BasicCPU 的多核同步指令；每个通道只有自己访问内存，不需要宿主机原子操作
+template<typename T>
+void SimtEngine::atomic(const Op& op) {
+    const uint8_t r0 = op.rd, r1 = op.rn, rn = static_cast<uint8_t>(op.imm & 0x1F);
+    const uint64_t memSize = layout.memSize;
+    for (uint32_t l : group) {
+        auto x = [&](uint8_t r) -> uint64_t& { return regs[r * stride + l]; };
+        FlatMemory& memory = memories[l];
+        const uint64_t address = x(op.rm == SYS_LDXR ? r1 : rn);
+        if ((address & (sizeof(T) - 1)) != 0 || sizeof(T) > memSize || address > memSize - sizeof(T)) {
+            faultAddresses[l] = address;
+            faultAccesses[l] = op.rm == SYS_STXR ? MemoryAccess::WRITE : MemoryAccess::READ;
+            retiring.push_back(l);
+            continue;
+        }
+        switch (op.rm) {
+        case SYS_LDXR: {        // LDXR Rt, [Xn]
+            T value = memory.read<T>(address);
+            exclusiveAddresses[l] = address;
+            exclusiveValues[l] = value;
+            exclusiveSizes[l] = sizeof(T);
+            x(r0) = value;
+            break;
+        }
+        case SYS_STXR: {        // STXR Ws, Rt, [Xn]
+            bool stored = exclusiveAddresses[l] == address && exclusiveSizes[l] == sizeof(T) &&
+                          memory.read<T>(address) == static_cast<T>(exclusiveValues[l]);
+            if (stored) memory.write<T>(address, static_cast<T>(x(r1)));
+            exclusiveAddresses[l] = CPU::NO_EXCLUSIVE;
+            x(r0) = stored ? 0 : 1;
+            break;
+        }
+        case SYS_LDADD: {       // LDADD Rs, Rt, [Xn]
+            T old = memory.read<T>(address);
+            memory.write<T>(address, static_cast<T>(old + static_cast<T>(x(r0))));
+            x(r1) = old;
+            break;
+        }
+        default: {              // CAS Rs, Rt, [Xn]
+            T current = memory.read<T>(address);
+            if (current == static_cast<T>(x(r0))) memory.write<T>(address, static_cast<T>(x(r1)));
+            x(r0) = current;
+            break;
+        }
+        }
+    }
+    if (!retiring.empty()) retire(StopReason::MEMORY_FAULT, groupPC + 4);
+}
+
+// 语义同 BasicCPU::bulkCopy / bulkSet（每段至多 MOPS_CHUNK 字节，未完成的通道停在本指令），各通道的下一PC记入 nextPCs
+void SimtEngine::bulk(const Op& op) {
+    const uint8_t stage = op.rm & 3;        // 0 P、1 M、2 E
+    const bool copy = op.rm <= SYS_CPYE;
+    const uint8_t rd = op.rd, r1 = op.rn, r2 = static_cast<uint8_t>(op.imm & 0x1F);
+    const uint64_t memSize = layout.memSize;
+    auto accessible = [&](uint64_t address, uint64_t size) { return size <= memSize && address <= memSize - size; };
+
+    for (uint32_t l : group) {
+        auto x = [&](uint8_t r) -> uint64_t& { return regs[r * stride + l]; };
+        nextPCs[l] = groupPC + 4;
+        uint64_t dst = x(rd);
+        if (copy) {     // CPY [Xd]!, [Xs]!, Xn!
+            uint64_t src = x(r1);
+            int64_t count = static_cast<int64_t>(x(r2));
+            if (stage == 0) {
+                if (count < 0) count = INT64_MAX;
+                if (dst > src && dst - src < static_cast<uint64_t>(count)) {
+                    dst += count;
+                    src += count;
+                    count = -count;
+                }
+            } else if (count != 0) {
+                const bool forward = count > 0;
+                const uint64_t remaining = forward ? count : 0 - static_cast<uint64_t>(count);
+                const uint64_t n = std::min(remaining, CPU::MOPS_CHUNK);
+                const uint64_t to = forward ? dst : dst - n, from = forward ? src : src - n;
+                if (!accessible(from, n) || !accessible(to, n)) {
+                    bool read = !accessible(from, n);
+                    faultAddresses[l] = read ? from : to;
+                    faultAccesses[l] = read ? MemoryAccess::READ : MemoryAccess::WRITE;
+                    retiring.push_back(l);
+                    continue;
+                }
+                memories[l].move(to, from, n);
+                dst = forward ? dst + n : dst - n;
+                src = forward ? src + n : src - n;
+                count = forward ? count - static_cast<int64_t>(n) : count + static_cast<int64_t>(n);
+                if (count != 0) nextPCs[l] = groupPC;
+            }
+            x(rd) = dst;
+            x(r1) = src;
+            x(r2) = static_cast<uint64_t>(count);
+        } else {        // SET [Xd]!, Xn!, Xs
+            int64_t count = static_cast<int64_t>(x(r1));
+            if (stage == 0) {
+                if (count < 0) count = INT64_MAX;
+            } else if (count > 0) {
+                const uint64_t n = std::min(static_cast<uint64_t>(count), CPU::MOPS_CHUNK);
+                if (!accessible(dst, n)) {
+                    faultAddresses[l] = dst;
+                    faultAccesses[l] = MemoryAccess::WRITE;
+                    retiring.push_back(l);
+                    continue;
+                }
+                memories[l].fill(dst, static_cast<uint8_t>(x(r2)), n);
+                dst += n;
+                count -= n;
+                if (count != 0) nextPCs[l] = groupPC;
+            }
+            x(rd) = dst;
+            x(r1) = static_cast<uint64_t>(count);
+        }
+    }
+    if (!retiring.empty()) retire(StopReason::MEMORY_FAULT, groupPC + 4);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CPU.h"
+
+// ========================== SIMT 锁步执行 ==========================
+// 参数扫描时同一程序要以不同的初始寄存器运行成百上千次。SimtEngine 持有 K 个实例（通道），
+// 寄存器按结构数组存放（regs[32][K]：同一寄存器的K个通道连续），每条指令只取指译码一次，
+// 再用SSE2/AVX2内核对所有处在该PC的通道一并执行（运行时选择，见 simtImplementation()）。
+//
+// 通道在 B.cond 或间接跳转处分歧后，每次执行PC最小的一组通道，其余通道等待；
+// 执行中的组到达等待通道的PC时合并（最小PC重汇合），if/else 在汇合点、循环在出口处重新锁步。
+// 每个通道有自己的内存与NZCV，执行结果（寄存器、NZCV、PC、步数、错误）与在 CPU 上单独 run() 相同。
+// 限制：取指总是使用 loadProgram() 载入的程序，通道改写代码区不影响执行；没有钩子、MMU与JIT；
+// MRS 读出的 MPIDR_EL1 为0（每个通道都是单核）
+class SimtEngine {
+public:
+    static constexpr int32_t NUM_REGS = 32;
+
+    // lanes 为0或布局无效时抛出异常；每个通道的内存按 layout.memSize 保留，只有写过的页占用宿主机内存
+    explicit SimtEngine(uint32_t lanes, const MemoryLayout& layout = DefaultConfig::LAYOUT);
+
+    SimtEngine(const SimtEngine&) = delete;
+    SimtEngine& operator=(const SimtEngine&) = delete;
+
+    uint32_t getLaneCount() const { return lanes; }
+    const MemoryLayout& getMemoryLayout() const { return layout; }
+
+    // 复位所有通道：寄存器与NZCV清零，SP为栈顶，PC为0，清零各通道写过的页与取指映像
+    void reset();
+    // 加载程序到每个通道的内存与取指映像（从地址0开始），不改变PC；程序超出代码区时抛出异常
+    void loadProgram(const std::vector<uint32_t>& program);
+
+    // 单个通道的状态；通道号或寄存器号越界、内存区间越界时抛出异常
+    void setReg(uint32_t lane, uint8_t idx, uint64_t value);
+    uint64_t getReg(uint32_t lane, uint8_t idx) const;
+    void setPC(uint32_t lane, uint64_t pc);
+    uint64_t getPC(uint32_t lane) const;
+    void setStatusReg(uint32_t lane, const StatusRegister& status);
+    StatusRegister getStatusReg(uint32_t lane) const;
+    void writeMemoryRange(uint32_t lane, uint64_t address, const std::vector<uint8_t>& bytes);
+    std::vector<uint8_t> readMemoryRange(uint32_t lane, uint64_t address, size_t size) const;
+
+    // 每个通道至多执行 maxSteps 条指令；已停止（HLT或出错）的通道不再执行，直到 reset()。
+    // 仍有通道用完步数时返回 STEP_LIMIT，否则返回编号最小的出错通道的停止原因，都执行了HLT时返回 HALT
+    StopReason run(uint64_t maxSteps);
+
+    // 通道的停止原因：尚未停止时为 NONE 或 STEP_LIMIT
+    StopReason getStopReason(uint32_t lane) const { return stopReasons.at(lane); }
+    // 最近一次 run() 中通道执行的指令数（含导致停止的指令）
+    uint64_t getRunSteps(uint32_t lane) const { return runSteps.at(lane); }
+    // reason 为 MEMORY_FAULT 时有效
+    uint64_t getFaultAddress(uint32_t lane) const { return faultAddresses.at(lane); }
+    MemoryAccess getFaultAccess(uint32_t lane) const { return faultAccesses.at(lane); }
+    // 最近一次 run() 取指译码的次数；各通道始终锁步时等于单个通道的步数，分歧越多越大
+    uint64_t getIssueCount() const { return issueCount; }
+
+private:
+    // 标志位惰性求值，同 BasicCPU：EXPLICIT 时 flagResult 的低4位为 N<<3|Z<<2|C<<1|V
+    enum FlagKind : uint8_t {
+        EXPLICIT,
+        ADD32, ADD64,
+        SUB32, SUB64,
+        LOGIC32, LOGIC64,
+        MIXED               // 只用于组：组内各通道不同，逐通道查 flagKinds
+    };
+
+    struct Op {
+        int32_t imm;
+        uint8_t index;
+        uint8_t rd;
+        uint8_t rn;
+        uint8_t rm;
+    };
+    static constexpr uint64_t PAGE_OPS = GUEST_PAGE_SIZE / 4;
+    using OpPage = std::array<Op, PAGE_OPS>;
+
+    const uint32_t lanes;
+    size_t stride;                              // 每个寄存器占的通道数，按内核宽度向上取整
+    MemoryLayout layout;
+
+    // 结构数组：第 r 个寄存器的通道 l 位于 regs[r * stride + l]
+    std::vector<uint64_t> regs;
+    std::vector<uint64_t> flagA, flagB, flagResult;
+    std::vector<uint8_t> flagKinds;
+    std::vector<uint64_t> pcs;                  // 不在当前组中的通道的PC
+    std::vector<FlatMemory> memories;
+    std::vector<StopReason> stopReasons;
+    std::vector<uint64_t> runSteps;
+    std::vector<uint64_t> faultAddresses;
+    std::vector<MemoryAccess> faultAccesses;
+    // 独占监视器（LDXR/STXR），每个通道一个
+    std::vector<uint64_t> exclusiveAddresses, exclusiveValues;
+    std::vector<uint8_t> exclusiveSizes;
+
+    // 取指映像：代码区的内容与按页惰性译码的指令
+    std::vector<uint8_t> code;
+    std::vector<std::unique_ptr<OpPage>> opPages;
+
+    // 当前组：PC相同、一起执行的通道
+    uint64_t groupPC = 0;
+    std::vector<uint32_t> group;                // 组内通道号（升序）
+    std::vector<uint64_t> groupMask;            // 组内通道为全1，其余为0（供向量内核混合）
+    bool groupFull = false;                     // 所有通道都在组内，内核不必混合
+    uint64_t groupSteps = 0;                    // 组形成以来执行的指令数，解散时计入各通道
+    uint64_t groupBudget = 0;                   // 组内通道剩余步数的最小值
+    uint64_t waitPC = 0;                        // 其余可执行通道的最小PC
+    uint32_t waiting = 0;                       // 等待中的可执行通道数
+    uint8_t groupFlags = EXPLICIT;
+    uint64_t issueCount = 0;
+
+    std::vector<uint64_t> nextPCs;              // 逐通道计算的跳转目标
+    std::vector<uint32_t> retiring;             // 本条指令中停止的通道
+
+    void checkLane(uint32_t lane) const;
+    bool stopped(uint32_t lane) const {
+        return stopReasons[lane] != StopReason::NONE && stopReasons[lane] != StopReason::STEP_LIMIT;
+    }
+    uint64_t* reg(uint8_t r) { return regs.data() + r * stride; }
+    uint32_t laneNZCV(uint32_t lane, uint8_t kind) const;
+    const Op& fetch(uint64_t pc, Op& slowOp);
+
+    // 组的形成与解散
+    bool schedule(uint64_t maxSteps);
+    void flushGroup(bool writePC);
+    void retire(StopReason reason, uint64_t pc);
+    bool branchPerLane();
+
+    void executeGroup();
+    template<typename T, bool Is64> void load(const Op& op);
+    template<typename T, bool Is64> void store(const Op& op);
+    template<bool Is64> void divide(const Op& op, bool isSigned);
+    template<bool Is64> bool branchCondition(const Op& op);
+    void system(const Op& op);
+    template<typename T> void atomic(const Op& op);
+    void bulk(const Op& op);
+};
+
+// SIMT 内核的实现："avx2"、"sse2" 或 "scalar"
+const char* simtImplementation();
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "SMP.h"
+
+// ====================== 汇合栅栏 ======================
+// 可重复使用：最后到达的线程在锁内执行 completion，然后放行所有线程，completion 的结果对它们都可见
+
+namespace {
+
+class QuantumBarrier {
+public:
+    explicit QuantumBarrier(uint32_t count) : count(count) {}
+
+    template<typename F>
+    void arriveAndWait(F&& completion) {
+        std::unique_lock<std::mutex> lock(mutex);
+        const uint64_t phase = generation;
+        if (++arrived == count) {
+            completion();
+            arrived = 0;
+            ++generation;
+            ready.notify_all();
+            return;
+        }
+        ready.wait(lock, [&] { return generation != phase; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    const uint32_t count;
+    uint32_t arrived = 0;
+    uint64_t generation = 0;
+};
+
+} // namespace
+
+// ====================== 多核 ======================
+template<typename Config, typename Hooks>
+BasicSMP<Config, Hooks>::BasicSMP(uint32_t count, const MemoryLayout& layout) {
+    if (count == 0) {
+        throw std::runtime_error("SMP needs at least one core");
+    }
+    cores.push_back(std::make_unique<Core>(layout));
+    const Core& owner = *cores[0];
+    for (uint32_t i = 1; i < count; ++i) {
+        std::unique_ptr<Core> core(new Core(typename Core::Unconfigured{}));
+        core->memory.shareFrom(owner.memory);
+        core->layout = owner.layout;
+        core->codeCache.assign(owner.codeCache.size(), nullptr);
+        core->coreId = i;
+        cores.push_back(std::move(core));
+    }
+    reset();
+}
+
+template<typename Config, typename Hooks>
+void BasicSMP<Config, Hooks>::reset() {
+    const MemoryLayout& layout = cores[0]->layout;
+    const uint64_t share = (layout.stackBase - layout.stackLimit) / cores.size();
+    for (uint32_t i = 0; i < cores.size(); ++i) {
+        cores[i]->reset();
+        cores[i]->setReg(31, (layout.stackBase - i * share) & ~uint64_t(15));
+    }
+    stopReasons.assign(cores.size(), StopReason::NONE);
+    runSteps.assign(cores.size(), 0);
+}
+
+template<typename Config, typename Hooks>
+void BasicSMP<Config, Hooks>::loadProgram(const std::vector<uint32_t>& program) {
+    cores[0]->loadProgram(program);
+    for (uint32_t i = 1; i < cores.size(); ++i) cores[i]->invalidateCodeCache();
+}
+
+template<typename Config, typename Hooks>
+void BasicSMP<Config, Hooks>::setQuantum(uint64_t steps) {
+    if (steps == 0) {
+        throw std::runtime_error("SMP quantum must be at least one instruction");
+    }
+    quantum = steps;
+}
+
+template<typename Config, typename Hooks>
+void BasicSMP<Config, Hooks>::syncCode() {
+    std::vector<uint64_t> pages;
+    for (const auto& core : cores) {
+        for (uint64_t page : core->memory.changedPages()) {
+            if (page < core->codeCache.size()) pages.push_back(page);
+        }
+        core->memory.clearChanged();
+    }
+    if (pages.empty()) return;
+    std::sort(pages.begin(), pages.end());
+    pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+    for (const auto& core : cores) {
+        for (uint64_t page : pages) core->invalidateCodeRange(page << Core::CODE_PAGE_SHIFT, Core::CODE_PAGE_SIZE);
+    }
+}
+
+template<typename Config, typename Hooks>
+StopReason BasicSMP<Config, Hooks>::run(uint64_t maxSteps, ExecutionEngine engine) {
+    const uint32_t count = static_cast<uint32_t>(cores.size());
+    std::vector<uint64_t> remaining(count, maxSteps);
+    runSteps.assign(count, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!stopped(i)) stopReasons[i] = StopReason::NONE;
+    }
+    syncCode();     // 调用者在两次 run() 之间可能改写了代码
+
+    QuantumBarrier barrier(count);
+    bool finished = false;      // 只在汇合时由最后到达的线程写入
+
+    // 每个核的状态只由它的线程改写，汇合时所有线程都在栅栏内
+    auto work = [&](uint32_t id) {
+        Core& core = *cores[id];
+        for (;;) {
+            if (!stopped(id) && remaining[id] > 0) {
+                const uint64_t slice = std::min(quantum, remaining[id]);
+                StopReason reason = StopReason::NONE;
+                switch (engine) {
+                case ExecutionEngine::INTERPRETER: reason = core.run(slice); break;
+                case ExecutionEngine::BLOCKS:      reason = core.runBlocks(slice); break;
+                case ExecutionEngine::JIT:         reason = core.runJit(slice); break;
+                }
+                remaining[id] -= core.getRunSteps();
+                runSteps[id] += core.getRunSteps();
+                stopReasons[id] = reason;
+            }
+            barrier.arriveAndWait([&] {
+                syncCode();
+                finished = true;
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (!stopped(i) && remaining[i] > 0) finished = false;
+                }
+            });
+            if (finished) return;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < count; ++i) threads.emplace_back(work, i);
+    work(0);    // 调用线程执行核0
+    for (std::thread& t : threads) t.join();
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!stopped(i)) return StopReason::STEP_LIMIT;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        if (stopReasons[i] != StopReason::HALT) return stopReasons[i];
+    }
+    return StopReason::HALT;
+}
+
+// 只有连续内存的配置可以共享内存
+template class BasicSMP<DefaultConfig, NoHooks>;
+template class BasicSMP<DefaultConfig, ProfileHooks>;
+template class BasicSMP<UncheckedConfig, NoHooks>;
+template class BasicSMP<VirtualConfig, NoHooks>;
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CPU.h"
+
+// ========================== 多核 ==========================
+// N 个客户机核共享一块内存，各有自己的寄存器、PC、NZCV、预译码缓存、JIT代码与独占监视器；
+// MRS Xd, MPIDR_EL1 读出核的编号（0 .. N-1），所有核从同一个程序入口开始执行。
+// run() 使每个核在自己的宿主机线程上执行，以 quantum 条指令为一个时间片，片尾在栅栏处汇合：
+// 一个核改写的代码在汇合之后才对其他核生效（本核的改写立即生效）。
+// 核之间用 LDXR/STXR、LDADD、CAS 与 DMB 同步（见 ISA.h），它们直接使用宿主机的原子操作；
+// 普通的 LDR/STR 不是原子的，未经同步的并发访问结果不确定。
+// 只支持连续内存（FlatMemory）；各核的脏页记录由汇合时的代码同步使用，getDirtyPages() 对这些核没有意义
+template<typename Config, typename Hooks>
+class BasicSMP {
+public:
+    using Core = BasicCPU<Config, Hooks>;
+    static_assert(Core::Memory::SHAREABLE, "SMP cores need memory that can be shared between host threads");
+
+    static constexpr uint64_t DEFAULT_QUANTUM = 10000;
+
+    // cores 为0或布局无效时抛出异常
+    explicit BasicSMP(uint32_t cores, const MemoryLayout& layout = Config::LAYOUT);
+
+    BasicSMP(const BasicSMP&) = delete;
+    BasicSMP& operator=(const BasicSMP&) = delete;
+
+    uint32_t getCoreCount() const { return static_cast<uint32_t>(cores.size()); }
+    Core& getCore(uint32_t id) { return *cores.at(id); }
+    const Core& getCore(uint32_t id) const { return *cores.at(id); }
+
+    // 复位所有核并清零内存；栈区 [stackLimit, stackBase) 按核数均分，核 i 的SP为第 i 份的顶端（16字节对齐）
+    void reset();
+    // 加载程序到共享内存，不改变各核的PC
+    void loadProgram(const std::vector<uint32_t>& program);
+
+    // 所有核并行执行，每个核至多 maxSteps 条指令；已停止（HLT或出错）的核不再执行，直到 reset()。
+    // 仍有核用完步数时返回 STEP_LIMIT，否则返回编号最小的出错核的停止原因，都执行了HLT时返回 HALT
+    StopReason run(uint64_t maxSteps, ExecutionEngine engine = ExecutionEngine::JIT);
+
+    // 核 id 的停止原因：尚未停止时为 NONE 或 STEP_LIMIT
+    StopReason getStopReason(uint32_t id) const { return stopReasons.at(id); }
+    // 最近一次 run() 中核 id 执行的指令数
+    uint64_t getRunSteps(uint32_t id) const { return runSteps.at(id); }
+
+    // 时间片越短，跨核的代码改写生效越快，汇合的开销越大；为0时抛出异常
+    void setQuantum(uint64_t steps);
+    uint64_t getQuantum() const { return quantum; }
+
+private:
+    std::vector<std::unique_ptr<Core>> cores;   // 核0拥有内存，其余核共享它
+    std::vector<StopReason> stopReasons;
+    std::vector<uint64_t> runSteps;
+    uint64_t quantum = DEFAULT_QUANTUM;
+
+    bool stopped(uint32_t id) const {
+        return stopReasons[id] != StopReason::NONE && stopReasons[id] != StopReason::STEP_LIMIT;
+    }
+    // 在汇合时调用（所有核都已停下）：使各核写过的代码页在所有核上失效
+    void syncCode();
+};
+
+using SMP = BasicSMP<DefaultConfig, NoHooks>;
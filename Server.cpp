@@ -0,0 +1,368 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include "Assembler.h"
+#include "Server.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TINY_HAS_UNIX_SOCKETS 1
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// ====================== 帧编解码 ======================
+
+namespace {
+
+// 按小端顺序读取请求内容；越过末尾时抛出异常
+class FrameReader {
+public:
+    explicit FrameReader(const std::vector<uint8_t>& bytes) : p(bytes.data()), end(bytes.data() + bytes.size()) {}
+
+    template<typename T>
+    T read() {
+        need(sizeof(T));
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<T>(p[i]) << (i * 8);
+        p += sizeof(T);
+        return value;
+    }
+
+    const uint8_t* bytes(size_t size) {
+        need(size);
+        const uint8_t* begin = p;
+        p += size;
+        return begin;
+    }
+
+    bool atEnd() const { return p == end; }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+
+    void need(size_t size) const {
+        if (size > static_cast<size_t>(end - p)) throw std::runtime_error("Truncated request");
+    }
+};
+
+// 向 out 追加帧；begin() 预留长度，finish() 填写
+class FrameWriter {
+public:
+    explicit FrameWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void begin(uint8_t type) {
+        start = out.size();
+        put<uint32_t>(0);
+        put<uint8_t>(type);
+    }
+
+    template<typename T>
+    void put(T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8)));
+    }
+
+    void putString(const std::string& text) {
+        put<uint32_t>(static_cast<uint32_t>(text.size()));
+        out.insert(out.end(), text.begin(), text.end());
+    }
+
+    void finish() {
+        const uint32_t length = static_cast<uint32_t>(out.size() - start - sizeof(uint32_t));
+        for (size_t i = 0; i < sizeof(uint32_t); ++i) out[start + i] = static_cast<uint8_t>(length >> (i * 8));
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    size_t start = 0;
+};
+
+uint8_t packNZCV(const StatusRegister& s) {
+    return static_cast<uint8_t>((s.N << 3) | (s.Z << 2) | (s.C << 1) | static_cast<uint8_t>(s.V));
+}
+
+} // namespace
+
+// ====================== 请求处理 ======================
+JobServer::JobServer(unsigned threads) : runner(threads) {}
+
+std::vector<uint32_t> JobServer::assembleCached(const std::string& text) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = programs.find(text);
+        if (it != programs.end()) return it->second;
+    }
+    Assembler assembler;
+    assembler.setVerbose(false);
+    std::vector<uint32_t> program = assembler.assemble(text);   // 在锁外汇编，失败时不缓存
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (programs.size() >= PROGRAM_CACHE_LIMIT) programs.clear();
+    programs.emplace(text, program);
+    return program;
+}
+
+void JobServer::handleRequest(const std::vector<uint8_t>& request, const std::function<void(const std::vector<uint8_t>&)>& emit) {
+    std::vector<uint8_t> out;
+    FrameWriter writer(out);
+
+    // 先解析整个请求：请求无效时不执行任何作业
+    std::vector<BatchJob> jobs;
+    std::vector<std::string> errors;        // 汇编失败等，作业不执行
+    ExecutionEngine engine = ExecutionEngine::JIT;
+    try {
+        FrameReader reader(request);
+        if (reader.read<uint8_t>() != 'B') throw std::runtime_error("Unknown request type");
+        const uint8_t engineId = reader.read<uint8_t>();
+        if (engineId > static_cast<uint8_t>(ExecutionEngine::JIT)) throw std::runtime_error("Unknown execution engine: " + std::to_string(engineId));
+        engine = static_cast<ExecutionEngine>(engineId);
+
+        const uint32_t count = reader.read<uint32_t>();
+        for (uint32_t i = 0; i < count; ++i) {
+            BatchJob job;
+            std::string error;
+            const uint8_t format = reader.read<uint8_t>();
+            const uint32_t size = reader.read<uint32_t>();
+            const uint8_t* program = reader.bytes(size);
+            if (format == 0) {
+                try {
+                    job.program = assembleCached(std::string(reinterpret_cast<const char*>(program), size));
+                } catch (const std::exception& e) {
+                    error = e.what();
+                }
+            } else if (format == 1) {
+                if (size % 4 != 0) throw std::runtime_error("Machine code size is not a multiple of 4");
+                job.program.resize(size / 4);
+                for (size_t w = 0; w < job.program.size(); ++w) {
+                    for (size_t b = 0; b < 4; ++b) job.program[w] |= static_cast<uint32_t>(program[w * 4 + b]) << (b * 8);
+                }
+            } else {
+                throw std::runtime_error("Unknown program format: " + std::to_string(format));
+            }
+
+            job.maxSteps = reader.read<uint64_t>();
+            job.pc = reader.read<uint64_t>();
+            const uint8_t nzcv = reader.read<uint8_t>();
+            job.status = StatusRegister{(nzcv & 8) != 0, (nzcv & 4) != 0, (nzcv & 2) != 0, (nzcv & 1) != 0};
+            const uint8_t regCount = reader.read<uint8_t>();
+            for (uint8_t r = 0; r < regCount; ++r) {
+                const uint8_t idx = reader.read<uint8_t>();
+                job.registers.emplace_back(idx, reader.read<uint64_t>());
+            }
+            const uint32_t memCount = reader.read<uint32_t>();
+            for (uint32_t m = 0; m < memCount; ++m) {
+                BatchMemoryInit init;
+                init.address = reader.read<uint64_t>();
+                const uint32_t length = reader.read<uint32_t>();
+                const uint8_t* bytes = reader.bytes(length);
+                init.bytes.assign(bytes, bytes + length);
+                job.memory.push_back(std::move(init));
+            }
+            jobs.push_back(std::move(job));
+            errors.push_back(std::move(error));
+        }
+        if (!reader.atEnd()) throw std::runtime_error("Trailing bytes in request");
+    } catch (const std::exception& e) {
+        writer.begin('E');
+        writer.putString(e.what());
+        writer.finish();
+        writer.begin('D');
+        writer.put<uint32_t>(0);
+        writer.finish();
+        emit(out);
+        return;
+    }
+
+    // 按 STREAM_CHUNK 分段执行，每段执行完即发出结果
+    for (size_t first = 0; first < jobs.size() || first == 0; first += STREAM_CHUNK) {
+        const size_t last = std::min(jobs.size(), first + STREAM_CHUNK);
+        std::vector<BatchJob> chunk;
+        std::vector<size_t> indices;
+        for (size_t i = first; i < last; ++i) {
+            if (!errors[i].empty()) continue;
+            chunk.push_back(std::move(jobs[i]));
+            indices.push_back(i);
+        }
+        std::vector<BatchResult> results;
+        if (!chunk.empty()) {
+            std::lock_guard<std::mutex> lock(runnerMutex);
+            results = runner.run(chunk, engine);
+        }
+
+        size_t next = 0;
+        for (size_t i = first; i < last; ++i) {
+            BatchResult failed;
+            const bool ran = next < indices.size() && indices[next] == i;
+            const BatchResult& result = ran ? results[next++] : failed;
+            if (!ran) failed.error = errors[i];
+
+            writer.begin('R');
+            writer.put<uint32_t>(static_cast<uint32_t>(i));
+            writer.put<uint8_t>(static_cast<uint8_t>(result.reason));
+            writer.put<uint64_t>(result.steps);
+            writer.put<uint64_t>(result.pc);
+            writer.put<uint8_t>(packNZCV(result.status));
+            for (uint64_t value : result.regs) writer.put<uint64_t>(value);
+            writer.put<uint64_t>(result.faultAddress);
+            writer.put<uint8_t>(static_cast<uint8_t>(result.faultAccess));
+            writer.putString(result.error);
+            writer.finish();
+        }
+        if (last == jobs.size()) {
+            writer.begin('D');
+            writer.put<uint32_t>(static_cast<uint32_t>(jobs.size()));
+            writer.finish();
+        }
+        emit(out);
+        out.clear();
+    }
+}
+
+// ====================== 连接 ======================
+#ifdef TINY_HAS_UNIX_SOCKETS
+
+namespace {
+
+// 读满 size 字节；对端在帧开头关闭时返回false，帧中途关闭或出错时抛出异常
+bool readExact(int fd, uint8_t* data, size_t size, bool atFrameStart) {
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t n = ::read(fd, data + done, size - done);
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+        } else if (n == 0) {
+            if (done == 0 && atFrameStart) return false;
+            throw std::runtime_error("Connection closed in the middle of a frame");
+        } else if (errno != EINTR) {
+            throw std::runtime_error(std::string("read failed: ") + std::strerror(errno));
+        }
+    }
+    return true;
+}
+
+void writeAll(int fd, const std::vector<uint8_t>& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+        } else if (n < 0 && errno != EINTR) {
+            throw std::runtime_error(std::string("write failed: ") + std::strerror(errno));
+        }
+    }
+}
+
+} // namespace
+
+void JobServer::serveStream(int inFd, int outFd) {
+    std::vector<uint8_t> request;
+    for (;;) {
+        uint8_t header[sizeof(uint32_t)];
+        if (!readExact(inFd, header, sizeof(header), true)) return;
+        const uint32_t length = header[0] | (header[1] << 8) | (header[2] << 16) | (static_cast<uint32_t>(header[3]) << 24);
+        if (length > MAX_FRAME) {
+            throw std::runtime_error("Frame too large: " + std::to_string(length));
+        }
+        request.resize(length);
+        readExact(inFd, request.data(), length, false);
+        handleRequest(request, [&](const std::vector<uint8_t>& frames) { writeAll(outFd, frames); });
+    }
+}
+
+void JobServer::serveSocket(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+    }
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        const std::string reason = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("Cannot listen on " + path + ": " + reason);
+    }
+
+    for (;;) {
+        const int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            const std::string reason = std::strerror(errno);
+            ::close(listener);
+            throw std::runtime_error("accept failed: " + reason);
+        }
+        // 连接出错只关闭该连接
+        std::thread([this, client] {
+            try {
+                serveStream(client, client);
+            } catch (const std::exception& e) {
+                std::cerr << "connection closed: " << e.what() << std::endl;
+            }
+            ::close(client);
+        }).detach();
+    }
+}
+
+#else
+
+void JobServer::serveStream(int inFd, int outFd) {
+    throw std::runtime_error("The job server needs a POSIX system");
+}
+
+void JobServer::serveSocket(const std::string& path) {
+    throw std::runtime_error("The job server needs a POSIX system");
+}
+
+#endif
+
+// ====================== 命令行 ======================
+int serverMain(const std::vector<std::string>& args) {
+    std::string path;
+    bool stdio = false;
+    unsigned threads = 0;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--serve" && i + 1 < args.size()) {
+            path = args[++i];
+        } else if (args[i] == "--serve-stdio") {
+            stdio = true;
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads = static_cast<unsigned>(std::stoul(args[++i]));
+        } else {
+            std::cerr << "usage: TinyAArch64 (--serve <socket path> | --serve-stdio) [--threads N]" << std::endl;
+            return 2;
+        }
+    }
+    if (path.empty() == !stdio) {
+        std::cerr << "usage: TinyAArch64 (--serve <socket path> | --serve-stdio) [--threads N]" << std::endl;
+        return 2;
+    }
+
+    try {
+        JobServer server(threads);
+#ifdef TINY_HAS_UNIX_SOCKETS
+        std::signal(SIGPIPE, SIG_IGN);      // 对端关闭时 write() 返回错误，而不是终止进程
+        if (stdio) {
+            // 标准输出只用于响应帧，其他输出改到标准错误
+            const int out = ::dup(STDOUT_FILENO);
+            ::dup2(STDERR_FILENO, STDOUT_FILENO);
+            server.serveStream(STDIN_FILENO, out);
+            return 0;
+        }
+#endif
+        server.serveSocket(path);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
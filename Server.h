@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BatchRunner.h"
+
+// ========================== 执行服务 ==========================
+// 常驻的无界面进程（TinyAArch64 --serve <套接字路径> 或 --serve-stdio），在Unix域套接字或标准输入/输出上
+// 接受批量作业。CPU池（BatchRunner）与汇编结果缓存在请求之间保留：每个作业只需 reset()（只清零上个作业写过的页）
+// 与执行本身，不再为每个作业启动进程、汇编程序与清零整块内存。
+//
+// 通信由帧组成：uint32_t 长度（不含自身，至多 MAX_FRAME）后接这么多字节的内容，整数均为小端。
+// 请求帧（类型 'B'，一批作业）：
+//   uint8_t  'B'
+//   uint8_t  执行方式（ExecutionEngine：0 解释器、1 基本块、2 JIT）
+//   uint32_t 作业数，其后依次为各作业：
+//     uint8_t  程序格式：0 汇编文本、1 机器码（小端指令字，长度为4的倍数）
+//     uint32_t 程序长度，其后为程序内容
+//     uint64_t 步数预算、uint64_t 初始PC、uint8_t 初始NZCV（N<<3|Z<<2|C<<1|V）
+//     uint8_t  寄存器个数，每个为 uint8_t 编号、uint64_t 值（31为SP）
+//     uint32_t 内存段数，每段为 uint64_t 地址、uint32_t 长度与内容（在加载程序之后写入）
+// 响应：每 STREAM_CHUNK 个作业执行完即按作业顺序发出它们的结果帧，最后是结束帧：
+//   'R' 结果：uint32_t 作业序号、uint8_t 停止原因（StopReason）、uint64_t 步数、uint64_t PC、uint8_t NZCV、
+//       32个 uint64_t 寄存器、uint64_t 出错地址、uint8_t 访存类型（MemoryAccess）、uint32_t 错误信息长度与内容。
+//       汇编失败、程序过大等作业的停止原因为 NONE，原因见错误信息
+//   'E' 请求无效：uint32_t 长度与错误信息；其后没有结果帧
+//   'D' 结束：uint32_t 作业数
+// 帧长度超过 MAX_FRAME 或连接中途断开时关闭连接。只支持POSIX系统
+
+class JobServer {
+public:
+    static constexpr uint32_t MAX_FRAME = 64u << 20;
+    static constexpr size_t STREAM_CHUNK = 1024;
+    static constexpr size_t PROGRAM_CACHE_LIMIT = 1024;     // 缓存满时整体清空
+
+    // threads 为0时使用宿主机的核数
+    explicit JobServer(unsigned threads = 0);
+
+    JobServer(const JobServer&) = delete;
+    JobServer& operator=(const JobServer&) = delete;
+
+    // 在 path 上监听（先删除已存在的文件），每个连接一个线程；只在出错时返回（抛出异常）
+    void serveSocket(const std::string& path);
+    // 在一对文件描述符上处理请求，直到对端关闭；可以同时在多个线程上调用
+    void serveStream(int inFd, int outFd);
+
+    // 处理一个请求帧的内容（不含长度），响应帧（含长度前缀）分段交给 emit：每 STREAM_CHUNK 个作业一段，最后一段含结束帧
+    void handleRequest(const std::vector<uint8_t>& request, const std::function<void(const std::vector<uint8_t>&)>& emit);
+
+private:
+    BatchRunner<CPU> runner;
+    std::mutex runnerMutex;             // 同一时刻只有一个连接使用CPU池
+
+    std::mutex cacheMutex;
+    std::unordered_map<std::string, std::vector<uint32_t>> programs;
+
+    // 汇编失败时抛出异常
+    std::vector<uint32_t> assembleCached(const std::string& text);
+};
+
+// 命令行入口：args 为 --serve <路径> 或 --serve-stdio，可以附加 --threads <N>；返回进程退出码
+int serverMain(const std::vector<std::string>& args);
@@ -0,0 +1,300 @@
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Assembler.h"
+#include "Server.h"
+
+// ========================== 执行服务测试 ==========================
+// 直接调用 JobServer::handleRequest()，不经过套接字：
+//   一批作业（每种执行方式）：汇编文本与机器码程序、初始寄存器/NZCV/内存、访存错误，
+//     汇编失败与寄存器编号越界的作业停止原因为 NONE 并带有错误信息，不影响其他作业
+//   无效请求（截断、未知类型或执行方式）：一段 'E' 帧后接 'D'（作业数0）
+//   超过 STREAM_CHUNK 个作业：按 STREAM_CHUNK 分段发出，作业序号连续，只有最后一段含 'D'
+// 全部通过时返回0
+
+namespace {
+
+// ====================== 请求与响应 ======================
+
+class RequestBuilder {
+public:
+    RequestBuilder(ExecutionEngine engine, uint32_t jobs) {
+        put<uint8_t>('B');
+        put<uint8_t>(static_cast<uint8_t>(engine));
+        put<uint32_t>(jobs);
+    }
+
+    template<typename T>
+    void put(T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) bytes.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8)));
+    }
+
+    void putBytes(const void* data, size_t size) {
+        put<uint32_t>(static_cast<uint32_t>(size));
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), p, p + size);
+    }
+
+    struct Memory {
+        uint64_t address;
+        std::vector<uint8_t> bytes;
+    };
+
+    // format 0 为汇编文本，1 为机器码
+    void job(uint8_t format, const std::string& program, const std::vector<std::pair<uint8_t, uint64_t>>& regs = {},
+             uint8_t nzcv = 0, const std::vector<Memory>& memory = {}, uint64_t maxSteps = 1000) {
+        put<uint8_t>(format);
+        putBytes(program.data(), program.size());
+        put<uint64_t>(maxSteps);
+        put<uint64_t>(0);
+        put<uint8_t>(nzcv);
+        put<uint8_t>(static_cast<uint8_t>(regs.size()));
+        for (const auto& [idx, value] : regs) {
+            put<uint8_t>(idx);
+            put<uint64_t>(value);
+        }
+        put<uint32_t>(static_cast<uint32_t>(memory.size()));
+        for (const Memory& m : memory) {
+            put<uint64_t>(m.address);
+            putBytes(m.bytes.data(), m.bytes.size());
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+};
+
+struct Frame {
+    uint8_t type;
+    std::vector<uint8_t> body;      // 类型之后的内容
+};
+
+struct Result {
+    uint32_t index;
+    StopReason reason;
+    uint64_t steps;
+    uint64_t pc;
+    uint8_t nzcv;
+    uint64_t regs[32];
+    uint64_t faultAddress;
+    MemoryAccess faultAccess;
+    std::string error;
+};
+
+template<typename T>
+T readLE(const std::vector<uint8_t>& bytes, size_t& at) {
+    if (at + sizeof(T) > bytes.size()) throw std::runtime_error("response frame is too short");
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<T>(bytes[at + i]) << (i * 8);
+    at += sizeof(T);
+    return value;
+}
+
+std::string readString(const std::vector<uint8_t>& bytes, size_t& at) {
+    const uint32_t size = readLE<uint32_t>(bytes, at);
+    if (at + size > bytes.size()) throw std::runtime_error("response string is too long");
+    std::string text(bytes.begin() + at, bytes.begin() + at + size);
+    at += size;
+    return text;
+}
+
+// 一次 emit 的内容拆成帧
+std::vector<Frame> splitFrames(const std::vector<uint8_t>& chunk) {
+    std::vector<Frame> frames;
+    size_t at = 0;
+    while (at < chunk.size()) {
+        const uint32_t length = readLE<uint32_t>(chunk, at);
+        if (length == 0 || at + length > chunk.size()) throw std::runtime_error("bad frame length");
+        frames.push_back({chunk[at], std::vector<uint8_t>(chunk.begin() + at + 1, chunk.begin() + at + length)});
+        at += length;
+    }
+    return frames;
+}
+
+Result parseResult(const Frame& frame) {
+    Result r;
+    size_t at = 0;
+    r.index = readLE<uint32_t>(frame.body, at);
+    r.reason = static_cast<StopReason>(readLE<uint8_t>(frame.body, at));
+    r.steps = readLE<uint64_t>(frame.body, at);
+    r.pc = readLE<uint64_t>(frame.body, at);
+    r.nzcv = readLE<uint8_t>(frame.body, at);
+    for (uint64_t& value : r.regs) value = readLE<uint64_t>(frame.body, at);
+    r.faultAddress = readLE<uint64_t>(frame.body, at);
+    r.faultAccess = static_cast<MemoryAccess>(readLE<uint8_t>(frame.body, at));
+    r.error = readString(frame.body, at);
+    if (at != frame.body.size()) throw std::runtime_error("trailing bytes in a result frame");
+    return r;
+}
+
+// 处理请求，返回每次 emit 的帧
+std::vector<std::vector<Frame>> handle(JobServer& server, const std::vector<uint8_t>& request) {
+    std::vector<std::vector<Frame>> chunks;
+    server.handleRequest(request, [&](const std::vector<uint8_t>& chunk) { chunks.push_back(splitFrames(chunk)); });
+    return chunks;
+}
+
+struct Checker {
+    int failures = 0;
+
+    void expect(bool ok, const std::string& what) {
+        if (ok) return;
+        if (failures < 10) printf("  %s\n", what.c_str());
+        ++failures;
+    }
+};
+
+std::string machineCode(const std::string& text) {
+    Assembler assembler;
+    assembler.setVerbose(false);
+    const std::vector<uint32_t> words = assembler.assemble(text);
+    std::string bytes(words.size() * 4, '\0');
+    std::memcpy(bytes.data(), words.data(), bytes.size());
+    return bytes;
+}
+
+std::string assemblerError(const std::string& text) {
+    try {
+        Assembler assembler;
+        assembler.setVerbose(false);
+        assembler.assemble(text);
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+// ====================== 用例 ======================
+
+const char* const BAD_PROGRAM = "mov x0, #1\nbogus x0, x1\nHLT\n";
+
+void testMixedBatch(JobServer& server, ExecutionEngine engine, Checker& check) {
+    const std::string name = "engine " + std::to_string(static_cast<int>(engine)) + ": ";
+    const uint64_t value = 0x1122334455667788ULL;
+    std::vector<uint8_t> valueBytes(sizeof(value));
+    std::memcpy(valueBytes.data(), &value, sizeof(value));
+
+    RequestBuilder request(engine, 5);
+    request.job(0, "mov x0, #5\nadd x0, x0, x1\nHLT\n", {{1, 10}});
+    request.job(1, machineCode("mov x8, #0x4000\nldr x2, [x8]\nHLT\n"), {}, 0b1010, {{0x4000, valueBytes}});
+    request.job(0, BAD_PROGRAM);
+    request.job(0, "HLT\n", {{40, 1}});
+    request.job(0, "mov x8, #-8\nldr x1, [x8]\nHLT\n");
+
+    const auto chunks = handle(server, request.bytes);
+    check.expect(chunks.size() == 1 && chunks[0].size() == 6, name + "one chunk with 5 results and 'D'");
+    if (chunks.size() != 1 || chunks[0].size() != 6) return;
+    const std::vector<Frame>& frames = chunks[0];
+    std::vector<Result> results;
+    for (size_t i = 0; i < 5; ++i) {
+        check.expect(frames[i].type == 'R', name + "result frame");
+        results.push_back(parseResult(frames[i]));
+        check.expect(results[i].index == i, name + "results are in job order");
+    }
+    size_t at = 0;
+    check.expect(frames[5].type == 'D' && readLE<uint32_t>(frames[5].body, at) == 5, name + "'D' carries the job count");
+
+    check.expect(results[0].reason == StopReason::HALT && results[0].regs[0] == 15 && results[0].steps == 3 &&
+                 results[0].error.empty(), name + "assembly job runs with its initial registers");
+    check.expect(results[1].reason == StopReason::HALT && results[1].regs[2] == value && results[1].nzcv == 0b1010,
+                 name + "machine code job sees its memory and NZCV");
+    check.expect(results[2].reason == StopReason::NONE && results[2].steps == 0 &&
+                 results[2].error == assemblerError(BAD_PROGRAM) && !results[2].error.empty(),
+                 name + "assembler error is reported with reason NONE: " + results[2].error);
+    check.expect(results[3].reason == StopReason::NONE && results[3].steps == 0 &&
+                 results[3].error.find("Invalid register") != std::string::npos,
+                 name + "register index 40 is reported with reason NONE: " + results[3].error);
+    check.expect(results[4].reason == StopReason::MEMORY_FAULT && results[4].faultAddress == ~uint64_t(7) &&
+                 results[4].faultAccess == MemoryAccess::READ, name + "memory fault address and access");
+}
+
+void testInvalidRequests(JobServer& server, Checker& check) {
+    RequestBuilder valid(ExecutionEngine::JIT, 1);
+    valid.job(0, "HLT\n");
+    std::vector<uint8_t> truncated = valid.bytes;
+    truncated.pop_back();
+    std::vector<uint8_t> unknownType = valid.bytes;
+    unknownType[0] = 'X';
+    std::vector<uint8_t> unknownEngine = valid.bytes;
+    unknownEngine[1] = 9;
+    std::vector<uint8_t> trailing = valid.bytes;
+    trailing.push_back(0);
+
+    const struct {
+        const char* name;
+        const std::vector<uint8_t>& request;
+    } cases[] = {{"truncated", truncated}, {"unknown type", unknownType}, {"unknown engine", unknownEngine},
+                 {"trailing bytes", trailing}, {"empty", std::vector<uint8_t>()}};
+    for (const auto& c : cases) {
+        const auto chunks = handle(server, c.request);
+        bool ok = chunks.size() == 1 && chunks[0].size() == 2 && chunks[0][0].type == 'E' && chunks[0][1].type == 'D';
+        if (ok) {
+            size_t at = 0;
+            ok = !readString(chunks[0][0].body, at).empty();
+            at = 0;
+            ok = ok && readLE<uint32_t>(chunks[0][1].body, at) == 0;
+        }
+        check.expect(ok, std::string(c.name) + " request answers 'E' then 'D' with no results");
+    }
+
+    const auto chunks = handle(server, truncated);
+    size_t at = 0;
+    check.expect(!chunks.empty() && !chunks[0].empty() && readString(chunks[0][0].body, at) == "Truncated request",
+                 "truncated request names the problem");
+}
+
+void testStreaming(JobServer& server, Checker& check) {
+    const uint32_t jobs = 2 * JobServer::STREAM_CHUNK + 452;
+    const std::string program = machineCode("add x0, x1, #1\nHLT\n");
+    RequestBuilder request(ExecutionEngine::JIT, jobs);
+    for (uint32_t i = 0; i < jobs; ++i) request.job(1, program, {{1, i}});
+
+    const auto chunks = handle(server, request.bytes);
+    check.expect(chunks.size() == 3, "jobs are streamed in STREAM_CHUNK pieces: " + std::to_string(chunks.size()) + " chunks");
+    uint32_t next = 0;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        const bool last = c + 1 == chunks.size();
+        const size_t results = chunks[c].size() - (last ? 1 : 0);
+        check.expect(results == (last ? jobs % JobServer::STREAM_CHUNK : JobServer::STREAM_CHUNK),
+                     "chunk " + std::to_string(c) + " holds " + std::to_string(results) + " results");
+        for (size_t i = 0; i < chunks[c].size(); ++i) {
+            const Frame& frame = chunks[c][i];
+            if (last && i + 1 == chunks[c].size()) {
+                size_t at = 0;
+                check.expect(frame.type == 'D' && readLE<uint32_t>(frame.body, at) == jobs, "last chunk ends with 'D'");
+                continue;
+            }
+            if (frame.type != 'R') {
+                check.expect(false, "chunk " + std::to_string(c) + " has a non-result frame before the end");
+                continue;
+            }
+            const Result r = parseResult(frame);
+            check.expect(r.index == next && r.reason == StopReason::HALT && r.regs[0] == next + 1u,
+                         "job " + std::to_string(next) + " result");
+            ++next;
+        }
+    }
+    check.expect(next == jobs, "every job has a result");
+}
+
+} // namespace
+
+int main() {
+    JobServer server(2);
+    Checker check;
+    try {
+        for (ExecutionEngine engine : {ExecutionEngine::INTERPRETER, ExecutionEngine::BLOCKS, ExecutionEngine::JIT}) {
+            testMixedBatch(server, engine, check);
+        }
+        testInvalidRequests(server, check);
+        testStreaming(server, check);
+    } catch (const std::exception& e) {
+        check.expect(false, std::string("unexpected exception: ") + e.what());
+    }
+
+    printf("%d failures\n", check.failures);
+    printf(check.failures == 0 ? "PASS\n" : "FAIL\n");
+    return check.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SIMT.h"
+
+// ========================== SIMT 差分测试 ==========================
+// 随机程序以每个通道不同的初始寄存器在 SimtEngine 上执行，每个通道的结果与同样初始化的 CPU 单独 run() 比较：
+// 停止原因、执行的指令数、出错地址、PC、NZCV、寄存器与低端内存。通道数不是向量宽度的倍数，
+// 分支条件随通道不同，使通道分歧、等待与重汇合；SIMT 分别以整个预算与小预算分多次执行。
+// 程序中没有改写代码的存储（SIMT 总是从 loadProgram() 的映像取指）。全部一致时返回0
+
+namespace {
+
+const uint64_t MAX_STEPS = 4000;
+const uint64_t SMALL_BUDGET = 7;
+const uint32_t LANES = 13;
+const size_t MEMORY_WINDOW = 0x8000;    // 程序与数据都在这里（imm16 为有符号数）
+const int RANDOM_PROGRAMS = 200;
+
+const uint32_t HLT = uint32_t(OP_SYS) << 26;
+
+uint32_t encode(bool sf, uint8_t opcode, uint8_t rd, uint8_t rn, uint32_t low) {
+    return (uint32_t(sf) << 31) | (uint32_t(opcode) << 26) | (uint32_t(rd) << 21) | (uint32_t(rn) << 16) | (low & 0xFFFF);
+}
+
+// 分支偏移以指令计，相对下一条指令
+uint32_t branch(uint8_t opcode, size_t from, size_t to) {
+    return encode(false, opcode, 0, 0, static_cast<uint32_t>(static_cast<int32_t>(to) - static_cast<int32_t>(from) - 1));
+}
+
+uint32_t branchCond(BranchCondition cond, size_t from, size_t to) {
+    return branch(OP_B_COND, from, to) | (uint32_t(cond) << 22);
+}
+
+// 系统指令：子操作码位于 [15:8]，第三个寄存器位于 [4:0]
+uint32_t systemInstr(bool sf, uint8_t subop, uint8_t r1, uint8_t r2, uint8_t r3) {
+    return encode(sf, OP_SYS, r1, r2, (uint32_t(subop) << 8) | r3);
+}
+
+// ====================== 执行与比较 ======================
+
+struct LaneState {
+    StopReason reason = StopReason::NONE;
+    uint64_t steps = 0;
+    uint64_t faultAddress = 0;
+    uint64_t pc = 0;
+    std::string nzcv;
+    std::array<uint64_t, 32> regs{};
+    std::vector<uint8_t> memory;
+
+    bool operator==(const LaneState& o) const {
+        return reason == o.reason && steps == o.steps && faultAddress == o.faultAddress && pc == o.pc &&
+               nzcv == o.nzcv && regs == o.regs && memory == o.memory;
+    }
+};
+
+using Inputs = std::array<uint64_t, 8>;    // x0~x7 的初始值
+
+LaneState runCpu(CPU& cpu, const std::vector<uint32_t>& program, const Inputs& inputs) {
+    cpu.reset();
+    cpu.loadProgram(program);
+    for (uint8_t r = 0; r < inputs.size(); ++r) cpu.setReg(r, inputs[r]);
+    LaneState s;
+    s.reason = cpu.run(MAX_STEPS);
+    s.steps = cpu.getRunSteps();
+    s.faultAddress = s.reason == StopReason::MEMORY_FAULT ? cpu.getFaultAddress() : 0;
+    s.pc = cpu.getPC();
+    s.nzcv = cpu.getStatusReg().toString();
+    for (uint8_t i = 0; i < 32; ++i) s.regs[i] = cpu.getReg(i);
+    s.memory = cpu.readMemoryRange(0, MEMORY_WINDOW);
+    return s;
+}
+
+std::vector<LaneState> runSimt(SimtEngine& simt, const std::vector<uint32_t>& program, const std::vector<Inputs>& inputs,
+                               uint64_t budget) {
+    simt.reset();
+    simt.loadProgram(program);
+    for (uint32_t lane = 0; lane < LANES; ++lane) {
+        for (uint8_t r = 0; r < inputs[lane].size(); ++r) simt.setReg(lane, r, inputs[lane][r]);
+    }
+    std::vector<LaneState> lanes(LANES);
+    uint64_t used = 0;      // 未停止的通道都用完每次的预算
+    while (used < MAX_STEPS) {
+        const uint64_t slice = std::min(budget, MAX_STEPS - used);
+        const StopReason reason = simt.run(slice);
+        for (uint32_t lane = 0; lane < LANES; ++lane) lanes[lane].steps += simt.getRunSteps(lane);
+        used += slice;
+        if (reason != StopReason::STEP_LIMIT) break;
+    }
+    for (uint32_t lane = 0; lane < LANES; ++lane) {
+        LaneState& s = lanes[lane];
+        s.reason = simt.getStopReason(lane);
+        s.faultAddress = s.reason == StopReason::MEMORY_FAULT ? simt.getFaultAddress(lane) : 0;
+        s.pc = simt.getPC(lane);
+        s.nzcv = simt.getStatusReg(lane).toString();
+        for (uint8_t i = 0; i < 32; ++i) s.regs[i] = simt.getReg(lane, i);
+        s.memory = simt.readMemoryRange(lane, 0, MEMORY_WINDOW);
+    }
+    return lanes;
+}
+
+void report(int seed, uint32_t lane, uint64_t budget, const LaneState& expected, const LaneState& actual) {
+    printf("MISMATCH random-%d lane %u (budget %llu)\n", seed, lane, static_cast<unsigned long long>(budget));
+    printf("  reason %d / %d, steps %llu / %llu, fault %llx / %llx, pc %llx / %llx, nzcv %s / %s\n",
+           static_cast<int>(expected.reason), static_cast<int>(actual.reason),
+           static_cast<unsigned long long>(expected.steps), static_cast<unsigned long long>(actual.steps),
+           static_cast<unsigned long long>(expected.faultAddress), static_cast<unsigned long long>(actual.faultAddress),
+           static_cast<unsigned long long>(expected.pc), static_cast<unsigned long long>(actual.pc),
+           expected.nzcv.c_str(), actual.nzcv.c_str());
+    for (int i = 0; i < 32; ++i) {
+        if (expected.regs[i] != actual.regs[i]) {
+            printf("  x%d %llx / %llx\n", i, static_cast<unsigned long long>(expected.regs[i]), static_cast<unsigned long long>(actual.regs[i]));
+        }
+    }
+    if (expected.memory != actual.memory) printf("  memory differs\n");
+}
+
+// ====================== 随机程序 ======================
+// 同 DiffTest 的随机程序，但 x0~x7 由各通道设置，存储与批量操作只写数据区或越界地址。
+// x8 为数据区基址，x11 为越界地址，x12 为间接分支目标，x13~x16 为批量复制/填充的操作数；x9 为循环计数
+std::vector<uint32_t> randomProgram(std::mt19937& rng) {
+    std::vector<uint32_t> p;
+    p.push_back(encode(true, OP_MOVI, 8, 0, 0x4000 + (rng() % 64) * 8));
+    p.push_back(encode(true, OP_MOVI, 9, 0, 3 + rng() % 16));
+    p.push_back(encode(true, OP_MOVI, 11, 0, 0xFFFC));
+    // 间接分支可能跳过批量操作前设置地址的指令，地址寄存器先指向数据区
+    p.push_back(encode(true, OP_MOVI, 13, 0, 0x4000));
+    p.push_back(encode(true, OP_MOVI, 14, 0, 0x4000));
+    const size_t loop = p.size();
+    const size_t length = 8 + rng() % 32;     // 循环体的大致长度，用作随机分支目标的范围
+    const size_t programEnd = loop + length + 8;
+
+    while (p.size() < loop + length) {
+        const bool sf = rng() & 1;
+        const uint8_t rd = rng() % 8, rn = rng() % 8, rm = rng() % 8;
+        const uint32_t kind = rng() % 24;
+        if (kind < 7) {
+            static const uint8_t ALU[] = {OP_ADD, OP_ADDI, OP_SUB, OP_SUBI, OP_AND, OP_ANDI, OP_ORR, OP_ORRI,
+                                          OP_EOR, OP_EORI, OP_MOV, OP_MOVI, OP_CMP, OP_CMPI, OP_MUL};
+            const uint8_t op = ALU[rng() % (sizeof(ALU) / sizeof(ALU[0]))];
+            if (op == OP_CMP) {
+                p.push_back(encode(sf, op, rn, rm, 0));
+            } else {
+                const bool immediate = (op == OP_ADDI || op == OP_SUBI || op == OP_ANDI || op == OP_ORRI ||
+                                        op == OP_EORI || op == OP_MOVI || op == OP_CMPI);
+                p.push_back(encode(sf, op, rd, rn, immediate ? rng() : rm));
+            }
+        } else if (kind < 8) {
+            if (rng() % 4) p.push_back(encode(true, OP_ORRI, rm, rm, 1));    // 偶尔保留除数为0
+            p.push_back(encode(sf, (rng() & 1) ? OP_SDIV : OP_UDIV, rd, rn, rm));
+        } else if (kind < 12) {
+            const uint8_t op = OP_LDRB + rng() % 8;
+            // 越界地址只取负的偏移，加正的偏移会回绕到代码区
+            const bool outOfBounds = rng() % 40 == 0;
+            const int32_t offset = outOfBounds ? -1 - static_cast<int32_t>(rng() % 32) : static_cast<int32_t>(rng() % 64) - 32;
+            p.push_back(encode(sf, op, rd, outOfBounds ? 11 : 8, static_cast<uint32_t>(offset)));
+        } else if (kind < 16) {
+            // 条件随通道的寄存器不同：通道在此分歧，在跳过的指令之后重汇合
+            const size_t at = p.size();
+            p.push_back(encode(sf, OP_CMP, rn, rm, 0));
+            p.push_back(branchCond(static_cast<BranchCondition>(rng() % 16), at + 1, at + 3));
+            p.push_back(encode(sf, OP_ADDI, rd, rd, 7));
+        } else if (kind < 18) {
+            // 间接分支（BR/BLR/RET）：程序内的指令（各通道不同）、未对齐地址或越界地址
+            static const uint8_t INDIRECT[] = {OP_BR, OP_BLR, OP_RET};
+            const uint8_t op = INDIRECT[rng() % 3];
+            switch (rng() % 4) {
+            case 0:
+                p.push_back(encode(true, OP_ANDI, 12, rn, 0x3C));
+                p.push_back(encode(true, OP_ADDI, 12, 12, loop * 4));
+                break;
+            case 1:  p.push_back(encode(true, OP_MOVI, 12, 0, (rng() % programEnd) * 4)); break;
+            case 2:  p.push_back(encode(true, OP_MOVI, 12, 0, (rng() % programEnd) * 4 + 2)); break;
+            default: p.push_back(encode(true, OP_MOVI, 12, 0, 0xFFFC)); break;
+            }
+            if (op == OP_RET) p.push_back(encode(true, OP_MOV, 30, 12, 0));
+            p.push_back(op == OP_RET ? encode(false, OP_RET, 0, 0, 0) : encode(true, op, 12, 0, 0));
+        } else if (kind < 19) {
+            const size_t at = p.size();
+            p.push_back(branch(OP_BL, at, at + 2));
+            p.push_back(encode(sf, OP_ADDI, rd, rd, 3));
+        } else if (kind < 20) {
+            p.push_back(HLT);
+        } else if (kind < 22) {
+            // 批量复制/填充：数据区内可能重叠的区间（长度随通道不同）或越界地址
+            const uint32_t to = (rng() % 8 == 0) ? 0xFFF0 : 0x4000 + rng() % 0x400;
+            p.push_back(encode(true, OP_MOVI, 13, 0, to));
+            p.push_back(encode(true, OP_ANDI, 15, rn, 0x1FF));
+            if (rng() & 1) {
+                p.push_back(encode(true, OP_MOVI, 14, 0, to + rng() % 0x100 - 0x80));
+                for (uint8_t subop : {SYS_CPYP, SYS_CPYM, SYS_CPYE}) p.push_back(systemInstr(false, subop, 13, 14, 15));
+            } else {
+                p.push_back(encode(true, OP_MOVI, 16, 0, rng()));
+                for (uint8_t subop : {SYS_SETP, SYS_SETM, SYS_SETE}) p.push_back(systemInstr(false, subop, 13, 15, 16));
+            }
+        } else {
+            // 多核同步指令（每个通道单核执行）：偶尔以越界地址访问
+            const uint8_t base = (rng() % 20 == 0) ? 11 : 8;
+            switch (rng() % 5) {
+            case 0:
+                p.push_back(systemInstr(sf, SYS_LDXR, rd, base, 0));
+                if (rng() & 1) p.push_back(encode(sf, (rng() & 1) ? OP_STRD : OP_STRW, rm, 8, 0));    // 改写（或写回原值）
+                p.push_back(systemInstr(sf, SYS_STXR, rn, rm, base));
+                break;
+            case 1:  p.push_back(systemInstr(sf, SYS_LDADD, rm, rd, base)); break;
+            case 2:  p.push_back(systemInstr(sf, SYS_CAS, rm, rd, base)); break;
+            case 3:  p.push_back(systemInstr(false, SYS_DMB, 0, 0, 0)); break;
+            default: p.push_back(systemInstr(true, SYS_MRS, rd, 0, (rng() & 1) ? SYSREG_MPIDR : 5)); break;
+            }
+        }
+    }
+
+    p.push_back(encode(true, OP_SUBI, 9, 9, 1));
+    p.push_back(encode(true, OP_CMPI, 9, 0, 0));
+    p.push_back(branchCond(BranchCondition::GT, p.size(), loop));
+    while (p.size() < programEnd) p.push_back(HLT);
+    return p;
+}
+
+} // namespace
+
+int main() {
+    auto cpu = std::make_unique<CPU>();
+    SimtEngine simt(LANES);
+    const uint64_t budgets[] = {MAX_STEPS, SMALL_BUDGET};
+
+    int failures = 0;
+    for (int seed = 1; seed <= RANDOM_PROGRAMS; ++seed) {
+        std::mt19937 rng(seed);
+        const std::vector<uint32_t> program = randomProgram(rng);
+        // 半数通道取小整数，使比较与分支条件在通道间既有相同也有不同
+        std::vector<Inputs> inputs(LANES);
+        for (Inputs& lane : inputs) {
+            for (uint64_t& value : lane) value = (rng() & 1) ? rng() % 4 : (uint64_t(rng()) << 32 | rng());
+        }
+
+        std::vector<LaneState> expected;
+        for (uint32_t lane = 0; lane < LANES; ++lane) expected.push_back(runCpu(*cpu, program, inputs[lane]));
+        for (uint64_t budget : budgets) {
+            const std::vector<LaneState> actual = runSimt(simt, program, inputs, budget);
+            for (uint32_t lane = 0; lane < LANES; ++lane) {
+                if (!(actual[lane] == expected[lane])) {
+                    if (failures < 10) report(seed, lane, budget, expected[lane], actual[lane]);
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    printf("SIMT (%s): %d programs x %u lanes, %d mismatches\n", simtImplementation(), RANDOM_PROGRAMS, LANES, failures);
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
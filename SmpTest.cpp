@@ -0,0 +1,177 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "SMP.h"
+
+// ========================== 多核测试 ==========================
+// 每个可以共享内存的配置与每种执行方式（解释 / 块 / JIT）各测一遍，CORES 个核执行同一个程序：
+//   计数：每个核 ITERATIONS 次 LDADD 累加同一个计数器，再用 LDXR/STXR 自旋锁（DMB 隔开）保护普通的读改写，
+//         两个计数器都须等于 CORES * ITERATIONS；MRS 读出的 MPIDR_EL1 等于核的编号
+//   改写代码：核0改写其他核正在循环执行的指令，它们在汇合之后执行新的指令并停止
+// 全部通过时返回0
+
+namespace {
+
+const uint32_t CORES = 4;
+const uint64_t ITERATIONS = 200;        // 与 COUNT_PROGRAM 中的 x12 一致
+const uint64_t MAX_STEPS = 1000000;
+const uint64_t ATOMIC_COUNTER = 0x4000;
+const uint64_t LOCKED_COUNTER = 0x4108;     // 由 0x4100 处的锁保护
+const uint64_t CORE_IDS = 0x4200;           // 核 i 在第 i 个字写入 i + 1
+
+const char* const COUNT_PROGRAM = R"(
+        mrs     x0, MPIDR_EL1
+        mov     x8, #0x4000
+        mov     x9, #0x4100
+        mov     x10, #0x4108
+        mov     x2, #1
+        mov     x6, #1
+        mov     x7, #0
+        mov     x12, #200
+    .Loop:
+        ldadd   x2, x3, [x8]
+    .Acquire:
+        ldxr    x1, [x9]
+        cmp     x1, #0
+        b.ne    .Acquire
+        stxr    w5, x6, [x9]
+        cmp     w5, #0
+        b.ne    .Acquire
+        dmb     ish
+        ldr     x1, [x10]
+        add     x1, x1, #1
+        str     x1, [x10]
+        dmb     ish
+        str     x7, [x9]
+        sub     x12, x12, #1
+        cmp     x12, #0
+        b.gt    .Loop
+        mov     x11, #0x4200
+        mov     x13, #8
+        mul     x13, x0, x13
+        add     x11, x11, x13
+        add     x14, x0, #1
+        str     x14, [x11]
+        HLT
+    )";
+
+// 核0把 0x4300 处的指令（mov x3, #2）写到 .Slot（地址 0x20），其他核循环执行 .Slot 直到读到新的值
+const char* const REWRITE_PROGRAM = R"(
+        mrs     x0, MPIDR_EL1
+        mov     x8, #0x20
+        mov     x9, #0x4300
+        cmp     x0, #0
+        b.ne    .Slot
+        ldr     w1, [x9]
+        str     w1, [x8]
+        HLT
+    .Slot:
+        mov     x3, #1
+        cmp     x3, #2
+        b.ne    .Slot
+        HLT
+    )";
+const uint64_t NEW_INSTRUCTION = 0x4300;
+
+std::vector<uint32_t> assembleQuietly(const std::string& text) {
+    Assembler assembler;
+    assembler.setVerbose(false);
+    return assembler.assemble(text);
+}
+
+template<typename Core>
+uint64_t read64(const Core& cpu, uint64_t address) {
+    std::vector<uint8_t> bytes = cpu.readMemoryRange(address, sizeof(uint64_t));
+    uint64_t value;
+    std::memcpy(&value, bytes.data(), sizeof(value));
+    return value;
+}
+
+struct Checker {
+    const char* config;
+    const char* engine;
+    int failures = 0;
+
+    void expect(bool ok, const std::string& what) {
+        if (ok) return;
+        if (failures < 10) printf("  %s %s: %s\n", config, engine, what.c_str());
+        ++failures;
+    }
+};
+
+// 反复执行直到所有核停止
+template<typename Machine>
+StopReason runToEnd(Machine& smp, ExecutionEngine engine) {
+    StopReason reason = StopReason::STEP_LIMIT;
+    for (int i = 0; i < 10 && reason == StopReason::STEP_LIMIT; ++i) reason = smp.run(MAX_STEPS, engine);
+    return reason;
+}
+
+template<typename Config, typename Hooks>
+int testConfig(const char* name) {
+    using Machine = BasicSMP<Config, Hooks>;
+    struct Engine {
+        const char* name;
+        ExecutionEngine engine;
+    };
+    const Engine engines[] = {
+        {"interpreter", ExecutionEngine::INTERPRETER}, {"blocks", ExecutionEngine::BLOCKS}, {"jit", ExecutionEngine::JIT}};
+    const std::vector<uint32_t> countProgram = assembleQuietly(COUNT_PROGRAM);
+    const std::vector<uint32_t> rewriteProgram = assembleQuietly(REWRITE_PROGRAM);
+    const std::vector<uint32_t> newInstruction = assembleQuietly("mov x3, #2\n");
+
+    Machine smp(CORES);
+    int failures = 0;
+    for (const Engine& engine : engines) {
+        Checker check{name, engine.name};
+
+        // 计数，时间片较短使核之间频繁交替
+        smp.reset();
+        smp.setQuantum(100);
+        smp.loadProgram(countProgram);
+        check.expect(runToEnd(smp, engine.engine) == StopReason::HALT, "counting cores halt");
+        const auto& memory = smp.getCore(0);
+        check.expect(read64(memory, ATOMIC_COUNTER) == CORES * ITERATIONS,
+                     "LDADD counter is " + std::to_string(read64(memory, ATOMIC_COUNTER)));
+        check.expect(read64(memory, LOCKED_COUNTER) == CORES * ITERATIONS,
+                     "lock-protected counter is " + std::to_string(read64(memory, LOCKED_COUNTER)));
+        check.expect(read64(memory, LOCKED_COUNTER - 8) == 0, "lock is released");
+        for (uint32_t i = 0; i < CORES; ++i) {
+            check.expect(smp.getCore(i).getReg(0) == i && read64(memory, CORE_IDS + i * 8) == i + 1,
+                         "core " + std::to_string(i) + " reads its MPIDR_EL1");
+            check.expect(smp.getStopReason(i) == StopReason::HALT, "core " + std::to_string(i) + " halts");
+        }
+
+        // 跨核改写代码
+        smp.reset();
+        smp.setQuantum(50);
+        smp.loadProgram(rewriteProgram);
+        smp.getCore(0).writeMemoryRange(NEW_INSTRUCTION, std::vector<uint8_t>(
+            reinterpret_cast<const uint8_t*>(newInstruction.data()),
+            reinterpret_cast<const uint8_t*>(newInstruction.data()) + sizeof(uint32_t)));
+        check.expect(runToEnd(smp, engine.engine) == StopReason::HALT, "rewritten code reaches the other cores");
+        for (uint32_t i = 1; i < CORES; ++i) {
+            check.expect(smp.getCore(i).getReg(3) == 2, "core " + std::to_string(i) + " executes the new instruction");
+        }
+
+        failures += check.failures;
+    }
+    printf("%-24s %d failures\n", name, failures);
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    // 只有连续内存的配置可以组成多核（见 SMP.cpp 的实例化）
+    failures += testConfig<DefaultConfig, NoHooks>("DefaultConfig/NoHooks");
+    failures += testConfig<DefaultConfig, ProfileHooks>("DefaultConfig/ProfileHooks");
+    failures += testConfig<UncheckedConfig, NoHooks>("UncheckedConfig/NoHooks");
+    failures += testConfig<VirtualConfig, NoHooks>("VirtualConfig/NoHooks");
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+#include <fstream>
+#include <cstring>
+
+#include "CPU.h"
+#include "Snapshot.h"
+#include "MemoryScan.h"
+
+#ifdef TINY_HAS_MMAP
+#include <fcntl.h>
+#endif
+
+static const std::array<uint8_t, GUEST_PAGE_SIZE> ZERO_PAGE_BYTES{};
+
+// ====================== 保存 ======================
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::saveSnapshot(const std::string& path) const {
+    // 只有写过的页可能非0；WRAP 方式末尾的填充字节不属于内存
+    const uint64_t memPages = layout.memSize >> GUEST_PAGE_SHIFT;
+    std::vector<uint64_t> pages;
+    memory.forEachWrittenPage([&](uint64_t pageIndex) {
+        if (pageIndex < memPages && std::memcmp(memory.readPage(pageIndex), ZERO_PAGE_BYTES.data(), GUEST_PAGE_SIZE) != 0) {
+            pages.push_back(pageIndex);
+        }
+    });
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.memSize = layout.memSize;
+    header.codeSize = layout.codeSize;
+    header.stackBase = layout.stackBase;
+    header.stackLimit = layout.stackLimit;
+    header.stackGuard = layout.stackGuard;
+    header.hugePages = static_cast<uint32_t>(layout.hugePages);
+    header.nzcv = nzcv();
+    std::copy(regs.begin(), regs.end(), header.regs);
+    header.pc = PC;
+    header.ir = IR;
+    header.steps = steps;
+    header.translationTable = translationTable;
+    header.pageCount = pages.size();
+    header.indexOffset = GUEST_PAGE_SIZE;
+    header.dataOffset = (header.indexOffset + pages.size() * sizeof(uint64_t) + GUEST_PAGE_SIZE - 1) & ~(GUEST_PAGE_SIZE - 1);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create snapshot: " + path);
+    }
+    std::vector<char> padding(GUEST_PAGE_SIZE);
+    std::memcpy(padding.data(), &header, sizeof(header));
+    out.write(padding.data(), GUEST_PAGE_SIZE);
+    out.write(reinterpret_cast<const char*>(pages.data()), pages.size() * sizeof(uint64_t));
+    std::fill(padding.begin(), padding.end(), 0);
+    out.write(padding.data(), header.dataOffset - header.indexOffset - pages.size() * sizeof(uint64_t));
+    for (uint64_t pageIndex : pages) {
+        out.write(reinterpret_cast<const char*>(memory.readPage(pageIndex)), GUEST_PAGE_SIZE);
+    }
+    if (!out.flush()) {
+        throw std::runtime_error("Failed to write snapshot: " + path);
+    }
+}
+
+// ====================== 读取 ======================
+// 读取并校验文件头与页号表；无效时抛出异常
+static void readSnapshotIndex(std::ifstream& in, const std::string& path, SnapshotHeader& header, std::vector<uint64_t>& pages) {
+    if (!in) {
+        throw std::runtime_error("Failed to open snapshot: " + path);
+    }
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a snapshot file: " + path);
+    }
+    if (header.version != SNAPSHOT_VERSION || header.headerSize != sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Unsupported snapshot version: " + std::to_string(header.version));
+    }
+
+    in.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    const uint64_t memPages = header.memSize >> GUEST_PAGE_SHIFT;
+    if (header.hugePages > static_cast<uint32_t>(HugePages::EXPLICIT) || header.pageCount > memPages ||
+        header.dataOffset % GUEST_PAGE_SIZE != 0 || header.indexOffset + header.pageCount * sizeof(uint64_t) > header.dataOffset ||
+        header.dataOffset + header.pageCount * GUEST_PAGE_SIZE > fileSize) {
+        throw std::runtime_error("Corrupt snapshot: " + path);
+    }
+    pages.resize(header.pageCount);
+    in.seekg(header.indexOffset);
+    in.read(reinterpret_cast<char*>(pages.data()), pages.size() * sizeof(uint64_t));
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (!in || pages[i] >= memPages || (i > 0 && pages[i] <= pages[i - 1])) {
+            throw std::runtime_error("Corrupt snapshot: " + path);
+        }
+    }
+}
+
+// ====================== 恢复 ======================
+template<typename Config, typename Hooks>
+void BasicCPU<Config, Hooks>::loadSnapshot(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    SnapshotHeader header{};
+    std::vector<uint64_t> pages;
+    readSnapshotIndex(in, path, header, pages);
+
+    // 校验布局并重新分配内存（全0），丢弃预译码缓存、基本块与JIT代码
+    setMemoryLayout({header.memSize, header.codeSize, header.stackBase, header.stackLimit, header.stackGuard,
+                     static_cast<HugePages>(header.hugePages)});
+    if constexpr (Memory::FAULTS_BY_SIGNAL) {
+        for (uint64_t pageIndex : pages) {
+            if (!memory.accessible(pageIndex << GUEST_PAGE_SHIFT, GUEST_PAGE_SIZE)) {
+                throw std::runtime_error("Corrupt snapshot: page inside a guard region");
+            }
+        }
+    }
+
+    // 连续内存：相邻的存储页合并为一次私有映射，不读取页内容
+    size_t loaded = 0;
+#ifdef TINY_HAS_MMAP
+    if constexpr (Memory::CONTIGUOUS) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            while (loaded < pages.size()) {
+                size_t run = 1;
+                while (loaded + run < pages.size() && pages[loaded + run] == pages[loaded] + run) ++run;
+                if (!memory.mapPages(fd, header.dataOffset + loaded * GUEST_PAGE_SIZE, pages[loaded], run)) break;
+                loaded += run;
+            }
+            close(fd);  // 映射在关闭后仍然有效
+        }
+    }
+#endif
+    // 其余情况逐页复制
+    std::vector<char> buffer(GUEST_PAGE_SIZE);
+    in.clear();
+    in.seekg(header.dataOffset + loaded * GUEST_PAGE_SIZE);
+    for (; loaded < pages.size(); ++loaded) {
+        if (!in.read(buffer.data(), GUEST_PAGE_SIZE)) {
+            throw std::runtime_error("Corrupt snapshot: " + path);
+        }
+        memory.copyIn(pages[loaded] << GUEST_PAGE_SHIFT, reinterpret_cast<const uint8_t*>(buffer.data()), GUEST_PAGE_SIZE);
+    }
+
+    std::copy(header.regs, header.regs + NUM_REGS, regs.begin());
+    PC = header.pc;
+    IR = header.ir;
+    steps = header.steps;
+    if (header.translationTable != NO_TRANSLATION) {
+        setTranslationTable(header.translationTable);
+    }
+    statusReg = StatusRegister{(header.nzcv & 8) != 0, (header.nzcv & 4) != 0, (header.nzcv & 2) != 0, (header.nzcv & 1) != 0};
+    flagOp = FlagOp::NONE;
+}
+
+// ====================== 比较 ======================
+// 两个页号表按顺序归并，各自的页内容也按顺序读出；只在一方存储的页与全0页比较
+std::vector<MemoryRange> diffSnapshots(const std::string& pathA, const std::string& pathB) {
+    std::ifstream inA(pathA, std::ios::binary), inB(pathB, std::ios::binary);
+    SnapshotHeader headerA{}, headerB{};
+    std::vector<uint64_t> pagesA, pagesB;
+    readSnapshotIndex(inA, pathA, headerA, pagesA);
+    readSnapshotIndex(inB, pathB, headerB, pagesB);
+    inA.seekg(headerA.dataOffset);
+    inB.seekg(headerB.dataOffset);
+
+    std::vector<uint8_t> pageA(GUEST_PAGE_SIZE), pageB(GUEST_PAGE_SIZE);
+    auto readPage = [](std::ifstream& in, const std::string& path, std::vector<uint8_t>& page) {
+        if (!in.read(reinterpret_cast<char*>(page.data()), GUEST_PAGE_SIZE)) {
+            throw std::runtime_error("Corrupt snapshot: " + path);
+        }
+        return MemorySpan(page.data(), GUEST_PAGE_SIZE);
+    };
+    const MemorySpan zeroPage(ZERO_PAGE_BYTES.data(), GUEST_PAGE_SIZE);
+
+    std::vector<MemoryRange> ranges;
+    size_t i = 0, j = 0;
+    while (i < pagesA.size() || j < pagesB.size()) {
+        uint64_t a = i < pagesA.size() ? pagesA[i] : UINT64_MAX;
+        uint64_t b = j < pagesB.size() ? pagesB[j] : UINT64_MAX;
+        uint64_t pageIndex = std::min(a, b);
+        MemorySpan spanA = a == pageIndex ? readPage(inA, pathA, pageA) : zeroPage;
+        MemorySpan spanB = b == pageIndex ? readPage(inB, pathB, pageB) : zeroPage;
+        i += a == pageIndex;
+        j += b == pageIndex;
+        diffMemory(spanA, spanB, pageIndex << GUEST_PAGE_SHIFT, ranges);
+    }
+    return ranges;
+}
+
+#define INSTANTIATE_SNAPSHOT(CONFIG, HOOKS) \
+    template void BasicCPU<CONFIG, HOOKS>::saveSnapshot(const std::string& path) const; \
+    template void BasicCPU<CONFIG, HOOKS>::loadSnapshot(const std::string& path);
+TINY_CPU_CONFIGS(INSTANTIATE_SNAPSHOT)
+#undef INSTANTIATE_SNAPSHOT
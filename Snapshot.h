@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "GuestMemory.h"
+#include "SoftMMU.h"
+#include "MemoryScan.h"
+
+// ========================== 机器快照 ==========================
+// BasicCPU::saveSnapshot() / loadSnapshot() 的文件格式，按宿主机字节序（小端）存储：
+//   [0, GUEST_PAGE_SIZE)        SnapshotHeader，其后补0
+//   [indexOffset, ...)          pageCount 个 uint64_t：存储的页号，严格递增
+//   [dataOffset, ...)           按页号顺序存放的页内容，每页 GUEST_PAGE_SIZE 字节；dataOffset 按页对齐
+// 只存储写过且不全为0的页，其余页恢复为0。页内容在文件中页对齐，恢复时可以直接私有映射
+
+static constexpr char SNAPSHOT_MAGIC[8] = {'T', 'I', 'N', 'Y', 'S', 'N', 'A', 'P'};
+static constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+struct SnapshotHeader {
+    char magic[8];              // SNAPSHOT_MAGIC
+    uint32_t version;           // SNAPSHOT_VERSION
+    uint32_t headerSize;        // sizeof(SnapshotHeader)
+
+    // 内存布局（MemoryLayout）
+    uint64_t memSize;
+    uint64_t codeSize;
+    uint64_t stackBase;
+    uint64_t stackLimit;
+    uint64_t stackGuard;
+    uint32_t hugePages;
+
+    // 处理器状态
+    uint32_t nzcv;              // N<<3 | Z<<2 | C<<1 | V
+    uint64_t regs[32];
+    uint64_t pc;
+    uint32_t ir;
+    uint32_t steps;
+    uint64_t translationTable;  // 第0级页表的物理地址，NO_TRANSLATION 表示未使用页表（见 SoftMMU.h）
+
+    // 内存内容
+    uint64_t pageCount;         // 存储的页数
+    uint64_t indexOffset;       // 页号表在文件中的偏移
+    uint64_t dataOffset;        // 第 i 个存储页位于 dataOffset + i * GUEST_PAGE_SIZE
+};
+
+static_assert(sizeof(SnapshotHeader) <= GUEST_PAGE_SIZE, "snapshot header must fit in its page");
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "snapshots are stored in little-endian host order");
+
+// 比较两个快照文件的内存内容，返回内容不同的字节区间（地址升序）；只读取存储的页，不恢复机器。文件无效时抛出异常
+std::vector<MemoryRange> diffSnapshots(const std::string& pathA, const std::string& pathB);
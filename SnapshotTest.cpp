@@ -0,0 +1,148 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+#include "Snapshot.h"
+
+// ========================== 快照测试 ==========================
+// 每个配置（TINY_CPU_CONFIGS）：
+//   往返：程序执行到中途保存快照，新的CPU恢复后继续执行，最终状态（寄存器、PC、IR、NZCV、内存）与原CPU相同
+//   比较：diffSnapshots() 报告两个快照之间改写的字节，包括只在一方存储的页（另一方为全0）
+//   无效文件：恢复与比较都抛出异常
+// 全部通过时返回0
+
+namespace {
+
+const uint64_t MAX_STEPS = 100000;
+const uint64_t WINDOW = 0x8000;     // 程序与数据都在这里
+
+// 第一段填充 0x4000 起的64个字、0x6000 与栈顶后停在HLT（保存快照A）；
+// 第二段把 0x6000 清零（该页不再存储）、改写 0x4010 并写入新的页 0x7000 后停止（保存快照B）
+const char* const PROGRAM = R"(
+        mov     x8, #0x4000
+        mov     x9, #0x6000
+        mov     x2, #0
+    .Fill:
+        str     x2, [x8]
+        add     x8, x8, #8
+        add     x2, x2, #3
+        cmp     x2, #192
+        b.lt    .Fill
+        str     x2, [x9]
+        sub     sp, sp, #16
+        str     x2, [sp]
+        HLT
+        mov     x3, #0
+        str     x3, [x9]
+        mov     x10, #0x7000
+        str     x2, [x10]
+        mov     x8, #0x4010
+        str     x3, [x8]
+        cmp     x2, #200
+        HLT
+    )";
+
+// 两个快照之间改写的字节
+const MemoryRange EXPECTED_DIFF[] = {{0x4010, 1}, {0x6000, 1}, {0x7000, 1}};
+
+std::vector<uint32_t> assembleQuietly(const std::string& text) {
+    Assembler assembler;
+    assembler.setVerbose(false);
+    return assembler.assemble(text);
+}
+
+struct Checker {
+    const char* config;
+    int failures = 0;
+
+    void expect(bool ok, const std::string& what) {
+        if (ok) return;
+        if (failures < 10) printf("  %s: %s\n", config, what.c_str());
+        ++failures;
+    }
+};
+
+template<typename Core>
+bool sameState(const Core& a, const Core& b) {
+    for (uint8_t r = 0; r < Core::NUM_REGS; ++r) {
+        if (a.getReg(r) != b.getReg(r)) return false;
+    }
+    return a.getPC() == b.getPC() && a.getIR() == b.getIR() &&
+           a.getStatusReg().toString() == b.getStatusReg().toString() &&
+           a.readMemoryRange(0, WINDOW) == b.readMemoryRange(0, WINDOW) &&
+           a.readMemoryRange(a.getSP(), 16) == b.readMemoryRange(b.getSP(), 16);
+}
+
+template<typename Config, typename Hooks>
+int testConfig(const char* name) {
+    using Core = BasicCPU<Config, Hooks>;
+    Checker check{name};
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string pathA = (dir / "tiny_snapshot_test_a.bin").string();
+    const std::string pathB = (dir / "tiny_snapshot_test_b.bin").string();
+    const std::string pathBad = (dir / "tiny_snapshot_test_bad.bin").string();
+
+    try {
+        auto original = std::make_unique<Core>();
+        original->loadProgram(assembleQuietly(PROGRAM));
+        check.expect(original->run(MAX_STEPS) == StopReason::HALT, "first half halts");
+        original->saveSnapshot(pathA);
+
+        // 往返：恢复到另一台CPU（先改乱它的状态），两边继续执行到结束
+        auto restored = std::make_unique<Core>();
+        restored->loadProgram(assembleQuietly("mov x0, #1\nHLT\n"));
+        restored->run(MAX_STEPS);
+        restored->setReg(5, 0x1234);
+        restored->loadSnapshot(pathA);
+        check.expect(sameState(*original, *restored), "restored state matches the saved one");
+
+        check.expect(original->run(MAX_STEPS) == StopReason::HALT, "original finishes");
+        check.expect(restored->runJit(MAX_STEPS) == StopReason::HALT, "restored finishes");
+        check.expect(sameState(*original, *restored), "restored machine continues like the original");
+        original->saveSnapshot(pathB);
+
+        // 比较
+        std::vector<MemoryRange> diff = diffSnapshots(pathA, pathB);
+        bool expected = diff.size() == sizeof(EXPECTED_DIFF) / sizeof(EXPECTED_DIFF[0]);
+        for (size_t i = 0; expected && i < diff.size(); ++i) {
+            expected = diff[i].offset == EXPECTED_DIFF[i].offset && diff[i].size == EXPECTED_DIFF[i].size;
+        }
+        check.expect(expected, "diffSnapshots reports the rewritten bytes");
+        check.expect(diffSnapshots(pathB, pathA).size() == diff.size(), "diffSnapshots is symmetric");
+        check.expect(diffSnapshots(pathA, pathA).empty(), "a snapshot does not differ from itself");
+
+        // 无效文件
+        std::ofstream(pathBad, std::ios::binary) << "not a snapshot";
+        bool threw = false;
+        try { restored->loadSnapshot(pathBad); } catch (const std::runtime_error&) { threw = true; }
+        check.expect(threw, "loading an invalid file throws");
+        threw = false;
+        try { diffSnapshots(pathA, pathBad); } catch (const std::runtime_error&) { threw = true; }
+        check.expect(threw, "comparing with an invalid file throws");
+    } catch (const std::exception& e) {
+        check.expect(false, std::string("unexpected exception: ") + e.what());
+    }
+
+    std::filesystem::remove(pathA);
+    std::filesystem::remove(pathB);
+    std::filesystem::remove(pathBad);
+    printf("%-24s %d failures\n", name, check.failures);
+    return check.failures;
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+#define TEST_CONFIG(CONFIG, HOOKS) failures += testConfig<CONFIG, HOOKS>(#CONFIG "/" #HOOKS);
+    TINY_CPU_CONFIGS(TEST_CONFIG)
+#undef TEST_CONFIG
+
+    printf(failures == 0 ? "PASS\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
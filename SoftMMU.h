@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+#include "GuestMemory.h"
+#include "Enums.h"
+
+// ========================== 软件MMU ==========================
+// Config::MMU 为 true 时，取指与数据访问的地址都是虚拟地址，经客户机页表转换为物理地址（客户机内存的下标）。
+// 页表格式与 AArch64 的4KB粒度相同地划分48位虚拟地址：
+//   [47:39] [38:30] [29:21] [20:12] 依次索引第0~3级表，每级512个8字节描述符（小端），[11:0] 为页内偏移
+//   描述符 bit0 为有效位，[47:12] 为下一级表（第3级为物理页）的物理地址；
+//   第3级描述符的 bit1/2/3 分别允许读/写/执行，中间级的权限位被忽略
+// 页表位于客户机物理内存中，可由客户机程序或宿主机写入。修改已生效的页表后需要 BasicCPU::flushTlb()
+
+static constexpr uint64_t PTE_VALID        = 1ULL << 0;
+static constexpr uint64_t PTE_READ         = 1ULL << 1;
+static constexpr uint64_t PTE_WRITE        = 1ULL << 2;
+static constexpr uint64_t PTE_EXEC         = 1ULL << 3;
+static constexpr uint64_t PTE_ADDRESS_MASK = 0x0000FFFFFFFFF000ULL;
+
+static constexpr int MMU_LEVELS          = 4;
+static constexpr uint64_t MMU_LEVEL_BITS = 9;
+static constexpr uint64_t MMU_VA_BITS    = GUEST_PAGE_SHIFT + MMU_LEVELS * MMU_LEVEL_BITS;   // 48
+static constexpr uint64_t NO_TRANSLATION = ~0ULL;     // 未设置页表：虚拟地址即物理地址
+
+// 在 memory 的 [0, memSize) 中从 root 开始遍历页表，得到 va 所在页的末级描述符；
+// 地址超出48位、某级描述符无效或表不在内存之内时返回false
+template<typename Memory>
+bool walkPageTable(const Memory& memory, uint64_t memSize, uint64_t root, uint64_t va, uint64_t& descriptor) {
+    if (va >> MMU_VA_BITS) return false;
+    uint64_t table = root;
+    for (int level = 0; level < MMU_LEVELS; ++level) {
+        uint64_t shift = GUEST_PAGE_SHIFT + (MMU_LEVELS - 1 - level) * MMU_LEVEL_BITS;
+        uint64_t entry = table + ((va >> shift) & ((1ULL << MMU_LEVEL_BITS) - 1)) * 8;
+        if (entry > memSize - 8) return false;
+        descriptor = memory.template read<uint64_t>(entry);
+        if (!(descriptor & PTE_VALID)) return false;
+        table = descriptor & PTE_ADDRESS_MASK;
+    }
+    return true;
+}
+
+// ====================== 软件TLB ======================
+// 直接映射，按虚拟页号的低位索引。每项为读/写/执行分别保存标签：允许该访问时为虚拟页地址，否则为 INVALID_TAG。
+// 访问地址按 (页地址 | (大小-1)) 截取后与标签比较，命中（且按大小对齐）只需一次比较；
+// 未对齐、跨页或未命中的访问由 BasicCPU::translateSlow() 处理
+struct SoftTLB {
+    static constexpr uint32_t ENTRIES = 256;
+    static constexpr uint64_t INVALID_TAG = ~0ULL;    // 低12位全1，不会与截取后的地址相等
+
+    struct Entry {
+        uint64_t tags[3] = {INVALID_TAG, INVALID_TAG, INVALID_TAG};   // 按 MemoryAccess 索引
+        uint64_t offset = 0;                                          // 物理页地址 - 虚拟页地址
+    };
+
+    std::array<Entry, ENTRIES> entries{};
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    Entry& entryFor(uint64_t address) { return entries[(address >> GUEST_PAGE_SHIFT) % ENTRIES]; }
+    void flush() { entries.fill(Entry{}); }
+};
+
+static_assert(static_cast<int>(MemoryAccess::FETCH) == 0 && static_cast<int>(MemoryAccess::READ) == 1 &&
+              static_cast<int>(MemoryAccess::WRITE) == 2, "TLB tags are indexed by MemoryAccess");
@@ -101,19 +101,16 @@ int main() {
         cpu.printState();
         
         // 执行程序
-        try {
-            for (int i = 0; i < 99999; i++) { // 最多执行50条指令
-                std::cout << ">>> Step " << (i + 1) << " <<<" << std::endl;
-                cpu.step();
-                // cpu.printState();
-            }
-        } 
-        catch (const std::exception& e) {
-            if (std::string(e.what()).compare("HLT instruction executed") == 0) {
-                cpu.printState();
-            }
-            std::cout << "Execution stopped: " << e.what() << std::endl;
+        StopReason reason = cpu.run(99999); // 最多执行99999条指令
+        std::cout << "Executed " << cpu.getRunSteps() << " steps" << std::endl;
+        if (reason == StopReason::HALT) {
+            cpu.printState();
         }
+        std::cout << "Execution stopped: " << cpu.describeStop(reason) << std::endl;
+#ifdef TINY_PROFILE
+        cpu.getHooks().print(std::cout);
+        cpu.getHooks().printNGrams(std::cout);
+#endif
         
         std::cout << "===== Simulation Finished =====" << std::endl;
     } 
@@ -3,6 +3,7 @@
 #include "View.h"
 #include "Log.h"
 #include "CPU.h"
+#include "ExecutionThread.h"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -26,13 +27,19 @@ public:
         static std::vector<std::string> lines;
         static std::vector<int> displayLineIndex;
         static std::unordered_map<uint64_t, int> pcToLineMap;
+        static uint64_t seenStops = 0;              // 已记录日志的命令数
+        static bool logRun = false;                 // 正在执行的命令来自 Execute
+        static auto runStart = std::chrono::high_resolution_clock::now();
 
         ImGui::Begin("AssembleView");
 
-        CPU& cpu = CPU::GetInstance();
+        // CPU在执行线程上运行：先暂停再直接改动CPU，显示只使用快照
+        ExecutionThread& exec = ExecutionThread::GetInstance();
+        CPU& cpu = exec.getCPU();
         Assembler Asm;
 
         if (ImGui::Button("Start")) {
+            exec.pause();
             cpu.reset();
             auto binary = Asm.assemble(asmCode);
             cpu.loadProgram(binary);
@@ -66,41 +73,60 @@ public:
             }
 
             codeReadOnly = true;
+            exec.refresh();
         }
 
         ImGui::SameLine();
         if (ImGui::Button("Reset")) {
+            exec.pause();
             cpu.reset();
+            exec.refresh();
             codeReadOnly = false;
         }
 
         ImGui::SameLine();
         if (ImGui::Button("Execute")) {
-            auto start = std::chrono::high_resolution_clock::now();
+            runStart = std::chrono::high_resolution_clock::now();
+            logRun = true;
+            exec.run();
+        }
 
-            try {
-                for (int i = 0; i < 999999; i++) {
-                    LOGI(LOG_INSTANCE("CPU"), ">>> Step %d <<<", ++cpu.steps);
-                    cpu.step();
-                }
-            } catch (const std::exception& e) {
-                LOGI(LOG_INSTANCE("CPU"), "Execution stopped: %s", e.what());
-            }
-            LOGI(LOG_INSTANCE("CPU"), "===== Simulation Finished =====");
-            auto end = std::chrono::high_resolution_clock::now();
+        ExecutionSnapshot snapshot = exec.snapshot();
 
-            // 计算耗时
-            auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-            LOGI(LOG_INSTANCE("CPU"), "Takes Time: %llu ms", duration_ms);
+        ImGui::SameLine();
+        ImGui::BeginDisabled(!snapshot.running);
+        if (ImGui::Button("Pause")) {
+            exec.pause();
         }
+        ImGui::EndDisabled();
 
         ImGui::SameLine();
         if (ImGui::Button("Next") || ImGui::IsKeyPressed(ImGuiKey::ImGuiKey_F8)) {
-            try {
-                LOGI(LOG_INSTANCE("CPU"), ">>> Step %d <<<", ++cpu.steps);
-                cpu.step();
-            } catch (const std::exception& e) {
-                LOGI(LOG_INSTANCE("CPU"), "Execution stopped: %s", e.what());
+            LOGI(LOG_INSTANCE("CPU"), ">>> Step %d <<<", snapshot.steps + 1);
+            logRun = false;
+            exec.step(1);
+        }
+
+        if (snapshot.running) {
+            ImGui::SameLine();
+            ImGui::Text("Running... %llu steps", (unsigned long long)snapshot.commandSteps);
+        }
+
+        // 命令结束：此时执行线程已停下
+        snapshot = exec.snapshot();
+        if (snapshot.stopCount != seenStops && !snapshot.running) {
+            seenStops = snapshot.stopCount;
+            if (logRun) {
+                LOGI(LOG_INSTANCE("CPU"), "Executed %llu steps", (unsigned long long)snapshot.commandSteps);
+                LOGI(LOG_INSTANCE("CPU"), "Execution stopped: %s", snapshot.reason == StopReason::STEP_LIMIT ? "Paused" : cpu.describeStop(snapshot.reason).c_str());
+                LOGI(LOG_INSTANCE("CPU"), "===== Simulation Finished =====");
+                auto end = std::chrono::high_resolution_clock::now();
+
+                // 计算耗时
+                auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - runStart).count();
+                LOGI(LOG_INSTANCE("CPU"), "Takes Time: %llu ms", duration_ms);
+            } else if (snapshot.reason != StopReason::STEP_LIMIT) {
+                LOGI(LOG_INSTANCE("CPU"), "Execution stopped: %s", cpu.describeStop(snapshot.reason).c_str());
             }
         }
 
@@ -110,7 +136,7 @@ public:
         } else {
             ImGui::BeginChild("AsmReadOnly", ImVec2(-1, -1), true, ImGuiWindowFlags_HorizontalScrollbar);
 
-            int pc = cpu.getPC() / 4;
+            int pc = snapshot.pc / 4;
             int currentExecLine = pcToLineMap.count(pc) ? pcToLineMap[pc] - 1: -1;
 
             for (int i = 0; i < lines.size(); ++i) {
@@ -2,9 +2,13 @@
 
 #include "View.h"
 #include "CPU.h"
+#include "ExecutionThread.h"
+#include "MemoryScan.h"
 #include "imgui.h"
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 class MemoryView : public View {
@@ -12,13 +16,14 @@ public:
     MemoryView() {}
 
     void Show() {
-        CPU& cpu = CPU::GetInstance();
-        const auto memory = cpu.getMemory();
+        // 可见部分来自执行线程的快照；查找与变化比较要读整块内存，只在执行线程空闲时进行
+        ExecutionThread& exec = ExecutionThread::GetInstance();
+        CPU& cpu = exec.getCPU();
+        const ExecutionSnapshot snapshot = exec.snapshot();
+        const bool idle = !snapshot.running && exec.isIdle();
         constexpr size_t bytesPerRow = 32;
-        constexpr size_t memSizeToShow = std::min(cpu.MEM_SIZE, 512ULL);
-        static uint8_t prevMemory[memSizeToShow] = {0};
-        static int highlightTimer[memSizeToShow] = {0};
-        constexpr int kHighlightFrames = 60;
+        constexpr size_t memSizeToShow = ExecutionSnapshot::MEMORY_WINDOW;
+        constexpr size_t kMaxResults = 256;        // 查找结果最多列出的个数
 
         ImGui::SetNextWindowSize(ImVec2{getViewSize().w, getViewSize().h});
         ImGui::SetNextWindowPos(ImVec2{getViewPos().x, getViewPos().y});
@@ -34,12 +39,69 @@ public:
         if (ImGui::Button("JumpToAddress")) {
             std::string str(addrInput);
             if (str.compare("SP") == 0 || str.compare("sp") == 0) {
-                memBase = cpu.getSP();
+                memBase = snapshot.regs[31];
             } else {
                 memBase = std::stoull(addrInput, nullptr, 0);
             }
         }
 
+        const uint64_t memSize = cpu.getMemorySize();
+        if (idle) trackChanges(cpu, snapshot.generation);
+
+        // 在整块内存中查找值：宽度为 Bytes 时输入按空格分隔的十六进制字节
+        static char valueInput[64] = "0x0";
+        static int widthIndex = 2;
+        static bool aligned = true;
+        static const char* widthNames[] = {"8-bit", "16-bit", "32-bit", "64-bit", "Bytes"};
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(160.0f);
+        ImGui::InputText("##ValueInput", valueInput, IM_ARRAYSIZE(valueInput));
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(80.0f);
+        ImGui::Combo("##Width", &widthIndex, widthNames, IM_ARRAYSIZE(widthNames));
+        ImGui::SameLine();
+        ImGui::Checkbox("Aligned", &aligned);
+        ImGui::SameLine();
+        ImGui::BeginDisabled(!idle);
+        if (ImGui::Button("FindValue")) {
+            const MemorySpan whole = cpu.viewMemory(0, memSize);
+            std::vector<uint8_t> pattern = parseBytes(valueInput);
+            try {
+                if (widthIndex < 4) {
+                    findResults = findValue(whole, std::stoull(valueInput, nullptr, 0), size_t(1) << widthIndex, aligned, kMaxResults);
+                } else if (!pattern.empty()) {
+                    findResults = findBytes(whole, pattern.data(), pattern.size(), 1, kMaxResults);
+                }
+            } catch (const std::exception&) {
+                findResults.clear();
+            }
+            searched = true;
+        }
+        ImGui::EndDisabled();
+
+        // 查找结果与上一步改写的区间，点击跳转
+        if (searched) {
+            ImGui::Text("Found %zu%s (%s)", findResults.size(), findResults.size() == kMaxResults ? "+" : "", memoryScanImplementation());
+            for (size_t i = 0; i < findResults.size() && i < 16; ++i) {
+                ImGui::SameLine();
+                if (ImGui::SmallButton(("0x" + toHex(findResults[i]) + "##find").c_str())) {
+                    memBase = findResults[i] & ~(bytesPerRow - 1);
+                }
+            }
+        }
+        ImGui::Text("Changed since last step: %zu ranges", lastChanges.size());
+        for (size_t i = 0; i < lastChanges.size() && i < 16; ++i) {
+            ImGui::SameLine();
+            if (ImGui::SmallButton(("0x" + toHex(lastChanges[i].offset) + "+" + std::to_string(lastChanges[i].size) + "##diff").c_str())) {
+                memBase = lastChanges[i].offset & ~(bytesPerRow - 1);
+            }
+        }
+
+        // 新的观察窗口在执行线程下次发布（空闲时立即发布）之后出现在快照中
+        exec.watchMemory(memBase);
+        const uint64_t viewBase = snapshot.memoryBase;
+        const MemorySpan memory(snapshot.memory.data(), snapshot.memorySize);
+
         if (ImGui::BeginTable("MemoryTable", bytesPerRow + 1, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
             ImGui::TableSetupColumn("Address");
             for (int i = 0; i < bytesPerRow; ++i)
@@ -48,7 +110,7 @@ public:
             ImGui::TableHeadersRow();
 
             for (size_t row = 0; row < memSizeToShow / bytesPerRow; ++row) {
-                size_t baseAddr = row * bytesPerRow + memBase;
+                size_t baseAddr = row * bytesPerRow + viewBase;
                 ImGui::TableNextRow();
 
                 for (int col = 0; col <= bytesPerRow; ++col) {
@@ -56,27 +118,22 @@ public:
                     if (col == 0) {
                         ImGui::Text("0x%04X", (unsigned int)baseAddr);
                     } else {
-                        size_t index = baseAddr + (col - 1);
-                        if (index >= memSizeToShow || index >= memory.size()) continue;
+                        size_t index = row * bytesPerRow + (col - 1);
+                        if (index >= memory.size()) continue;
 
                         uint8_t value = memory[index];
 
-                        // // 高亮内存变化
-                        // if (value != prevMemory[index]) {
-                        //     highlightTimer[index] = kHighlightFrames;
-                        //     prevMemory[index] = value;
-                        // }
-
-                        // if (highlightTimer[index] > 0) {
-                        //     ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.5f, 0.5f, 1.0f));
-                        //     highlightTimer[index]--;
-                        // }
+                        // 高亮上一步改写的字节
+                        bool changed = isChanged(viewBase + index);
+                        if (changed) {
+                            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.5f, 0.5f, 1.0f));
+                        }
 
                         ImGui::Text("%02X", value);
 
-                        // if (highlightTimer[index] > 0) {
-                        //     ImGui::PopStyleColor();
-                        // }
+                        if (changed) {
+                            ImGui::PopStyleColor();
+                        }
                     }
                 }
             }
@@ -87,4 +144,66 @@ public:
         ImGui::EndChild();
         ImGui::End();
     }
+
+private:
+    std::vector<uint64_t> findResults;
+    bool searched = false;
+
+    // 上一步改写的区间：只比较代数比上一帧新的页，与保存的旧内容逐页比较；未写过的页视为全0
+    uint64_t seenGeneration = 0;
+    std::unordered_map<uint64_t, std::vector<uint8_t>> previousPages;
+    std::vector<MemoryRange> lastChanges;
+
+    // current 为执行线程最近发布的代数，调用时执行线程已停下
+    void trackChanges(CPU& cpu, uint64_t current) {
+        const uint64_t memSize = cpu.getMemorySize();
+        const bool relayout = seenGeneration < cpu.getLayoutGeneration();
+        if (relayout) {
+            previousPages.clear();
+            lastChanges.clear();
+        }
+
+        static const std::vector<uint8_t> zeroPage(GUEST_PAGE_SIZE);
+        std::vector<MemoryRange> changes;
+        for (uint64_t pageIndex : cpu.getPagesChangedSince(relayout ? 0 : seenGeneration)) {
+            const uint64_t address = pageIndex << GUEST_PAGE_SHIFT;
+            const MemorySpan page = cpu.viewMemory(address, std::min<uint64_t>(GUEST_PAGE_SIZE, memSize - address));
+            std::vector<uint8_t>& previous = previousPages[pageIndex];
+            if (!relayout) {
+                const std::vector<uint8_t>& old = previous.empty() ? zeroPage : previous;
+                diffMemory(MemorySpan(old.data(), page.size()), page, address, changes);
+            }
+            previous.assign(page.begin(), page.end());
+        }
+        if (!changes.empty()) {
+            lastChanges = std::move(changes);
+        }
+        seenGeneration = current;
+    }
+
+    bool isChanged(uint64_t address) const {
+        auto it = std::upper_bound(lastChanges.begin(), lastChanges.end(), address,
+                                   [](uint64_t a, const MemoryRange& r) { return a < r.offset; });
+        return it != lastChanges.begin() && address < std::prev(it)->offset + std::prev(it)->size;
+    }
+
+    static std::vector<uint8_t> parseBytes(const char* text) {
+        std::vector<uint8_t> bytes;
+        std::istringstream iss(text);
+        std::string token;
+        while (iss >> token) {
+            try {
+                bytes.push_back(static_cast<uint8_t>(std::stoul(token, nullptr, 16)));
+            } catch (const std::exception&) {
+                return {};
+            }
+        }
+        return bytes;
+    }
+
+    static std::string toHex(uint64_t value) {
+        std::ostringstream oss;
+        oss << std::hex << std::uppercase << value;
+        return oss.str();
+    }
 };
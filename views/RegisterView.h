@@ -3,6 +3,7 @@
 #include "View.h"
 #include "Log.h"
 #include "CPU.h"
+#include "ExecutionThread.h"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -12,7 +13,7 @@ class RegisterView : public View {
 public:
     RegisterView() {}
     void Show() {
-        static uint64_t prevRegs[31] = {0};        // 上一帧寄存器值
+        static uint64_t seenGeneration = 0;        // 上一帧看到的变化代数
         static int highlightTimer[31] = {0};       // 每个寄存器的高亮计时器（帧数）
         constexpr int kHighlightFrames = 70;       // 高亮持续的帧数
 
@@ -22,12 +23,18 @@ public:
         ImGui::Begin("RegisterView");
         ImGui::BeginChild("RegisterRegion", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
 
-        CPU& cpu = CPU::GetInstance();
+        // 执行线程发布的快照，执行中也不会读到改写了一半的状态
+        const ExecutionSnapshot snapshot = ExecutionThread::GetInstance().snapshot();
 
-        ImGui::Text("PC:  0x%016llX", cpu.getPC());
-        ImGui::Text("SP:  0x%016llX", cpu.getSP());
-        ImGui::Text("IR:  0x%08X", cpu.getIR());
-        ImGui::Text("Status: %s", cpu.getStatusReg().toString().c_str());
+        // 代数比上一帧新的寄存器即为变化过的寄存器
+        uint32_t changed = 0;
+        for (int i = 0; i < 32; ++i) changed |= static_cast<uint32_t>(snapshot.regGenerations[i] > seenGeneration) << i;
+        seenGeneration = snapshot.generation;
+
+        ImGui::Text("PC:  0x%016llX", snapshot.pc);
+        ImGui::Text("SP:  0x%016llX", snapshot.regs[31]);
+        ImGui::Text("IR:  0x%08X", snapshot.ir);
+        ImGui::Text("Status: %s", snapshot.status.toString().c_str());
 
         if (ImGui::BeginTable("RegisterTable", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
             ImGui::TableSetupColumn("Register");
@@ -35,12 +42,11 @@ public:
             ImGui::TableHeadersRow();
 
             for (int i = 0; i < 31; ++i) {
-                uint64_t value = cpu.getReg(i);
+                uint64_t value = snapshot.regs[i];
 
                 // 寄存器值发生变化，重置计时器
-                if (value != prevRegs[i]) {
+                if (changed & (1u << i)) {
                     highlightTimer[i] = kHighlightFrames;
-                    prevRegs[i] = value;
                 }
 
                 ImGui::TableNextRow();